@@ -48,6 +48,17 @@ declare namespace JpegSampleFactor {
   const Unknown: number;
 }
 
+declare namespace JpegTransformOperation {
+  const Crop: number;
+  const Blank: number;
+  const FlipHorizontal: number;
+  const FlipVertical: number;
+  const Transpose: number;
+  const Rotate90: number;
+  const Rotate180: number;
+  const Rotate270: number;
+}
+
 declare namespace Jpeg2000ProgressionOrder {
   const Lrcp: number;
   const Rlcp: number;
@@ -70,6 +81,7 @@ declare class Context {
     planarConfiguration?: number;
     photometricInterpretation?: string;
     encodedBuffer?: Uint8Array;
+    encodedFragments?: Array<Uint8Array>;
     decodedBuffer?: Uint8Array;
   });
 
@@ -163,6 +175,16 @@ declare class Context {
    */
   setEncodedBuffer(encodedBuffer: Uint8Array): void;
 
+  /**
+   * Gets the encoded buffer fragments, following the encoded buffer.
+   */
+  getEncodedFragments(): Array<Uint8Array> | undefined;
+
+  /**
+   * Sets the encoded buffer fragments, following the encoded buffer.
+   */
+  setEncodedFragments(encodedFragments: Array<Uint8Array>): void;
+
   /**
    * Gets the decoded buffer.
    */
@@ -194,20 +216,51 @@ declare class NativeCodecs {
    */
   static release(): void;
 
+  /**
+   * Creates a native codecs session.
+   */
+  static createSession(): number;
+
+  /**
+   * Releases a native codecs session.
+   */
+  static releaseSession(session: number): void;
+
+  /**
+   * Gets the native codec scratch memory statistics.
+   */
+  static getMemoryStatistics(): {
+    highWaterMark: number;
+    capacity: number;
+    allocations: number;
+  };
+
   /**
    * Decodes RLE frame.
    */
-  static decodeRle(context: Context, parameters?: Record<string, unknown>): Context;
+  static decodeRle(
+    context: Context,
+    parameters?: Record<string, unknown>,
+    session?: number
+  ): Context;
 
   /**
    * Encodes RLE frame.
    */
-  static encodeRle(context: Context, parameters?: Record<string, unknown>): Context;
+  static encodeRle(
+    context: Context,
+    parameters?: Record<string, unknown>,
+    session?: number
+  ): Context;
 
   /**
    * Decodes JPEG frame (lossless or lossy).
    */
-  static decodeJpeg(context: Context, parameters?: { convertColorspaceToRgb?: boolean }): Context;
+  static decodeJpeg(
+    context: Context,
+    parameters?: { convertColorspaceToRgb?: boolean },
+    session?: number
+  ): Context;
 
   /**
    * Encodes JPEG frame (lossless or lossy).
@@ -221,57 +274,221 @@ declare class NativeCodecs {
       sampleFactor?: number;
       predictor?: number;
       pointTransform?: number;
-    }
+    },
+    session?: number
+  ): Context;
+
+  /**
+   * Transforms JPEG baseline frame in the DCT domain, without decoding the pixels.
+   */
+  static transformJpeg(
+    context: Context,
+    parameters?: {
+      operations?: Array<{
+        operation: number;
+        x?: number;
+        y?: number;
+        width?: number;
+        height?: number;
+      }>;
+    },
+    session?: number
   ): Context;
 
   /**
    * Decodes JPEG-LS frame (lossless or lossy).
    */
-  static decodeJpegLs(context: Context, parameters?: Record<string, unknown>): Context;
+  static decodeJpegLs(
+    context: Context,
+    parameters?: Record<string, unknown>,
+    session?: number
+  ): Context;
 
   /**
    * Encodes JPEG-LS frame (lossless or lossy).
    */
   static encodeJpegLs(
     context: Context,
-    parameters?: { lossy?: boolean; allowedLossyError?: number }
+    parameters?: { lossy?: boolean; allowedLossyError?: number },
+    session?: number
   ): Context;
 
   /**
    * Decodes JPEG2000 frame (lossless or lossy).
    */
-  static decodeJpeg2000(context: Context, parameters?: Record<string, unknown>): Context;
+  static decodeJpeg2000(
+    context: Context,
+    parameters?: Record<string, unknown>,
+    session?: number
+  ): Context;
 
   /**
    * Encodes JPEG2000 frame (lossless or lossy).
    */
   static encodeJpeg2000(
     context: Context,
-    parameters?: { lossy?: boolean; progressionOrder?: number; rate?: number }
+    parameters?: {
+      lossy?: boolean;
+      progressionOrder?: number;
+      rate?: number;
+      allowMct?: number;
+      tileWidth?: number;
+      tileHeight?: number;
+      codeBlockStyle?: number;
+      codeBlockWidth?: number;
+      codeBlockHeight?: number;
+      numberOfLayers?: number;
+      rateAllocation?: boolean;
+      threadCount?: number;
+    },
+    session?: number
   ): Context;
 
   /**
    * Decodes JPEG-XL frame (lossless or lossy).
    */
-  static decodeJpegXl(context: Context, parameters?: Record<string, unknown>): Context;
+  static decodeJpegXl(
+    context: Context,
+    parameters?: { threadCount?: number; outputColorSpace?: number },
+    session?: number
+  ): Context;
+
+  /**
+   * Decodes JPEG-XL frame incrementally, as its bytes arrive.
+   */
+  static decodeJpegXlIncremental(
+    context: Context,
+    parameters: { threadCount?: number; outputColorSpace?: number } | undefined,
+    session: number
+  ): { context: Context; complete: boolean; downsamplingRatio: number };
 
   /**
    * Encodes JPEG-XL frame (lossless or lossy).
    */
-  static encodeJpegXl(context: Context, parameters?: { lossy?: boolean }): Context;
+  static encodeJpegXl(
+    context: Context,
+    parameters?: {
+      lossy?: boolean;
+      quality?: number;
+      effort?: number;
+      decodingSpeed?: number;
+      modular?: number;
+      modularPredictor?: number;
+      modularGroupSize?: number;
+      brotliEffort?: number;
+      threadCount?: number;
+      progressive?: boolean;
+    },
+    session?: number
+  ): Context;
+
+  /**
+   * Transcodes JPEG baseline frame to JPEG-XL, using lossless JPEG recompression.
+   */
+  static transcodeJpegToJpegXl(
+    context: Context,
+    parameters?: { effort?: number; brotliEffort?: number; threadCount?: number },
+    session?: number
+  ): Context;
+
+  /**
+   * Transcodes JPEG-XL frame, created with lossless JPEG recompression, back to JPEG baseline.
+   */
+  static transcodeJpegXlToJpeg(
+    context: Context,
+    parameters?: Record<string, unknown>,
+    session?: number
+  ): Context;
+
+  /**
+   * Checks whether a frame can be transcoded natively with a decoder and an encoder.
+   */
+  static canTranscodeFrame(decoderFnName: string, encoderFnName: string): boolean;
+
+  /**
+   * Transcodes frame, by decoding and encoding it again within the native codecs.
+   */
+  static transcodeFrame(
+    context: Context,
+    decoderFnName: string,
+    decoderParameters: Record<string, unknown> | undefined,
+    encoderFnName: string,
+    encoderParameters: Record<string, unknown> | undefined,
+    photometricInterpretation: string,
+    session?: number
+  ): Context;
 
   /**
    *  Decodes High-Throughput JPEG2000 frame (lossless or lossy).
    */
-  static decodeHtJpeg2000(context: Context, parameters?: Record<string, unknown>): Context;
+  static decodeHtJpeg2000(
+    context: Context,
+    parameters?: { threadCount?: number; resilient?: boolean },
+    session?: number
+  ): Context;
 
   /**
    * Encodes High-Throughput JPEG2000 frame (lossless or lossy).
    */
   static encodeHtJpeg2000(
     context: Context,
-    parameters?: { lossy?: boolean; progressionOrder?: number }
+    parameters?: {
+      lossy?: boolean;
+      progressionOrder?: number;
+      tileWidth?: number;
+      tileHeight?: number;
+      precinctWidth?: number;
+      precinctHeight?: number;
+      packetLengthMarkers?: boolean;
+      streaming?: boolean;
+      quantizationStep?: number;
+      targetBytes?: number;
+      targetPsnr?: number;
+      threadCount?: number;
+    },
+    session?: number
   ): Context;
+
+  /**
+   * Indexes the packets of a single quality layer High-Throughput JPEG2000 frame.
+   */
+  static indexHtJpeg2000(
+    context: Context,
+    parameters?: Record<string, unknown>,
+    session?: number
+  ): {
+    mainHeaderSize: number;
+    tileParts: Array<{ tile: number; offset: number; headerSize: number; size: number }>;
+    packets: Array<{
+      tile: number;
+      tilePart: number;
+      resolution: number;
+      component: number;
+      precinct: number;
+      offset: number;
+      size: number;
+    }>;
+  };
+
+  /**
+   * Probes the encoded frame headers, without decoding the pixels data.
+   */
+  static probeImage(
+    context: Context,
+    parameters?: Record<string, unknown>,
+    session?: number
+  ): {
+    width: number;
+    height: number;
+    bitsAllocated: number;
+    bitsStored: number;
+    samplesPerPixel: number;
+    pixelRepresentation: number;
+    colorTransform: boolean;
+    tileWidth: number;
+    tileHeight: number;
+    decompositionLevels: number;
+  };
 }
 
 declare class Transcoder {
@@ -289,6 +506,19 @@ declare class Transcoder {
    */
   transcode(newTransferSyntaxUid?: string, parameters?: Record<string, unknown>): void;
 
+  /**
+   * Transforms the JPEG baseline pixel data in the DCT domain, without decoding it.
+   */
+  transformJpeg(
+    operations: Array<{
+      operation: number;
+      x?: number;
+      y?: number;
+      width?: number;
+      height?: number;
+    }>
+  ): void;
+
   /**
    * Gets DICOM transfer syntax UID.
    */
@@ -361,6 +591,7 @@ export namespace constants {
   export { PlanarConfiguration };
   export { PixelRepresentation };
   export { JpegSampleFactor };
+  export { JpegTransformOperation };
   export { Jpeg2000ProgressionOrder };
 }
 
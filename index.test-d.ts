@@ -40,6 +40,7 @@ expectError(context.setPlanarConfiguration('7'));
 expectError(context.setPhotometricInterpretation(8));
 expectError(context.setEncodedBuffer('9'));
 expectError(context.setDecodedBuffer('10'));
+expectError(context.setEncodedFragments('11'));
 expectType<number | undefined>(context.getWidth());
 expectType<number | undefined>(context.getHeight());
 expectType<number | undefined>(context.getBitsStored());
@@ -49,6 +50,7 @@ expectType<number | undefined>(context.getPixelRepresentation());
 expectType<number | undefined>(context.getPlanarConfiguration());
 expectType<string | undefined>(context.getPhotometricInterpretation());
 expectType<Uint8Array | undefined>(context.getEncodedBuffer());
+expectType<Array<Uint8Array> | undefined>(context.getEncodedFragments());
 expectType<Uint8Array | undefined>(context.getDecodedBuffer());
 
 // NativeCodecs
@@ -63,6 +65,11 @@ expectType<Promise<void>>(
 );
 expectType<Promise<void>>(NativeCodecs.initializeAsync());
 expectType<void>(NativeCodecs.release());
+expectType<number>(NativeCodecs.createSession());
+expectError(NativeCodecs.releaseSession('1'));
+expectType<{ highWaterMark: number; capacity: number; allocations: number }>(
+  NativeCodecs.getMemoryStatistics()
+);
 
 const context1 = new Context();
 expectType<Context>(NativeCodecs.decodeRle(context1));
@@ -82,14 +89,35 @@ expectError(NativeCodecs.decodeJpeg2000('1'));
 expectError(NativeCodecs.decodeJpeg2000(context1, '2'));
 expectError(NativeCodecs.encodeJpeg2000('1'));
 expectError(NativeCodecs.encodeJpeg2000(context1, '2'));
+expectError(NativeCodecs.encodeJpeg2000(context1, { tileWidth: '256' }));
+expectError(NativeCodecs.encodeJpeg2000(context1, { rateAllocation: 0 }));
 expectError(NativeCodecs.decodeJpegXl('1'));
 expectError(NativeCodecs.decodeJpegXl(context1, '2'));
+expectError(NativeCodecs.decodeJpegXl(context1, { outputColorSpace: '1' }));
 expectError(NativeCodecs.encodeJpegXl('1'));
 expectError(NativeCodecs.encodeJpegXl(context1, '2'));
+expectError(NativeCodecs.encodeJpegXl(context1, { effort: '1' }));
+expectError(NativeCodecs.decodeJpegXlIncremental(context1, undefined));
+expectError(NativeCodecs.decodeJpegXlIncremental(context1, undefined, '1'));
 expectError(NativeCodecs.decodeHtJpeg2000('1'));
 expectError(NativeCodecs.decodeHtJpeg2000(context1, '2'));
 expectError(NativeCodecs.encodeHtJpeg2000('1'));
 expectError(NativeCodecs.encodeHtJpeg2000(context1, '2'));
+expectError(NativeCodecs.encodeHtJpeg2000(context1, { tileHeight: '256' }));
+expectError(NativeCodecs.decodeHtJpeg2000(context1, { threadCount: '4' }));
+expectError(NativeCodecs.decodeHtJpeg2000(context1, { resilient: 'true' }));
+expectError(NativeCodecs.encodeHtJpeg2000(context1, { precinctWidth: '128' }));
+expectError(NativeCodecs.encodeHtJpeg2000(context1, { packetLengthMarkers: 'true' }));
+expectError(NativeCodecs.encodeHtJpeg2000(context1, { targetPsnr: '45' }));
+expectError(NativeCodecs.indexHtJpeg2000('1'));
+expectError(NativeCodecs.indexHtJpeg2000(context1, '2'));
+expectError(NativeCodecs.probeImage('1'));
+expectError(NativeCodecs.probeImage(context1, '2'));
+expectType<boolean>(NativeCodecs.canTranscodeFrame('decodeJpeg2000', 'encodeHtJpeg2000'));
+expectError(NativeCodecs.transcodeFrame(context1, 'decodeJpeg2000'));
+expectError(
+  NativeCodecs.transcodeFrame(context1, 'decodeJpeg2000', {}, 'encodeHtJpeg2000', {}, 1)
+);
 
 // Transcoder
 expectError(new Transcoder(1));
@@ -114,6 +142,7 @@ expectType<Record<string, unknown>>(transcoder.getElements());
 expectError(transcoder.transcode(12345));
 expectError(transcoder.transcode(12345, '1'));
 expectType<void>(transcoder.transcode(TransferSyntax.ImplicitVRLittleEndian, {}));
+expectError(transcoder.transformJpeg('crop'));
 expectType<ArrayBuffer>(transcoder.getDicomDataset());
 expectError(transcoder.getDicomDataset(12345, '1'));
 expectType<ArrayBuffer>(transcoder.getDicomPart10());
@@ -40,6 +40,32 @@ class Codec {
     throw new Error('decode should be implemented');
   }
 
+  /**
+   * Checks whether DICOM image can be transcoded from another transfer syntax
+   * without decoding the pixels.
+   * @method
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @returns {boolean} A flag indicating whether a direct transcoding path exists.
+   */
+  // eslint-disable-next-line no-unused-vars
+  canTranscodeFrom(syntax) {
+    return false;
+  }
+
+  /**
+   * Transcodes DICOM image from another transfer syntax without decoding the pixels.
+   * @method
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {Object} [parameters] - Encoder or decoder parameters.
+   * @returns {Object} Updated DICOM image elements.
+   * @throws {Error} If transcodeFrom is not implemented.
+   */
+  // eslint-disable-next-line no-unused-vars
+  transcodeFrom(elements, syntax, parameters = {}) {
+    throw new Error('transcodeFrom should be implemented');
+  }
+
   /**
    * Creates a codec object based on the transfer syntax UID.
    * @method
@@ -61,6 +87,7 @@ class Codec {
       [TransferSyntax.Jpeg2000Lossless]: Jpeg2000LosslessCodec,
       [TransferSyntax.Jpeg2000Lossy]: Jpeg2000LossyCodec,
       [TransferSyntax.JpegXlLossless]: JpegXlLosslessCodec,
+      [TransferSyntax.JpegXlRecompression]: JpegXlRecompressionCodec,
       [TransferSyntax.JpegXlLossy]: JpegXlLossyCodec,
       [TransferSyntax.HtJpeg2000Lossless]: HtJpeg2000LosslessCodec,
       [TransferSyntax.HtJpeg2000LosslessRpcl]: HtJpeg2000LosslessRpclCodec,
@@ -90,57 +117,86 @@ class Codec {
     const frames = new Frames(elements, syntax);
     const numberOfFrames = frames.getNumberOfFrames();
     const retFramesArrayBuffer = [];
-    for (let i = 0; i < numberOfFrames; i++) {
-      let frameData = frames.getFrameBuffer(i);
-
-      if (parameters.unpackLow16) {
-        frameData = FrameConverter.unpackLow16(frameData);
-      }
-
-      if (parameters.convertYbrFullToRgb) {
-        frameData = FrameConverter.ybrFullToRgb(frameData);
-      }
-
-      if (parameters.convertYbrFull422ToRgb) {
-        frameData = FrameConverter.ybrFull422ToRgb(frameData, frames.getWidth());
-      }
-
-      if (parameters.updatePlanarConfiguration) {
-        frameData = FrameConverter.changePlanarConfiguration(
-          frameData,
-          elements.BitsAllocated,
-          elements.SamplesPerPixel,
-          PlanarConfiguration.Planar
-        );
-      }
-
-      if (parameters.shiftSignedPixels) {
-        const src = new Uint16Array(
-          frameData.buffer,
-          frameData.byteOffset,
-          frameData.byteLength / 2
-        );
-        const shifted = new Uint16Array(src.length);
-        const offset = 1 << (elements.BitsAllocated - 1);
-        for (let j = 0; j < src.length; j++) {
-          shifted[j] = src[j] + offset;
+    const session = NativeCodecs.createSession();
+
+    // Frames decoded on demand are transcoded natively, when no pixel conversion
+    // is needed, so that the decoded pixels data do not leave the native codecs
+    const frameStream = elements.PixelData instanceof FrameStream ? elements.PixelData : undefined;
+    const transcodeFrames =
+      frameStream !== undefined &&
+      frameStream.canTranscodeTo(encoderFnName) &&
+      !parameters.unpackLow16 &&
+      !parameters.convertYbrFullToRgb &&
+      !parameters.convertYbrFull422ToRgb &&
+      !parameters.updatePlanarConfiguration &&
+      !parameters.shiftSignedPixels;
+    try {
+      for (let i = 0; i < numberOfFrames; i++) {
+        let retContext;
+        if (transcodeFrames && !frameStream.isFrameDecoded(i)) {
+          retContext = frameStream.transcodeFrame(
+            i,
+            encoderFnName,
+            parameters,
+            elements.PhotometricInterpretation,
+            session
+          );
+        } else {
+          let frameData = frames.getFrameBuffer(i);
+
+          if (parameters.unpackLow16) {
+            frameData = FrameConverter.unpackLow16(frameData);
+          }
+
+          if (parameters.convertYbrFullToRgb) {
+            frameData = FrameConverter.ybrFullToRgb(frameData);
+          }
+
+          if (parameters.convertYbrFull422ToRgb) {
+            frameData = FrameConverter.ybrFull422ToRgb(frameData, frames.getWidth());
+          }
+
+          if (parameters.updatePlanarConfiguration) {
+            frameData = FrameConverter.changePlanarConfiguration(
+              frameData,
+              elements.BitsAllocated,
+              elements.SamplesPerPixel,
+              PlanarConfiguration.Planar
+            );
+          }
+
+          if (parameters.shiftSignedPixels) {
+            const src = new Uint16Array(
+              frameData.buffer,
+              frameData.byteOffset,
+              frameData.byteLength / 2
+            );
+            const shifted = new Uint16Array(src.length);
+            const offset = 1 << (elements.BitsAllocated - 1);
+            for (let j = 0; j < src.length; j++) {
+              shifted[j] = src[j] + offset;
+            }
+            frameData = new Uint8Array(shifted.buffer);
+          }
+
+          const context = Context.fromDicomElements(elements);
+          context.setDecodedBuffer(frameData);
+
+          retContext = NativeCodecs[encoderFnName](context, parameters, session);
         }
-        frameData = new Uint8Array(shifted.buffer);
-      }
 
-      const context = Context.fromDicomElements(elements);
-      context.setDecodedBuffer(frameData);
+        let retBuffer = retContext.getEncodedBuffer();
+        if (retBuffer.length % 2 !== 0) {
+          retBuffer = Utils.concatBuffers([retBuffer, Uint8Array.from([0x00])]);
+        }
+        retFramesArrayBuffer.push(
+          retBuffer.buffer.slice(retBuffer.byteOffset, retBuffer.byteOffset + retBuffer.byteLength)
+        );
 
-      const retContext = NativeCodecs[encoderFnName](context, parameters);
-      let retBuffer = retContext.getEncodedBuffer();
-      if (retBuffer.length % 2 !== 0) {
-        retBuffer = Utils.concatBuffers([retBuffer, Uint8Array.from([0x00])]);
+        Object.assign(elements, retContext.toDicomElements());
       }
-      retFramesArrayBuffer.push(
-        retBuffer.buffer.slice(retBuffer.byteOffset, retBuffer.byteOffset + retBuffer.byteLength)
-      );
-
-      Object.assign(elements, retContext.toDicomElements());
+    } finally {
+      NativeCodecs.releaseSession(session);
     }
 
     elements._vrMap = {
@@ -162,41 +218,128 @@ class Codec {
    * @returns {Object} Updated DICOM image elements.
    */
   _baseDecodeImpl(elements, syntax, decoderFnName, parameters = {}) {
+    if (parameters.streamFrames) {
+      return this._streamDecodeImpl(elements, syntax, decoderFnName, parameters);
+    }
+
     const frames = new Frames(elements, syntax);
     const numberOfFrames = frames.getNumberOfFrames();
 
     const retFramesArrayBuffer = [];
-    for (let i = 0; i < numberOfFrames; i++) {
-      const frameData = frames.getFrameBuffer(i);
-      const context = Context.fromDicomElements(elements);
-      context.setEncodedBuffer(frameData);
+    const session = NativeCodecs.createSession();
+    try {
+      for (let i = 0; i < numberOfFrames; i++) {
+        const [frameData, ...frameFragments] = frames.getFrameFragments(i);
+        const context = Context.fromDicomElements(elements);
+        context.setEncodedBuffer(frameData);
+        context.setEncodedFragments(frameFragments);
+
+        const retContext = NativeCodecs[decoderFnName](context, parameters, session);
+        let retBuffer = retContext.getDecodedBuffer();
+        if (retBuffer.length % 2 !== 0) {
+          retBuffer = Utils.concatBuffers([retBuffer, Uint8Array.from([0x00])]);
+        }
 
-      const retContext = NativeCodecs[decoderFnName](context, parameters);
-      let retBuffer = retContext.getDecodedBuffer();
-      if (retBuffer.length % 2 !== 0) {
-        retBuffer = Utils.concatBuffers([retBuffer, Uint8Array.from([0x00])]);
-      }
+        if (parameters.updatePlanarConfiguration) {
+          retBuffer = FrameConverter.changePlanarConfiguration(
+            retBuffer,
+            elements.BitsAllocated,
+            elements.SamplesPerPixel,
+            PlanarConfiguration.Interleaved
+          );
+        }
 
-      if (parameters.updatePlanarConfiguration) {
-        retBuffer = FrameConverter.changePlanarConfiguration(
-          retBuffer,
-          elements.BitsAllocated,
-          elements.SamplesPerPixel,
-          PlanarConfiguration.Interleaved
+        retFramesArrayBuffer.push(
+          retBuffer.buffer.slice(retBuffer.byteOffset, retBuffer.byteOffset + retBuffer.byteLength)
         );
+
+        Object.assign(elements, retContext.toDicomElements());
       }
+    } finally {
+      NativeCodecs.releaseSession(session);
+    }
 
-      retFramesArrayBuffer.push(
-        retBuffer.buffer.slice(retBuffer.byteOffset, retBuffer.byteOffset + retBuffer.byteLength)
-      );
+    elements._vrMap = {
+      PixelData: frames.getBytesAllocated() === 1 ? 'OB' : 'OW',
+    };
+    elements.PixelData = [Utils.concatBuffers(retFramesArrayBuffer)];
 
-      Object.assign(elements, retContext.toDicomElements());
+    return elements;
+  }
+
+  /**
+   * Streaming decoder implementation.
+   * The pixel data are replaced with a frame stream that decodes the frames on demand.
+   * The first frame is decoded up front, so that the image elements describe the
+   * decoded pixels data.
+   * @method
+   * @private
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {string} decoderFnName - Decoder function name.
+   * @param {Object} [parameters] - Encoder or decoder parameters.
+   * @returns {Object} Updated DICOM image elements, with a frame stream as pixel data.
+   */
+  _streamDecodeImpl(elements, syntax, decoderFnName, parameters = {}) {
+    const frameStream = new FrameStream(elements, syntax, decoderFnName, parameters);
+    try {
+      frameStream.getFrame(0);
+    } catch (err) {
+      frameStream.release();
+      throw err;
+    }
+
+    Object.assign(elements, frameStream.getElements());
+    elements._vrMap = {
+      PixelData: frameStream.frames.getBytesAllocated() === 1 ? 'OB' : 'OW',
+    };
+    elements.PixelData = frameStream;
+
+    return elements;
+  }
+
+  /**
+   * Base transcoder implementation.
+   * @method
+   * @private
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {string} transcoderFnName - Transcoder function name.
+   * @param {Object} [parameters] - Encoder or decoder parameters.
+   * @returns {Object} Updated DICOM image elements.
+   */
+  _baseTranscodeImpl(elements, syntax, transcoderFnName, parameters = {}) {
+    const frames = new Frames(elements, syntax);
+    const numberOfFrames = frames.getNumberOfFrames();
+
+    const retFramesArrayBuffer = [];
+    const session = NativeCodecs.createSession();
+    try {
+      for (let i = 0; i < numberOfFrames; i++) {
+        const [frameData, ...frameFragments] = frames.getFrameFragments(i);
+        const context = Context.fromDicomElements(elements);
+        context.setEncodedBuffer(frameData);
+        context.setEncodedFragments(frameFragments);
+
+        const retContext = NativeCodecs[transcoderFnName](context, parameters, session);
+        let retBuffer = retContext.getEncodedBuffer();
+        if (retBuffer.length % 2 !== 0) {
+          retBuffer = Utils.concatBuffers([retBuffer, Uint8Array.from([0x00])]);
+        }
+        retFramesArrayBuffer.push(
+          retBuffer.buffer.slice(retBuffer.byteOffset, retBuffer.byteOffset + retBuffer.byteLength)
+        );
+
+        Object.assign(elements, retContext.toDicomElements());
+      }
+    } finally {
+      NativeCodecs.releaseSession(session);
     }
 
     elements._vrMap = {
       PixelData: frames.getBytesAllocated() === 1 ? 'OB' : 'OW',
     };
-    elements.PixelData = [Utils.concatBuffers(retFramesArrayBuffer)];
+    elements.PixelData = retFramesArrayBuffer;
 
     return elements;
   }
@@ -204,6 +347,155 @@ class Codec {
 }
 //#endregion
 
+//#region FrameStream
+class FrameStream {
+  /**
+   * Creates an instance of FrameStream.
+   * Frames are decoded on demand, one at a time, in place of the decoded pixel data.
+   * @constructor
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {string} decoderFnName - Decoder function name.
+   * @param {Object} [parameters] - Decoder parameters.
+   */
+  constructor(elements, syntax, decoderFnName, parameters = {}) {
+    this.frames = new Frames(elements, syntax);
+    this.elements = { ...elements };
+    this.decoderFnName = decoderFnName;
+    this.parameters = parameters;
+    this.session = NativeCodecs.createSession();
+    this.cachedFrameIndex = -1;
+    this.cachedFrame = undefined;
+    this.byteLength = 0;
+  }
+
+  /**
+   * Gets the image elements, as updated by the last decoded frame.
+   * @method
+   * @returns {Object} DICOM image elements.
+   */
+  getElements() {
+    return this.elements;
+  }
+
+  /**
+   * Checks whether a frame is held decoded.
+   * @method
+   * @param {number} frame - Frame index.
+   * @returns {boolean} Whether the frame is held decoded.
+   */
+  isFrameDecoded(frame) {
+    return frame === this.cachedFrameIndex;
+  }
+
+  /**
+   * Gets a decoded frame.
+   * A frame held decoded is handed over once and then released.
+   * @method
+   * @param {number} frame - Frame index.
+   * @returns {Uint8Array} Decoded frame pixels data.
+   */
+  getFrame(frame) {
+    if (this.isFrameDecoded(frame)) {
+      const frameData = this.cachedFrame;
+      this.cachedFrameIndex = -1;
+      this.cachedFrame = undefined;
+
+      return frameData;
+    }
+
+    const [frameData, ...frameFragments] = this.frames.getFrameFragments(frame);
+    const context = Context.fromDicomElements(this.elements);
+    context.setEncodedBuffer(frameData);
+    context.setEncodedFragments(frameFragments);
+
+    const retContext = NativeCodecs[this.decoderFnName](context, this.parameters, this.session);
+    let retBuffer = retContext.getDecodedBuffer();
+    if (this.parameters.updatePlanarConfiguration) {
+      retBuffer = FrameConverter.changePlanarConfiguration(
+        retBuffer,
+        this.elements.BitsAllocated,
+        this.elements.SamplesPerPixel,
+        PlanarConfiguration.Interleaved
+      );
+    }
+
+    Object.assign(this.elements, retContext.toDicomElements());
+    if (this.byteLength === 0) {
+      this.byteLength =
+        (retBuffer.length + (retBuffer.length % 2)) * this.frames.getNumberOfFrames();
+      this.cachedFrameIndex = frame;
+      this.cachedFrame = retBuffer;
+    }
+
+    return retBuffer;
+  }
+
+  /**
+   * Checks whether the frames can be transcoded natively with an encoder.
+   * @method
+   * @param {string} encoderFnName - Encoder function name.
+   * @returns {boolean} Whether the frames can be transcoded natively.
+   */
+  canTranscodeTo(encoderFnName) {
+    return (
+      !this.parameters.updatePlanarConfiguration &&
+      NativeCodecs.canTranscodeFrame(this.decoderFnName, encoderFnName)
+    );
+  }
+
+  /**
+   * Transcodes a frame natively, without gathering its decoded pixels data.
+   * @method
+   * @param {number} frame - Frame index.
+   * @param {string} encoderFnName - Encoder function name.
+   * @param {Object} [encoderParameters] - Encoder parameters.
+   * @param {string} photometricInterpretation - Photometric interpretation of the decoded
+   * pixels data, as passed to the encoder.
+   * @param {number} [encoderSession] - Native codecs session of the encoder.
+   * @returns {Context} Context object with encoded pixels data.
+   */
+  transcodeFrame(
+    frame,
+    encoderFnName,
+    encoderParameters,
+    photometricInterpretation,
+    encoderSession
+  ) {
+    const [frameData, ...frameFragments] = this.frames.getFrameFragments(frame);
+    const context = Context.fromDicomElements(this.elements);
+    context.setEncodedBuffer(frameData);
+    context.setEncodedFragments(frameFragments);
+
+    // The encoder session keeps the decoder state across the transcoded frames as well
+    const retContext = NativeCodecs.transcodeFrame(
+      context,
+      this.decoderFnName,
+      this.parameters,
+      encoderFnName,
+      encoderParameters,
+      photometricInterpretation,
+      encoderSession
+    );
+
+    return retContext;
+  }
+
+  /**
+   * Releases the frame stream.
+   * @method
+   */
+  release() {
+    if (this.session !== undefined) {
+      NativeCodecs.releaseSession(this.session);
+      this.session = undefined;
+    }
+    this.cachedFrameIndex = -1;
+    this.cachedFrame = undefined;
+  }
+}
+//#endregion
+
 //#region ImplicitVRLittleEndianCodec
 class ImplicitVRLittleEndianCodec extends Codec {
   /**
@@ -538,6 +830,44 @@ class JpegBaselineProcess1Codec extends JpegBaseCodec {
 
     return super.decode(elements, syntax, parameters);
   }
+
+  /**
+   * Checks whether DICOM image can be transcoded to JpegBaselineProcess1
+   * transfer syntax without decoding the pixels.
+   * @method
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @returns {boolean} A flag indicating whether a direct transcoding path exists.
+   */
+  canTranscodeFrom(syntax) {
+    return syntax === TransferSyntax.JpegXlRecompression;
+  }
+
+  /**
+   * Transcodes DICOM image to JpegBaselineProcess1 transfer syntax, by reconstructing
+   * the original JPEG bitstream from a JpegXlRecompression image.
+   * @method
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {Object} [parameters] - Decoder parameters.
+   * @returns {Object} Updated DICOM image elements.
+   */
+  transcodeFrom(elements, syntax, parameters = {}) {
+    return super._baseTranscodeImpl(elements, syntax, 'transcodeJpegXlToJpeg', parameters);
+  }
+
+  /**
+   * Transforms DICOM image for JpegBaselineProcess1 transfer syntax in the DCT domain
+   * (crop, blank-out, flip and rotation), without decoding and re-encoding the pixels.
+   * @method
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {Object} [parameters] - Transform parameters.
+   * @param {Array<Object>} [parameters.operations] - Transform operations, applied in order.
+   * @returns {Object} Updated DICOM image elements.
+   */
+  transform(elements, syntax, parameters = {}) {
+    return super._baseTranscodeImpl(elements, syntax, 'transformJpeg', parameters);
+  }
 }
 //#endregion
 
@@ -612,17 +942,9 @@ class JpegLsBaseCodec extends Codec {
     }
 
     // Handle planar configuration
-    if (
-      elements.PlanarConfiguration === PlanarConfiguration.Planar &&
-      elements.SamplesPerPixel > 1
-    ) {
-      if (elements.SamplesPerPixel !== 3 || elements.BitsStored > 8) {
-        throw new Error(
-          'Planar reconfiguration only implemented for SamplesPerPixel = 3 and BitsStored <= 8'
-        );
-      }
-      encoderParameters.updatePlanarConfiguration = true;
-    }
+    // Planar frames are encoded natively, as non-interleaved scans
+    const isPlanar =
+      elements.PlanarConfiguration === PlanarConfiguration.Planar && elements.SamplesPerPixel > 1;
 
     // Perform pixel transformation and encoding
     const updatedElements = super._baseEncodeImpl(
@@ -633,10 +955,7 @@ class JpegLsBaseCodec extends Codec {
     );
 
     // Update planar configuration
-    if (
-      encoderParameters.updatePlanarConfiguration !== undefined &&
-      encoderParameters.updatePlanarConfiguration
-    ) {
+    if (isPlanar) {
       updatedElements.PlanarConfiguration = PlanarConfiguration.Interleaved;
     }
 
@@ -670,20 +989,8 @@ class JpegLsBaseCodec extends Codec {
   decode(elements, syntax, parameters = {}) {
     const decoderParameters = { ...parameters };
 
-    // Handle planar configuration
-    if (
-      elements.PlanarConfiguration === PlanarConfiguration.Planar &&
-      elements.SamplesPerPixel > 1
-    ) {
-      if (elements.SamplesPerPixel !== 3 || elements.BitsStored > 8) {
-        throw new Error(
-          'Planar reconfiguration only implemented for SamplesPerPixel = 3 and BitsStored <= 8'
-        );
-      }
-      decoderParameters.updatePlanarConfiguration = true;
-    }
-
     // Perform pixel transformation and decoding
+    // Non-interleaved scans are decoded natively, as planar frames
     const updatedElements = super._baseDecodeImpl(
       elements,
       syntax,
@@ -796,17 +1103,9 @@ class Jpeg2000BaseCodec extends Codec {
     }
 
     // Handle planar configuration
-    if (
-      elements.PlanarConfiguration === PlanarConfiguration.Planar &&
-      elements.SamplesPerPixel > 1
-    ) {
-      if (elements.SamplesPerPixel !== 3 || elements.BitsStored > 8) {
-        throw new Error(
-          'Planar reconfiguration only implemented for SamplesPerPixel = 3 and BitsStored <= 8'
-        );
-      }
-      encoderParameters.updatePlanarConfiguration = true;
-    }
+    // Planar frames are encoded natively by the JPEG 2000 and HTJ2K encoders
+    const isPlanar =
+      elements.PlanarConfiguration === PlanarConfiguration.Planar && elements.SamplesPerPixel > 1;
 
     // Perform pixel transformation and encoding
     const updatedElements = super._baseEncodeImpl(
@@ -817,10 +1116,7 @@ class Jpeg2000BaseCodec extends Codec {
     );
 
     // Update planar configuration
-    if (
-      encoderParameters.updatePlanarConfiguration !== undefined &&
-      encoderParameters.updatePlanarConfiguration
-    ) {
+    if (isPlanar) {
       updatedElements.PlanarConfiguration = PlanarConfiguration.Interleaved;
     }
 
@@ -871,9 +1167,11 @@ class Jpeg2000BaseCodec extends Codec {
     const decoderParameters = { ...parameters };
 
     // Handle planar configuration
+    // Planar frames are assembled natively by the JPEG 2000 decoder
     if (
       elements.PlanarConfiguration === PlanarConfiguration.Planar &&
-      elements.SamplesPerPixel > 1
+      elements.SamplesPerPixel > 1 &&
+      decoderFnName !== 'decodeJpeg2000'
     ) {
       if (elements.SamplesPerPixel !== 3 || elements.BitsStored > 8) {
         throw new Error(
@@ -1015,6 +1313,8 @@ class HtJpeg2000LosslessRpclCodec extends Jpeg2000BaseCodec {
   encode(elements, syntax, parameters = {}) {
     parameters.lossy = false;
     parameters.progressionOrder = Jpeg2000ProgressionOrder.Rpcl;
+    // The RPCL transfer syntax requires TLM and PLT marker segments
+    parameters.packetLengthMarkers = true;
 
     return super.encode(elements, syntax, 'encodeHtJpeg2000', parameters);
   }
@@ -1102,19 +1402,6 @@ class JpegXlBaseCodec extends Codec {
       : [elements.PixelData];
     const oldSize = pixelDataArray.reduce((acc, buffer) => acc + buffer.byteLength, 0);
 
-    // Handle planar configuration
-    if (
-      elements.PlanarConfiguration === PlanarConfiguration.Planar &&
-      elements.SamplesPerPixel > 1
-    ) {
-      if (elements.SamplesPerPixel !== 3 || elements.BitsStored > 8) {
-        throw new Error(
-          'Planar reconfiguration only implemented for SamplesPerPixel = 3 and BitsStored <= 8'
-        );
-      }
-      encoderParameters.updatePlanarConfiguration = true;
-    }
-
     // Handle signedness of pixel data for lossy encoding
     if (
       encoderParameters.lossy !== undefined &&
@@ -1127,6 +1414,9 @@ class JpegXlBaseCodec extends Codec {
     }
 
     // Perform pixel transformation and encoding
+    // Planar frames are encoded natively and decoded as interleaved frames
+    const isPlanar =
+      elements.PlanarConfiguration === PlanarConfiguration.Planar && elements.SamplesPerPixel > 1;
     const updatedElements = super._baseEncodeImpl(
       elements,
       syntax,
@@ -1135,10 +1425,7 @@ class JpegXlBaseCodec extends Codec {
     );
 
     // Update planar configuration
-    if (
-      encoderParameters.updatePlanarConfiguration !== undefined &&
-      encoderParameters.updatePlanarConfiguration
-    ) {
+    if (isPlanar) {
       updatedElements.PlanarConfiguration = PlanarConfiguration.Interleaved;
     }
 
@@ -1300,12 +1587,68 @@ class JpegXlLossyCodec extends JpegXlBaseCodec {
   }
 }
 //#endregion
+
+//#region JpegXlRecompressionCodec
+class JpegXlRecompressionCodec extends JpegXlBaseCodec {
+  /**
+   * Encodes DICOM image for JpegXlRecompression transfer syntax.
+   * @method
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {Object} [parameters] - Encoder parameters.
+   * @throws {Error} As JPEG recompression requires a JPEG baseline source.
+   */
+  // eslint-disable-next-line no-unused-vars
+  encode(elements, syntax, parameters = {}) {
+    throw new Error(
+      `Unable to create JpegXlRecompressionCodec from transfer syntax ${syntax}, a JpegBaselineProcess1 source is required`
+    );
+  }
+
+  /**
+   * Decodes DICOM image for JpegXlRecompression transfer syntax.
+   * @method
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {Object} [parameters] - Decoder parameters.
+   * @returns {Object} Updated DICOM image elements.
+   */
+  decode(elements, syntax, parameters = {}) {
+    return super.decode(elements, syntax, 'decodeJpegXl', parameters);
+  }
+
+  /**
+   * Checks whether DICOM image can be transcoded to JpegXlRecompression
+   * transfer syntax without decoding the pixels.
+   * @method
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @returns {boolean} A flag indicating whether a direct transcoding path exists.
+   */
+  canTranscodeFrom(syntax) {
+    return syntax === TransferSyntax.JpegBaselineProcess1;
+  }
+
+  /**
+   * Transcodes DICOM image to JpegXlRecompression transfer syntax, by losslessly
+   * recompressing the DCT coefficients of a JpegBaselineProcess1 image.
+   * @method
+   * @param {Object} elements - DICOM image elements.
+   * @param {string} syntax - DICOM image elements transfer syntax UID.
+   * @param {Object} [parameters] - Encoder parameters.
+   * @returns {Object} Updated DICOM image elements.
+   */
+  transcodeFrom(elements, syntax, parameters = {}) {
+    return super._baseTranscodeImpl(elements, syntax, 'transcodeJpegToJpegXl', parameters);
+  }
+}
+//#endregion
 //#endregion
 /* c8 ignore stop */
 
 //#region Exports
 module.exports = {
   Codec,
+  FrameStream,
   ExplicitVRBigEndianCodec,
   ExplicitVRLittleEndianCodec,
   HtJpeg2000LosslessCodec,
@@ -1320,6 +1663,7 @@ module.exports = {
   JpegLsLossyCodec,
   JpegXlLosslessCodec,
   JpegXlLossyCodec,
+  JpegXlRecompressionCodec,
   RleLosslessCodec,
 };
 //#endregion
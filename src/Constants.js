@@ -42,6 +42,7 @@ const TranscodeMap = [
   { syntax: TransferSyntax.Jpeg2000Lossless,        lossy: false, encapsulated: true,  bigEndian: false }, 
   { syntax: TransferSyntax.Jpeg2000Lossy,           lossy: true,  encapsulated: true,  bigEndian: false }, 
   { syntax: TransferSyntax.JpegXlLossless,          lossy: false, encapsulated: true,  bigEndian: false },
+  { syntax: TransferSyntax.JpegXlRecompression,     lossy: true,  encapsulated: true,  bigEndian: false },
   { syntax: TransferSyntax.JpegXlLossy,             lossy: true,  encapsulated: true,  bigEndian: false },
   { syntax: TransferSyntax.HtJpeg2000Lossless,      lossy: false, encapsulated: true,  bigEndian: false }, 
   { syntax: TransferSyntax.HtJpeg2000LosslessRpcl,  lossy: false, encapsulated: true,  bigEndian: false }, 
@@ -147,6 +148,24 @@ const JpegSampleFactor = {
 Object.freeze(JpegSampleFactor);
 //#endregion
 
+//#region JpegTransformOperation
+/**
+ * JPEG lossless (DCT domain) transform operations.
+ * @constant {Object}
+ */
+const JpegTransformOperation = {
+  Crop: 0,
+  Blank: 1,
+  FlipHorizontal: 2,
+  FlipVertical: 3,
+  Transpose: 4,
+  Rotate90: 5,
+  Rotate180: 6,
+  Rotate270: 7,
+};
+Object.freeze(JpegTransformOperation);
+//#endregion
+
 //#region Jpeg2000ProgressionOrder
 /**
  * JPEG2000 progression orders.
@@ -168,6 +187,7 @@ module.exports = {
   Implementation,
   Jpeg2000ProgressionOrder,
   JpegSampleFactor,
+  JpegTransformOperation,
   PhotometricInterpretation,
   PixelRepresentation,
   PlanarConfiguration,
@@ -15,6 +15,8 @@ class Context {
    * @param {number} [attrs.planarConfiguration] - Planar configuration.
    * @param {string} [attrs.photometricInterpretation] - Photometric interpretation.
    * @param {Uint8Array} [attrs.encodedBuffer] - Encoded byte buffer.
+   * @param {Array<Uint8Array>} [attrs.encodedFragments] - Encoded byte buffer fragments,
+   * following the encoded byte buffer.
    * @param {Uint8Array} [attrs.decodedBuffer] - Decoded byte buffer.
    */
   constructor(attrs = {}) {
@@ -28,6 +30,7 @@ class Context {
       planarConfiguration,
       photometricInterpretation,
       encodedBuffer,
+      encodedFragments,
       decodedBuffer,
     } = attrs;
 
@@ -40,6 +43,7 @@ class Context {
     this.planarConfiguration = planarConfiguration;
     this.photometricInterpretation = photometricInterpretation;
     this.encodedBuffer = encodedBuffer;
+    this.encodedFragments = encodedFragments;
     this.decodedBuffer = decodedBuffer;
   }
   /**
@@ -204,6 +208,25 @@ class Context {
     this.encodedBuffer = encodedBuffer;
   }
 
+  /**
+   * Gets the encoded buffer fragments.
+   * @method
+   * @returns {Array<Uint8Array>} Encoded buffer fragments, following the encoded buffer.
+   */
+  getEncodedFragments() {
+    return this.encodedFragments;
+  }
+
+  /**
+   * Sets the encoded buffer fragments.
+   * @method
+   * @param {Array<Uint8Array>} encodedFragments - Encoded buffer fragments, following the
+   * encoded buffer.
+   */
+  setEncodedFragments(encodedFragments) {
+    this.encodedFragments = encodedFragments;
+  }
+
   /**
    * Gets the decoded buffer.
    * @method
@@ -208,6 +208,23 @@ class Frames {
    * transfer syntax cannot be currently decoded.
    */
   getFrameBuffer(frame) {
+    const fragments = this.getFrameFragments(frame);
+
+    return fragments.length === 1 ? fragments[0] : Utils.concatBuffers(fragments);
+  }
+
+  /**
+   * Gets the frame data of the desired frame as arrays of unsigned byte values,
+   * one per pixel data fragment of the frame. Frames of non-encapsulated transfer
+   * syntaxes are returned as a single fragment.
+   * @method
+   * @param {number} frame - Frame index.
+   * @returns {Array<Uint8Array>} Frame data fragments as arrays of unsigned byte values.
+   * @throws {Error} If requested frame is out of range, pixel data could not be extracted,
+   * width/height/bits allocated/stored/photometric interpretation has an invalid value or
+   * transfer syntax cannot be currently decoded.
+   */
+  getFrameFragments(frame) {
     if (frame < 0 || frame >= this.getNumberOfFrames()) {
       throw new Error(`Requested frame is out of range [${frame}]`);
     }
@@ -243,13 +260,18 @@ class Frames {
     }
 
     if (!syntaxMapItem.encapsulated) {
+      // Frames decoded on demand (i.e. a frame stream)
+      if (typeof pixelBuffers.getFrame === 'function') {
+        return [pixelBuffers.getFrame(frame)];
+      }
+
       const frameSize = this.getUncompressedFrameSize();
       const frameOffset = frameSize * frame;
       // Take the first buffer from pixel buffers and extract the current frame data
       let pixelBuffer = new Uint8Array(
         Array.isArray(pixelBuffers) ? pixelBuffers.find((o) => o) : pixelBuffers
       );
-      return pixelBuffer.slice(frameOffset, frameOffset + frameSize);
+      return [pixelBuffer.slice(frameOffset, frameOffset + frameSize)];
     } else {
       return this._getFrameFragments(pixelBuffers, frame);
     }
@@ -283,7 +305,7 @@ class Frames {
    * @private
    * @param {number} pixelBuffers - Pixel data buffers.
    * @param {number} frame - Frame index.
-   * @returns {Uint8Array} Frame data as an array of unsigned byte values.
+   * @returns {Array<Uint8Array>} Frame data fragments as arrays of unsigned byte values.
    * @throws {Error} If there are no fragmented pixel data or requested frame
    * is larger or equal to the pixel fragments number.
    */
@@ -297,10 +319,10 @@ class Frames {
       );
     }
     if (this.getNumberOfFrames() === 1) {
-      return new Uint8Array(Utils.concatBuffers(pixelBuffers));
+      return pixelBuffers.map((pixelBuffer) => new Uint8Array(pixelBuffer));
     }
     if (pixelBuffers.length === this.getNumberOfFrames()) {
-      return new Uint8Array(pixelBuffers[frame]);
+      return [new Uint8Array(pixelBuffers[frame])];
     }
 
     throw new Error('Multiple fragments per frame is not yet implemented');
@@ -2,6 +2,7 @@ const {
   ErrNo,
   Jpeg2000ProgressionOrder,
   JpegSampleFactor,
+  JpegTransformOperation,
   PhotometricInterpretation,
 } = require('./Constants');
 const Context = require('./Context');
@@ -14,6 +15,20 @@ const log = require('./log');
 const wasmFilename = 'dcmjs-native-codecs.wasm';
 Object.freeze(wasmFilename);
 
+/**
+ * Frame codecs chained by the native frame transcoder, by codec function name suffix.
+ * @constant {Object}
+ */
+const TranscodeFrameCodec = {
+  Rle: 0,
+  Jpeg: 1,
+  JpegLs: 2,
+  Jpeg2000: 3,
+  HtJpeg2000: 4,
+  JpegXl: 5,
+};
+Object.freeze(TranscodeFrameCodec);
+
 //#region NativeCodecs
 class NativeCodecs {
   /**
@@ -71,24 +86,78 @@ class NativeCodecs {
     this.wasmApi = undefined;
   }
 
+  /**
+   * Creates a native codecs session.
+   * A session keeps the native codec state (i.e. libjpeg objects and tables)
+   * alive across the frames of an instance, saving the per-frame codec setup.
+   * @method
+   * @static
+   * @returns {number} Native codecs session.
+   * @throws {Error} If native codecs module is not initialized.
+   */
+  static createSession() {
+    this._throwIfCodecsModuleIsNotInitialized();
+
+    return this.wasmApi.wasmCreateCodecsContext();
+  }
+
+  /**
+   * Releases a native codecs session.
+   * @method
+   * @static
+   * @param {number} session - Native codecs session.
+   * @throws {Error} If native codecs module is not initialized.
+   */
+  static releaseSession(session) {
+    this._throwIfCodecsModuleIsNotInitialized();
+
+    this.wasmApi.wasmReleaseCodecsContext(session);
+  }
+
+  /**
+   * Gets the native codec scratch memory statistics.
+   * OpenJPEG and the JPEG-XL probe allocate their scratch memory from an arena
+   * that is reclaimed at the end of every encode/decode call. The JPEG-XL
+   * encoders and decoders are kept across the frames of a session, so their
+   * memory is not counted.
+   * @method
+   * @static
+   * @returns {Object} Memory statistics. The high water mark and allocation
+   * count refer to the last encode/decode call, the capacity is the arena
+   * memory retained for the next one, all in bytes.
+   * @throws {Error} If native codecs module is not initialized or does not export the arena
+   * statistics.
+   */
+  static getMemoryStatistics() {
+    this._throwIfCodecsModuleIsNotInitialized();
+    this._throwIfNotExported('GetCodecsArenaHighWaterMark');
+
+    return {
+      highWaterMark: this.wasmApi.wasmGetCodecsArenaHighWaterMark(),
+      capacity: this.wasmApi.wasmGetCodecsArenaCapacity(),
+      allocations: this.wasmApi.wasmGetCodecsArenaAllocations(),
+    };
+  }
+
   /**
    * Decodes RLE frame.
    * @method
    * @static
    * @param {Context} context - Context object with encoded pixels data.
    * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with decoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static decodeRle(context, parameters) {
+  static decodeRle(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createDecoderContext(context);
+    const ctx = this._createDecoderContext(context, session);
     const params = this._createDecoderParameters(parameters);
     this.wasmApi.wasmDecodeRle(ctx, params);
     this._releaseDecoderParameters(params);
 
-    return this._releaseDecoderContext(ctx);
+    return this._releaseDecoderContext(ctx, session);
   }
 
   /**
@@ -97,18 +166,19 @@ class NativeCodecs {
    * @static
    * @param {Context} context - Context object with decoded pixels data.
    * @param {Object} [parameters] - Encoder parameters.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with encoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static encodeRle(context, parameters) {
+  static encodeRle(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createEncoderContext(context);
+    const ctx = this._createEncoderContext(context, session);
     const params = this._createEncoderParameters(parameters);
     this.wasmApi.wasmEncodeRle(ctx, params);
     this._releaseEncoderParameters(params);
 
-    return this._releaseEncoderContext(ctx);
+    return this._releaseEncoderContext(ctx, session);
   }
 
   /**
@@ -118,18 +188,19 @@ class NativeCodecs {
    * @param {Context} context - Context object with encoded pixels data.
    * @param {Object} [parameters] - Decoder parameters.
    * @param {boolean} [parameters.convertColorspaceToRgb] - Convert colorspace to RGB.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with decoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static decodeJpeg(context, parameters) {
+  static decodeJpeg(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createDecoderContext(context);
+    const ctx = this._createDecoderContext(context, session);
     const params = this._createDecoderParameters(parameters);
     this.wasmApi.wasmDecodeJpeg(ctx, params);
     this._releaseDecoderParameters(params);
 
-    return this._releaseDecoderContext(ctx);
+    return this._releaseDecoderContext(ctx, session);
   }
 
   /**
@@ -149,18 +220,48 @@ class NativeCodecs {
    * Sets the libjpeg jpeg_simple_lossless predictor input variable.
    * @param {number} [parameters.pointTransform] - JPEG point transform.
    * Sets the libjpeg jpeg_simple_lossless point_transform input variable.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with encoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static encodeJpeg(context, parameters) {
+  static encodeJpeg(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createEncoderContext(context);
+    const ctx = this._createEncoderContext(context, session);
     const params = this._createEncoderParameters(parameters);
     this.wasmApi.wasmEncodeJpeg(ctx, params);
     this._releaseEncoderParameters(params);
 
-    return this._releaseEncoderContext(ctx);
+    return this._releaseEncoderContext(ctx, session);
+  }
+
+  /**
+   * Transforms JPEG baseline frame in the DCT domain, without decoding the pixels.
+   * The quantized coefficients are rearranged and the frame is not re-quantized,
+   * so no additional loss is introduced.
+   * @method
+   * @static
+   * @param {Context} context - Context object with JPEG encoded pixels data.
+   * @param {Object} [parameters] - Transform parameters.
+   * @param {Array<Object>} [parameters.operations] - Transform operations, applied in order.
+   * Each operation is an object with an operation (JpegTransformOperation) and, for crop
+   * and blank operations, the x, y, width and height of the region.
+   * Crop regions are extended to the nearest MCU boundary at the top-left corner,
+   * while flips and rotations trim partial MCUs at the right and bottom edges.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
+   * @returns {Context} Context object with JPEG encoded pixels data.
+   * @throws {Error} If native codecs module is not initialized or does not export the transform.
+   */
+  static transformJpeg(context, parameters, session) {
+    this._throwIfCodecsModuleIsNotInitialized();
+    this._throwIfNotExported('TransformJpeg');
+
+    const ctx = this._createDecoderContext(context, session);
+    const params = this._createTransformParameters(parameters);
+    this.wasmApi.wasmTransformJpeg(ctx, params);
+    this._releaseTransformParameters(params);
+
+    return this._releaseEncoderContext(ctx, session);
   }
 
   /**
@@ -169,18 +270,19 @@ class NativeCodecs {
    * @static
    * @param {Context} context - Context object with encoded pixels data.
    * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with decoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static decodeJpegLs(context, parameters) {
+  static decodeJpegLs(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createDecoderContext(context);
+    const ctx = this._createDecoderContext(context, session);
     const params = this._createDecoderParameters(parameters);
     this.wasmApi.wasmDecodeJpegLs(ctx, params);
     this._releaseDecoderParameters(params);
 
-    return this._releaseDecoderContext(ctx);
+    return this._releaseDecoderContext(ctx, session);
   }
 
   /**
@@ -192,38 +294,41 @@ class NativeCodecs {
    * @param {boolean} [parameters.lossy] - Lossy encoding.
    * @param {number} [parameters.allowedLossyError] - JPEG-LS allowed lossy error.
    * Sets the charls allowedLossyError variable.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with encoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static encodeJpegLs(context, parameters) {
+  static encodeJpegLs(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createEncoderContext(context);
+    const ctx = this._createEncoderContext(context, session);
     const params = this._createEncoderParameters(parameters);
     this.wasmApi.wasmEncodeJpegLs(ctx, params);
     this._releaseEncoderParameters(params);
 
-    return this._releaseEncoderContext(ctx);
+    return this._releaseEncoderContext(ctx, session);
   }
 
   /**
    * Decodes JPEG2000 frame (lossless or lossy).
+   * The encoded fragments of the context are read in place, without being joined.
    * @method
    * @static
    * @param {Context} context - Context object with encoded pixels data.
    * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with decoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static decodeJpeg2000(context, parameters) {
+  static decodeJpeg2000(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createDecoderContext(context);
+    const ctx = this._createDecoderContext(context, session, true);
     const params = this._createDecoderParameters(parameters);
     this.wasmApi.wasmDecodeJpeg2000(ctx, params);
     this._releaseDecoderParameters(params);
 
-    return this._releaseDecoderContext(ctx);
+    return this._releaseDecoderContext(ctx, session);
   }
 
   /**
@@ -239,18 +344,32 @@ class NativeCodecs {
    * Sets the openjpeg tcp_rates[0] variable.
    * @param {number} [parameters.allowMct] - JPEG 2000 multiple component transform.
    * Sets the openjpeg tcp_mct variable.
+   * @param {number} [parameters.tileWidth] - JPEG 2000 tile width (0 single tile).
+   * @param {number} [parameters.tileHeight] - JPEG 2000 tile height (0 single tile).
+   * @param {number} [parameters.codeBlockStyle] - JPEG 2000 code-block style flags
+   * (1 BYPASS, 2 RESET, 4 TERMALL, 8 VSC, 16 PTERM, 32 SEGSYM).
+   * @param {number} [parameters.codeBlockWidth] - JPEG 2000 code-block width (power of 2).
+   * @param {number} [parameters.codeBlockHeight] - JPEG 2000 code-block height (power of 2).
+   * @param {number} [parameters.numberOfLayers] - JPEG 2000 number of quality layers.
+   * Each layer halves the compression ratio of the previous one, down to the rate.
+   * @param {boolean} [parameters.rateAllocation] - JPEG 2000 rate-distortion allocation.
+   * When false, a single layer keeps every coding pass and the rate is ignored.
+   * @param {number} [parameters.threadCount] - JPEG 2000 worker thread count for the
+   * code-block coding (0 hardware concurrency, 1 serial). Only used by multithreaded
+   * WebAssembly builds.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with encoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static encodeJpeg2000(context, parameters) {
+  static encodeJpeg2000(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createEncoderContext(context);
+    const ctx = this._createEncoderContext(context, session);
     const params = this._createEncoderParameters(parameters);
     this.wasmApi.wasmEncodeJpeg2000(ctx, params);
     this._releaseEncoderParameters(params);
 
-    return this._releaseEncoderContext(ctx);
+    return this._releaseEncoderContext(ctx, session);
   }
 
   /**
@@ -259,18 +378,61 @@ class NativeCodecs {
    * @static
    * @param {Context} context - Context object with encoded pixels data.
    * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [parameters.threadCount] - JPEG-XL worker thread count
+   * (0 hardware concurrency, 1 serial). Only used by multithreaded WebAssembly builds.
+   * @param {number} [parameters.outputColorSpace] - JPEG-XL output color space
+   * (0 sRGB, 1 linear sRGB 32-bit float, 2 XYB 32-bit float). XYB output is only available
+   * for lossy frames stored in XYB with sRGB primaries.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with decoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static decodeJpegXl(context, parameters) {
+  static decodeJpegXl(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createDecoderContext(context);
+    const ctx = this._createDecoderContext(context, session);
     const params = this._createDecoderParameters(parameters);
     this.wasmApi.wasmDecodeJpegXl(ctx, params);
     this._releaseDecoderParameters(params);
 
-    return this._releaseDecoderContext(ctx);
+    return this._releaseDecoderContext(ctx, session);
+  }
+
+  /**
+   * Decodes JPEG-XL frame incrementally, as its bytes arrive.
+   * Each call appends the context encoded data to the bytes received so far and
+   * renders the best approximation available, starting with a 1:8 DC preview once
+   * the DC of the frame has arrived. The frame ends when complete is true.
+   * @method
+   * @static
+   * @param {Context} context - Context object with the next chunk of encoded pixels data.
+   * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [parameters.threadCount] - JPEG-XL worker thread count
+   * (0 hardware concurrency, 1 serial). Only used by multithreaded WebAssembly builds.
+   * @param {number} [parameters.outputColorSpace] - JPEG-XL output color space
+   * (0 sRGB, 1 linear sRGB 32-bit float, 2 XYB 32-bit float).
+   * @param {number} session - Native codecs session, which keeps the decoder state between chunks.
+   * @returns {Object} Result object, with the context (an empty decoded buffer while no pixels
+   * are available yet), complete and downsamplingRatio (8 for the DC preview, 1 at full detail).
+   * @throws {Error} If native codecs module is not initialized or does not export the
+   * incremental decoder, or the session is missing.
+   */
+  static decodeJpegXlIncremental(context, parameters, session) {
+    this._throwIfCodecsModuleIsNotInitialized();
+    this._throwIfNotExported('DecodeJpegXlIncremental');
+    if (session === undefined) {
+      throw new Error('A native codecs session is required for incremental decoding');
+    }
+
+    const ctx = this._createDecoderContext(context, session);
+    const params = this._createDecoderParameters(parameters);
+    this.wasmApi.wasmDecodeJpegXlIncremental(ctx, params);
+    this._releaseDecoderParameters(params);
+
+    const complete = !!this.wasmApi.wasmGetDecodingComplete(ctx);
+    const downsamplingRatio = this.wasmApi.wasmGetDownsamplingRatio(ctx);
+
+    return { context: this._releaseDecoderContext(ctx, session), complete, downsamplingRatio };
   }
 
   /**
@@ -280,18 +442,153 @@ class NativeCodecs {
    * @param {Context} context - Context object with decoded pixels data.
    * @param {Object} [parameters] - Encoder parameters.
    * @param {boolean} [parameters.lossy] - Lossy encoding.
+   * @param {number} [parameters.quality] - JPEG-XL quality, mapped to a butteraugli distance.
+   * @param {number} [parameters.effort] - JPEG-XL encoder effort (1-10).
+   * Lower values encode faster at the cost of larger output.
+   * @param {number} [parameters.decodingSpeed] - JPEG-XL decoding speed tier (0-4).
+   * Higher values favor decoding speed at the cost of larger output.
+   * @param {number} [parameters.modular] - JPEG-XL mode (-1 libjxl default, 0 VarDCT, 1 modular).
+   * @param {number} [parameters.modularPredictor] - JPEG-XL modular predictor (-1 libjxl default).
+   * @param {number} [parameters.modularGroupSize] - JPEG-XL modular group size shift
+   * (-1 libjxl default, 0 128px, 1 256px, 2 512px, 3 1024px).
+   * @param {number} [parameters.brotliEffort] - JPEG-XL Brotli effort (-1 libjxl default, 0-11).
+   * @param {number} [parameters.threadCount] - JPEG-XL worker thread count
+   * (0 hardware concurrency, 1 serial). Only used by multithreaded WebAssembly builds.
+   * @param {boolean} [parameters.progressive] - Progressive (responsive) JPEG-XL encoding,
+   * for incremental decoding. Lossless progressive frames are noticeably larger.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with encoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static encodeJpegXl(context, parameters) {
+  static encodeJpegXl(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createEncoderContext(context);
+    const ctx = this._createEncoderContext(context, session);
     const params = this._createEncoderParameters(parameters);
     this.wasmApi.wasmEncodeJpegXl(ctx, params);
     this._releaseEncoderParameters(params);
 
-    return this._releaseEncoderContext(ctx);
+    return this._releaseEncoderContext(ctx, session);
+  }
+
+  /**
+   * Transcodes JPEG baseline frame to JPEG-XL, using lossless JPEG recompression.
+   * The DCT coefficients are recompressed without decoding the pixels and the
+   * original JPEG bitstream can be reconstructed bit-exactly.
+   * @method
+   * @static
+   * @param {Context} context - Context object with JPEG encoded pixels data.
+   * @param {Object} [parameters] - Encoder parameters.
+   * @param {number} [parameters.effort] - JPEG-XL encoder effort (1-10).
+   * @param {number} [parameters.brotliEffort] - JPEG-XL Brotli effort (-1 libjxl default, 0-11).
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
+   * @returns {Context} Context object with JPEG-XL encoded pixels data.
+   * @throws {Error} If native codecs module is not initialized or does not export the transcoder.
+   */
+  static transcodeJpegToJpegXl(context, parameters, session) {
+    this._throwIfCodecsModuleIsNotInitialized();
+    this._throwIfNotExported('TranscodeJpegToJpegXl');
+
+    const ctx = this._createDecoderContext(context, session);
+    const params = this._createEncoderParameters(parameters);
+    this.wasmApi.wasmTranscodeJpegToJpegXl(ctx, params);
+    this._releaseEncoderParameters(params);
+
+    return this._releaseEncoderContext(ctx, session);
+  }
+
+  /**
+   * Transcodes JPEG-XL frame, created with lossless JPEG recompression, back to
+   * the original JPEG baseline bitstream.
+   * @method
+   * @static
+   * @param {Context} context - Context object with JPEG-XL encoded pixels data.
+   * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
+   * @returns {Context} Context object with JPEG encoded pixels data.
+   * @throws {Error} If native codecs module is not initialized or does not export the transcoder.
+   */
+  static transcodeJpegXlToJpeg(context, parameters, session) {
+    this._throwIfCodecsModuleIsNotInitialized();
+    this._throwIfNotExported('TranscodeJpegXlToJpeg');
+
+    const ctx = this._createDecoderContext(context, session);
+    const params = this._createDecoderParameters(parameters);
+    this.wasmApi.wasmTranscodeJpegXlToJpeg(ctx, params);
+    this._releaseDecoderParameters(params);
+
+    return this._releaseEncoderContext(ctx, session);
+  }
+
+  /**
+   * Checks whether a frame can be transcoded natively with a decoder and an encoder.
+   * Modules that do not export TranscodeFrame cannot transcode any frame natively.
+   * @method
+   * @static
+   * @param {string} decoderFnName - Decoder function name (e.g. decodeJpeg2000).
+   * @param {string} encoderFnName - Encoder function name (e.g. encodeHtJpeg2000).
+   * @returns {boolean} Whether the frame can be transcoded natively.
+   */
+  static canTranscodeFrame(decoderFnName, encoderFnName) {
+    return (
+      this._isExported('TranscodeFrame') &&
+      TranscodeFrameCodec[String(decoderFnName).replace(/^decode/, '')] !== undefined &&
+      TranscodeFrameCodec[String(encoderFnName).replace(/^encode/, '')] !== undefined
+    );
+  }
+
+  /**
+   * Transcodes frame, by decoding and encoding it again within the native codecs,
+   * without gathering the decoded pixels data.
+   * @method
+   * @static
+   * @param {Context} context - Context object with encoded pixels data.
+   * @param {string} decoderFnName - Decoder function name (e.g. decodeJpeg2000).
+   * @param {Object} [decoderParameters] - Decoder parameters.
+   * @param {string} encoderFnName - Encoder function name (e.g. encodeHtJpeg2000).
+   * @param {Object} [encoderParameters] - Encoder parameters.
+   * @param {string} photometricInterpretation - Photometric interpretation of the decoded
+   * pixels data, as passed to the encoder.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
+   * @returns {Context} Context object with encoded pixels data.
+   * @throws {Error} If native codecs module is not initialized or the decoder or encoder
+   * cannot be chained natively.
+   */
+  static transcodeFrame(
+    context,
+    decoderFnName,
+    decoderParameters,
+    encoderFnName,
+    encoderParameters,
+    photometricInterpretation,
+    session
+  ) {
+    this._throwIfCodecsModuleIsNotInitialized();
+    if (!this.canTranscodeFrame(decoderFnName, encoderFnName)) {
+      throw new Error(
+        `Native frame transcoding is not supported [decoder: ${decoderFnName}, encoder: ${encoderFnName}]`
+      );
+    }
+
+    const ctx = this._createDecoderContext(
+      context,
+      session,
+      decoderFnName === this.decodeJpeg2000.name
+    );
+    const decoderParams = this._createDecoderParameters(decoderParameters);
+    const encoderParams = this._createEncoderParameters(encoderParameters);
+    this.wasmApi.wasmTranscodeFrame(
+      ctx,
+      TranscodeFrameCodec[decoderFnName.replace(/^decode/, '')],
+      decoderParams,
+      TranscodeFrameCodec[encoderFnName.replace(/^encode/, '')],
+      encoderParams,
+      Object.values(PhotometricInterpretation).indexOf(photometricInterpretation)
+    );
+    this._releaseEncoderParameters(encoderParams);
+    this._releaseDecoderParameters(decoderParams);
+
+    return this._releaseEncoderContext(ctx, session);
   }
 
   /**
@@ -300,18 +597,23 @@ class NativeCodecs {
    * @static
    * @param {Context} context - Context object with encoded pixels data.
    * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [parameters.threadCount] - HT-JPEG 2000 worker thread count for tiled
+   * frames (0 hardware concurrency, 1 serial). Only used by multithreaded WebAssembly builds.
+   * @param {boolean} [parameters.resilient] - Tolerate corrupted or truncated codestreams.
+   * The default strict parsing suits trusted frames, such as those encoded by this library.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with decoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static decodeHtJpeg2000(context, parameters) {
+  static decodeHtJpeg2000(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createDecoderContext(context);
+    const ctx = this._createDecoderContext(context, session);
     const params = this._createDecoderParameters(parameters);
     this.wasmApi.wasmDecodeHtJpeg2000(ctx, params);
     this._releaseDecoderParameters(params);
 
-    return this._releaseDecoderContext(ctx);
+    return this._releaseDecoderContext(ctx, session);
   }
 
   /**
@@ -323,18 +625,141 @@ class NativeCodecs {
    * @param {boolean} [parameters.lossy] - Lossy encoding.
    * @param {number} [parameters.progressionOrder] - JPEG 2000 progression order.
    * 0: LRCP, 1: RLCP, 2: RPCL, 3: PCRL, 4: CPRL.
+   * @param {number} [parameters.tileWidth] - HT-JPEG 2000 tile width (0 single tile).
+   * @param {number} [parameters.tileHeight] - HT-JPEG 2000 tile height (0 single tile).
+   * @param {number} [parameters.precinctWidth] - HT-JPEG 2000 precinct width, a power of 2
+   * (0 a single precinct per resolution).
+   * @param {number} [parameters.precinctHeight] - HT-JPEG 2000 precinct height, a power of 2
+   * (0 a single precinct per resolution).
+   * @param {boolean} [parameters.packetLengthMarkers] - HT-JPEG 2000 PLT marker segments,
+   * listing the packet lengths in each tile-part header.
+   * @param {boolean} [parameters.streaming] - HT-JPEG 2000 streaming profile, which defaults
+   * to RPCL progression, 128x128 precincts and PLT marker segments.
+   * @param {number} [parameters.quantizationStep] - HT-JPEG 2000 lossy quantization step,
+   * in sample units (0 OpenJPH default of 1).
+   * @param {number} [parameters.targetBytes] - HT-JPEG 2000 lossy codestream size, in bytes,
+   * for which the quantization step is predicted (0 none).
+   * @param {number} [parameters.targetPsnr] - HT-JPEG 2000 lossy PSNR, in dB, for which the
+   * quantization step is predicted (0 none).
+   * @param {number} [parameters.threadCount] - HT-JPEG 2000 worker thread count for the
+   * tiles (0 hardware concurrency, 1 serial). Only used by multithreaded WebAssembly builds.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
    * @returns {Context} Context object with encoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static encodeHtJpeg2000(context, parameters) {
+  static encodeHtJpeg2000(context, parameters, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
-    const ctx = this._createEncoderContext(context);
+    const ctx = this._createEncoderContext(context, session);
     const params = this._createEncoderParameters(parameters);
     this.wasmApi.wasmEncodeHtJpeg2000(ctx, params);
     this._releaseEncoderParameters(params);
 
-    return this._releaseEncoderContext(ctx);
+    return this._releaseEncoderContext(ctx, session);
+  }
+
+  /**
+   * Indexes the packets of a single quality layer High-Throughput JPEG2000 frame,
+   * without decoding the pixels data. The byte ranges allow fetching a resolution
+   * or a region of the frame on its own.
+   * @method
+   * @static
+   * @param {Context} context - Context object with encoded pixels data.
+   * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
+   * @returns {Object} Packet index object, with mainHeaderSize, tileParts (tile, offset,
+   * headerSize, size) and packets (tile, tilePart, resolution, component, precinct, offset,
+   * size), in codestream order.
+   * @throws {Error} If native codecs module is not initialized or does not export the indexer.
+   */
+  static indexHtJpeg2000(context, parameters, session) {
+    this._throwIfCodecsModuleIsNotInitialized();
+    this._throwIfNotExported('IndexHtJpeg2000');
+
+    const ctx = this._createDecoderContext(context, session);
+    const params = this._createDecoderParameters(parameters);
+    this.wasmApi.wasmIndexHtJpeg2000(ctx, params);
+    this._releaseDecoderParameters(params);
+
+    const heap8 = new Uint8Array(this.wasmApi.wasmMemory.buffer);
+    const view = new DataView(
+      heap8.buffer,
+      this.wasmApi.wasmGetDecodedBuffer(ctx),
+      this.wasmApi.wasmGetDecodedBufferSize(ctx)
+    );
+    let offset = 0;
+    const next = () => {
+      const word = view.getUint32(offset, true);
+      offset += 4;
+      return word;
+    };
+    const mainHeaderSize = next();
+    const tilePartCount = next();
+    const packetCount = next();
+    const tileParts = Array.from({ length: tilePartCount }, () => ({
+      tile: next(),
+      offset: next(),
+      headerSize: next(),
+      size: next(),
+    }));
+    const packets = Array.from({ length: packetCount }, () => ({
+      tile: next(),
+      tilePart: next(),
+      resolution: next(),
+      component: next(),
+      precinct: next(),
+      offset: next(),
+      size: next(),
+    }));
+
+    if (session === undefined) {
+      this.wasmApi.wasmReleaseCodecsContext(ctx);
+    }
+
+    return { mainHeaderSize, tileParts, packets };
+  }
+
+  /**
+   * Probes the encoded frame headers, without decoding the pixels data.
+   * The codec is detected from the encoded data signature.
+   * RLE frames carry no dimensions, which are kept from the context.
+   * @method
+   * @static
+   * @param {Context} context - Context object with encoded pixels data.
+   * @param {Object} [parameters] - Decoder parameters.
+   * @param {number} [session] - Native codecs session, kept across the frames of an instance.
+   * @returns {Object} Image info object, with width, height, bitsAllocated, bitsStored,
+   * samplesPerPixel, pixelRepresentation, colorTransform, tileWidth, tileHeight and
+   * decompositionLevels.
+   * @throws {Error} If native codecs module is not initialized or does not export the probe.
+   */
+  static probeImage(context, parameters, session) {
+    this._throwIfCodecsModuleIsNotInitialized();
+    this._throwIfNotExported('ProbeImage');
+
+    const ctx = this._createDecoderContext(context, session);
+    const params = this._createDecoderParameters(parameters);
+    this.wasmApi.wasmProbeImage(ctx, params);
+    this._releaseDecoderParameters(params);
+
+    const info = {
+      width: this.wasmApi.wasmGetColumns(ctx),
+      height: this.wasmApi.wasmGetRows(ctx),
+      bitsAllocated: this.wasmApi.wasmGetBitsAllocated(ctx),
+      bitsStored: this.wasmApi.wasmGetBitsStored(ctx),
+      samplesPerPixel: this.wasmApi.wasmGetSamplesPerPixel(ctx),
+      pixelRepresentation: this.wasmApi.wasmGetPixelRepresentation(ctx),
+      colorTransform: !!this.wasmApi.wasmGetColorTransform(ctx),
+      tileWidth: this.wasmApi.wasmGetTileWidth(ctx),
+      tileHeight: this.wasmApi.wasmGetTileHeight(ctx),
+      decompositionLevels: this.wasmApi.wasmGetDecompositionLevels(ctx),
+    };
+
+    if (session === undefined) {
+      this.wasmApi.wasmReleaseCodecsContext(ctx);
+    }
+
+    return info;
   }
 
   //#region Private Methods
@@ -344,14 +769,18 @@ class NativeCodecs {
    * @static
    * @private
    * @param {Context} context - Context object with encoded pixels data.
+   * @param {number} [session] - Native codecs session to use as the decoder context.
+   * @param {boolean} [readsFragments] - Whether the decoder reads the encoded fragments
+   * in place. Otherwise, or if the module does not export AddEncodedFragment, they are
+   * joined to the encoded buffer.
    * @returns {number} Decoder context pointer.
    * @throws {Error} If native codecs module is not initialized or the context values are invalid.
    */
-  static _createDecoderContext(context) {
+  static _createDecoderContext(context, session, readsFragments = false) {
     this._throwIfCodecsModuleIsNotInitialized();
     context.validate();
 
-    const ctx = this.wasmApi.wasmCreateCodecsContext();
+    const ctx = session !== undefined ? session : this.wasmApi.wasmCreateCodecsContext();
     this.wasmApi.wasmSetColumns(ctx, context.getWidth());
     this.wasmApi.wasmSetRows(ctx, context.getHeight());
     this.wasmApi.wasmSetBitsAllocated(ctx, context.getBitsAllocated());
@@ -365,10 +794,29 @@ class NativeCodecs {
     );
 
     const encodedData = context.getEncodedBuffer();
-    this.wasmApi.wasmSetEncodedBufferSize(ctx, encodedData.length);
+    const encodedFragments = context.getEncodedFragments() || [];
+    const readsFragmentsInPlace = readsFragments && this._isExported('AddEncodedFragment');
+    const joinedFragments = readsFragmentsInPlace ? [] : encodedFragments;
+    const encodedDataSize = joinedFragments.reduce(
+      (size, fragment) => size + fragment.length,
+      encodedData.length
+    );
+    this.wasmApi.wasmSetEncodedBufferSize(ctx, encodedDataSize);
     const encodedDataPointer = this.wasmApi.wasmGetEncodedBuffer(ctx);
     const heap8 = new Uint8Array(this.wasmApi.wasmMemory.buffer);
     heap8.set(encodedData, encodedDataPointer);
+    let encodedDataOffset = encodedData.length;
+    joinedFragments.forEach((fragment) => {
+      heap8.set(fragment, encodedDataPointer + encodedDataOffset);
+      encodedDataOffset += fragment.length;
+    });
+
+    if (readsFragmentsInPlace) {
+      encodedFragments.forEach((fragment) => {
+        const fragmentPointer = this.wasmApi.wasmAddEncodedFragment(ctx, fragment.length);
+        new Uint8Array(this.wasmApi.wasmMemory.buffer).set(fragment, fragmentPointer);
+      });
+    }
 
     return ctx;
   }
@@ -379,14 +827,15 @@ class NativeCodecs {
    * @static
    * @private
    * @param {Context} context - Context object with encoded pixels data.
+   * @param {number} [session] - Native codecs session to use as the encoder context.
    * @returns {number} Encoder context pointer.
    * @throws {Error} If native codecs module is not initialized or the context values are invalid.
    */
-  static _createEncoderContext(context) {
+  static _createEncoderContext(context, session) {
     this._throwIfCodecsModuleIsNotInitialized();
     context.validate();
 
-    const ctx = this.wasmApi.wasmCreateCodecsContext();
+    const ctx = session !== undefined ? session : this.wasmApi.wasmCreateCodecsContext();
     this.wasmApi.wasmSetColumns(ctx, context.getWidth());
     this.wasmApi.wasmSetRows(ctx, context.getHeight());
     this.wasmApi.wasmSetBitsAllocated(ctx, context.getBitsAllocated());
@@ -414,10 +863,11 @@ class NativeCodecs {
    * @static
    * @private
    * @param {number} ctx - Decoder context pointer.
+   * @param {number} [session] - Native codecs session, which is not released.
    * @returns {Context} Context object with decoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static _releaseDecoderContext(ctx) {
+  static _releaseDecoderContext(ctx, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
     const decodedDataPointer = this.wasmApi.wasmGetDecodedBuffer(ctx);
@@ -441,7 +891,9 @@ class NativeCodecs {
       decodedBuffer: decodedData,
     });
 
-    this.wasmApi.wasmReleaseCodecsContext(ctx);
+    if (session === undefined) {
+      this.wasmApi.wasmReleaseCodecsContext(ctx);
+    }
 
     return context;
   }
@@ -452,10 +904,11 @@ class NativeCodecs {
    * @static
    * @private
    * @param {number} ctx - Encoder context pointer.
+   * @param {number} [session] - Native codecs session, which is not released.
    * @returns {Context} Context object with encoded pixels data.
    * @throws {Error} If native codecs module is not initialized.
    */
-  static _releaseEncoderContext(ctx) {
+  static _releaseEncoderContext(ctx, session) {
     this._throwIfCodecsModuleIsNotInitialized();
 
     const encodedDataPointer = this.wasmApi.wasmGetEncodedBuffer(ctx);
@@ -479,7 +932,9 @@ class NativeCodecs {
       encodedBuffer: encodedData,
     });
 
-    this.wasmApi.wasmReleaseCodecsContext(ctx);
+    if (session === undefined) {
+      this.wasmApi.wasmReleaseCodecsContext(ctx);
+    }
 
     return context;
   }
@@ -491,6 +946,9 @@ class NativeCodecs {
    * @private
    * @param {Object} [parameters] - Decoder parameters.
    * @param {boolean} [parameters.convertColorspaceToRgb] - Convert colorspace to RGB.
+   * @param {number} [parameters.threadCount] - HT-JPEG 2000 and JPEG-XL worker thread count.
+   * @param {boolean} [parameters.resilient] - HT-JPEG 2000 resilient decoding.
+   * @param {number} [parameters.outputColorSpace] - JPEG-XL output color space.
    * @returns {number} Decoder parameters pointer.
    * @throws {Error} If native codecs module is not initialized.
    */
@@ -499,6 +957,10 @@ class NativeCodecs {
 
     const params = this.wasmApi.wasmCreateDecoderParameters();
     this.wasmApi.wasmSetConvertColorspaceToRgb(params, parameters.convertColorspaceToRgb || false);
+    // Modules built before a parameter was added keep its native default
+    this._setOptionalParameter('SetDecoderThreadCount', params, parameters.threadCount, 0);
+    this._setOptionalParameter('SetResilient', params, parameters.resilient, false);
+    this._setOptionalParameter('SetOutputColorSpace', params, parameters.outputColorSpace, 0);
 
     return params;
   }
@@ -519,6 +981,29 @@ class NativeCodecs {
    * @param {number} [parameters.progressionOrder] - JPEG 2000 progression order.
    * @param {number} [parameters.rate] - JPEG 2000 compression rate.
    * @param {number} [parameters.allowMct] - JPEG 2000 compression rate.
+   * @param {number} [parameters.tileWidth] - JPEG 2000 and HT-JPEG 2000 tile width.
+   * @param {number} [parameters.tileHeight] - JPEG 2000 and HT-JPEG 2000 tile height.
+   * @param {number} [parameters.precinctWidth] - HT-JPEG 2000 precinct width.
+   * @param {number} [parameters.precinctHeight] - HT-JPEG 2000 precinct height.
+   * @param {boolean} [parameters.packetLengthMarkers] - HT-JPEG 2000 PLT marker segments.
+   * @param {boolean} [parameters.streaming] - HT-JPEG 2000 streaming profile defaults.
+   * @param {number} [parameters.quantizationStep] - HT-JPEG 2000 lossy quantization step.
+   * @param {number} [parameters.targetBytes] - HT-JPEG 2000 lossy codestream size target.
+   * @param {number} [parameters.targetPsnr] - HT-JPEG 2000 lossy PSNR target.
+   * @param {number} [parameters.codeBlockStyle] - JPEG 2000 code-block style flags.
+   * @param {number} [parameters.codeBlockWidth] - JPEG 2000 code-block width.
+   * @param {number} [parameters.codeBlockHeight] - JPEG 2000 code-block height.
+   * @param {number} [parameters.numberOfLayers] - JPEG 2000 number of quality layers.
+   * @param {boolean} [parameters.rateAllocation] - JPEG 2000 rate-distortion allocation.
+   * @param {number} [parameters.effort] - JPEG-XL encoder effort.
+   * @param {number} [parameters.decodingSpeed] - JPEG-XL decoding speed tier.
+   * @param {number} [parameters.modular] - JPEG-XL modular mode.
+   * @param {number} [parameters.modularPredictor] - JPEG-XL modular predictor.
+   * @param {number} [parameters.modularGroupSize] - JPEG-XL modular group size shift.
+   * @param {number} [parameters.brotliEffort] - JPEG-XL Brotli effort.
+   * @param {number} [parameters.threadCount] - JPEG 2000, HT-JPEG 2000 and JPEG-XL worker
+   * thread count.
+   * @param {boolean} [parameters.progressive] - JPEG-XL progressive encoding.
    * @returns {number} Encoder parameters pointer.
    * @throws {Error} If native codecs module is not initialized.
    */
@@ -539,11 +1024,77 @@ class NativeCodecs {
     this.wasmApi.wasmSetProgressionOrder(
       params,
       Object.values(Jpeg2000ProgressionOrder).indexOf(
-        parameters.progressionOrder ?? Jpeg2000ProgressionOrder.Lrcp
+        parameters.progressionOrder ??
+          (parameters.streaming ? Jpeg2000ProgressionOrder.Rpcl : Jpeg2000ProgressionOrder.Lrcp)
       )
     );
     this.wasmApi.wasmSetRate(params, parameters.rate ?? 20);
     this.wasmApi.wasmSetAllowMct(params, parameters.allowMct ?? 1);
+    // Modules built before a parameter was added keep its native default
+    this._setOptionalParameter('SetEncoderTileWidth', params, parameters.tileWidth, 0);
+    this._setOptionalParameter('SetEncoderTileHeight', params, parameters.tileHeight, 0);
+    this._setOptionalParameter(
+      'SetPrecinctWidth',
+      params,
+      parameters.precinctWidth ?? (parameters.streaming ? 128 : undefined),
+      0
+    );
+    this._setOptionalParameter(
+      'SetPrecinctHeight',
+      params,
+      parameters.precinctHeight ?? (parameters.streaming ? 128 : undefined),
+      0
+    );
+    this._setOptionalParameter(
+      'SetPacketLengthMarkers',
+      params,
+      parameters.packetLengthMarkers ?? (parameters.streaming ? true : undefined),
+      false
+    );
+    this._setOptionalParameter('SetQuantizationStep', params, parameters.quantizationStep, 0);
+    this._setOptionalParameter('SetTargetBytes', params, parameters.targetBytes, 0);
+    this._setOptionalParameter('SetTargetPsnr', params, parameters.targetPsnr, 0);
+    this._setOptionalParameter('SetCodeBlockStyle', params, parameters.codeBlockStyle, 0);
+    this._setOptionalParameter('SetCodeBlockWidth', params, parameters.codeBlockWidth, 64);
+    this._setOptionalParameter('SetCodeBlockHeight', params, parameters.codeBlockHeight, 64);
+    this._setOptionalParameter('SetNumberOfLayers', params, parameters.numberOfLayers, 1);
+    this._setOptionalParameter('SetRateAllocation', params, parameters.rateAllocation, true);
+    this._setOptionalParameter('SetEffort', params, parameters.effort, 7);
+    this._setOptionalParameter('SetDecodingSpeed', params, parameters.decodingSpeed, 0);
+    this._setOptionalParameter('SetModular', params, parameters.modular, -1);
+    this._setOptionalParameter('SetModularPredictor', params, parameters.modularPredictor, -1);
+    this._setOptionalParameter('SetModularGroupSize', params, parameters.modularGroupSize, -1);
+    this._setOptionalParameter('SetBrotliEffort', params, parameters.brotliEffort, -1);
+    this._setOptionalParameter('SetEncoderThreadCount', params, parameters.threadCount, 0);
+    this._setOptionalParameter('SetProgressive', params, parameters.progressive, false);
+
+    return params;
+  }
+
+  /**
+   * Creates the transform parameters.
+   * @method
+   * @static
+   * @private
+   * @param {Object} [parameters] - Transform parameters.
+   * @param {Array<Object>} [parameters.operations] - Transform operations.
+   * @returns {number} Transform parameters pointer.
+   * @throws {Error} If native codecs module is not initialized.
+   */
+  static _createTransformParameters(parameters = {}) {
+    this._throwIfCodecsModuleIsNotInitialized();
+
+    const params = this.wasmApi.wasmCreateTransformParameters();
+    (parameters.operations || []).forEach((op) => {
+      this.wasmApi.wasmAddTransformOperation(
+        params,
+        Object.values(JpegTransformOperation).indexOf(op.operation),
+        op.x ?? 0,
+        op.y ?? 0,
+        op.width ?? 0,
+        op.height ?? 0
+      );
+    });
 
     return params;
   }
@@ -576,6 +1127,20 @@ class NativeCodecs {
     this.wasmApi.wasmReleaseEncoderParameters(params);
   }
 
+  /**
+   * Releases the transform parameters.
+   * @method
+   * @static
+   * @private
+   * @param {number} params - Transform parameters pointer.
+   * @throws {Error} If native codecs module is not initialized.
+   */
+  static _releaseTransformParameters(params) {
+    this._throwIfCodecsModuleIsNotInitialized();
+
+    this.wasmApi.wasmReleaseTransformParameters(params);
+  }
+
   /**
    * Creates WebAssembly instance.
    * @method
@@ -864,6 +1429,61 @@ class NativeCodecs {
     return str.split('').map((x) => x.charCodeAt(0));
   }
 
+  /**
+   * Checks whether the native codecs module exports a function.
+   * Modules built before a function was added do not export it.
+   * @method
+   * @static
+   * @private
+   * @param {string} fnName - Native function name (e.g. SetEffort).
+   * @returns {boolean} Whether the native codecs module exports the function.
+   */
+  static _isExported(fnName) {
+    return this.wasmApi !== undefined && typeof this.wasmApi[`wasm${fnName}`] === 'function';
+  }
+
+  /**
+   * Sets a parameter with a native setter that older modules may not export.
+   * Without the setter, the native default is kept, so only a value other
+   * than the default requires it.
+   * @method
+   * @static
+   * @private
+   * @param {string} setterFnName - Native setter function name (e.g. SetEffort).
+   * @param {number} params - Parameters pointer.
+   * @param {number|boolean} [value] - Parameter value.
+   * @param {number|boolean} defaultValue - Parameter default value.
+   * @throws {Error} If the native codecs module does not export the setter and
+   * the value is not the default.
+   */
+  static _setOptionalParameter(setterFnName, params, value, defaultValue) {
+    if (!this._isExported(setterFnName)) {
+      if (value !== undefined && value !== defaultValue) {
+        throw new Error(
+          `Native codecs module does not export ${setterFnName}, it needs to be rebuilt`
+        );
+      }
+
+      return;
+    }
+
+    this.wasmApi[`wasm${setterFnName}`](params, value ?? defaultValue);
+  }
+
+  /**
+   * Throws error in case the native codecs module does not export a function.
+   * @method
+   * @static
+   * @private
+   * @param {string} fnName - Native function name (e.g. TranscodeFrame).
+   * @throws {Error} If the native codecs module does not export the function.
+   */
+  static _throwIfNotExported(fnName) {
+    if (!this._isExported(fnName)) {
+      throw new Error(`Native codecs module does not export ${fnName}, it needs to be rebuilt`);
+    }
+  }
+
   /**
    * Throws error in case the native codecs module is not initialized.
    * @method
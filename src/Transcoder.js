@@ -4,7 +4,7 @@ const {
   TranscodeMap,
   TransferSyntax,
 } = require('./../src/Constants');
-const { Codec } = require('./../src/Codecs');
+const { Codec, FrameStream } = require('./../src/Codecs');
 
 const dcmjs = require('dcmjs');
 const { DicomDict, DicomMessage, DicomMetaDictionary, ReadBufferStream, WriteBufferStream } =
@@ -41,6 +41,8 @@ class Transcoder {
 
   /**
    * Transcodes the provided DICOM elements to a new transfer syntax UID.
+   * Between encapsulated transfer syntaxes, the frames are decoded and encoded one at a time,
+   * natively when no pixel conversion is needed.
    * @method
    * @param {string} newTransferSyntaxUid - New transfer syntax UID.
    * @param {Object} [parameters] - Encoding and decoding parameters.
@@ -69,9 +71,22 @@ class Transcoder {
       );
     }
 
+    let streamFrames = false;
     if (oldSyntaxMapItem.encapsulated && newSyntaxMapItem.encapsulated) {
-      this.transcode(TransferSyntax.ExplicitVRLittleEndian, parameters);
-      oldTransferSyntaxUid = TransferSyntax.ExplicitVRLittleEndian;
+      // Use a direct path, if one exists, that avoids decoding the pixels
+      const codec = Codec.getCodec(newTransferSyntaxUid);
+      if (codec.canTranscodeFrom(oldTransferSyntaxUid)) {
+        if (this._getElement('PixelData')) {
+          this.elements = codec.transcodeFrom(this.getElements(), oldTransferSyntaxUid, parameters);
+        }
+        this.transferSyntaxUid = newTransferSyntaxUid;
+
+        return;
+      }
+
+      // Decode and encode the frames one at a time, without an intermediate
+      // uncompressed dataset
+      streamFrames = true;
     }
 
     if (this._getElement('PixelData')) {
@@ -85,11 +100,26 @@ class Transcoder {
       let updatedElements = this.getElements();
       if (oldSyntaxMapItem.encapsulated || oldSyntaxMapItem.bigEndian) {
         const codec = Codec.getCodec(oldTransferSyntaxUid);
-        updatedElements = codec.decode(updatedElements, oldTransferSyntaxUid, parameters);
+        updatedElements = codec.decode(
+          updatedElements,
+          oldTransferSyntaxUid,
+          streamFrames ? { ...parameters, streamFrames } : parameters
+        );
+        if (streamFrames) {
+          oldTransferSyntaxUid = TransferSyntax.ExplicitVRLittleEndian;
+        }
       }
-      if (newSyntaxMapItem.encapsulated || newSyntaxMapItem.bigEndian) {
-        const codec = Codec.getCodec(newTransferSyntaxUid);
-        updatedElements = codec.encode(updatedElements, oldTransferSyntaxUid, parameters);
+      const frameStream =
+        updatedElements.PixelData instanceof FrameStream ? updatedElements.PixelData : undefined;
+      try {
+        if (newSyntaxMapItem.encapsulated || newSyntaxMapItem.bigEndian) {
+          const codec = Codec.getCodec(newTransferSyntaxUid);
+          updatedElements = codec.encode(updatedElements, oldTransferSyntaxUid, parameters);
+        }
+      } finally {
+        if (frameStream) {
+          frameStream.release();
+        }
       }
 
       this.elements = updatedElements;
@@ -98,6 +128,29 @@ class Transcoder {
     this.transferSyntaxUid = newTransferSyntaxUid;
   }
 
+  /**
+   * Transforms the JPEG baseline pixel data in the DCT domain, without decoding it.
+   * Crop, blank-out, flip and rotation are lossless and the transfer syntax is kept.
+   * @method
+   * @param {Array<Object>} operations - Transform operations, applied in order.
+   * Each operation is an object with an operation (JpegTransformOperation) and, for crop
+   * and blank operations, the x, y, width and height of the region.
+   * @throws {Error} If the transfer syntax is not JpegBaselineProcess1.
+   */
+  transformJpeg(operations) {
+    const transferSyntaxUid = this.getTransferSyntaxUid();
+    if (transferSyntaxUid !== TransferSyntax.JpegBaselineProcess1) {
+      throw new Error(
+        `JPEG transforms are supported for JpegBaselineProcess1 transfer syntax [syntax: ${transferSyntaxUid}]`
+      );
+    }
+
+    if (this._getElement('PixelData')) {
+      const codec = Codec.getCodec(transferSyntaxUid);
+      this.elements = codec.transform(this.getElements(), transferSyntaxUid, { operations });
+    }
+  }
+
   /**
    * Gets DICOM transfer syntax UID.
    * @method
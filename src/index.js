@@ -17,6 +17,7 @@ const {
 const {
   Jpeg2000ProgressionOrder,
   JpegSampleFactor,
+  JpegTransformOperation,
   PhotometricInterpretation,
   PixelRepresentation,
   PlanarConfiguration,
@@ -51,6 +52,7 @@ const codecs = {
 const constants = {
   Jpeg2000ProgressionOrder,
   JpegSampleFactor,
+  JpegTransformOperation,
   PhotometricInterpretation,
   PixelRepresentation,
   PlanarConfiguration,
@@ -18,6 +18,10 @@ describe('Codecs', () => {
     expect(() => {
       subclassedCodec.decode({}, '', {});
     }).to.throw();
+    expect(subclassedCodec.canTranscodeFrom('')).to.be.false;
+    expect(() => {
+      subclassedCodec.transcodeFrom({}, '', {});
+    }).to.throw();
   });
 
   it('should throw for an unsupported transfer syntax UID', () => {
@@ -20,6 +20,7 @@ describe('Context', () => {
     expect(context.getPlanarConfiguration()).to.be.undefined;
     expect(context.getPhotometricInterpretation()).to.be.undefined;
     expect(context.getEncodedBuffer()).to.be.undefined;
+    expect(context.getEncodedFragments()).to.be.undefined;
     expect(context.getDecodedBuffer()).to.be.undefined;
 
     context.setWidth(1024);
@@ -52,6 +53,7 @@ describe('Context', () => {
       planarConfiguration: PlanarConfiguration.Interleaved,
       photometricInterpretation: PhotometricInterpretation.Monochrome1,
       encodedBuffer: new Uint8Array([1, 2, 3]),
+      encodedFragments: [new Uint8Array([7, 8]), new Uint8Array([9])],
       decodedBuffer: new Uint8Array([4, 5, 6]),
     };
 
@@ -65,6 +67,7 @@ describe('Context', () => {
     expect(context.getPlanarConfiguration()).to.equal(attrs.planarConfiguration);
     expect(context.getPhotometricInterpretation()).to.equal(attrs.photometricInterpretation);
     expect(context.getEncodedBuffer()).to.deep.equal(attrs.encodedBuffer);
+    expect(context.getEncodedFragments()).to.deep.equal(attrs.encodedFragments);
     expect(context.getDecodedBuffer()).to.deep.equal(attrs.decodedBuffer);
     expect(context.toString()).to.be.a('string');
   });
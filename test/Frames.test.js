@@ -129,6 +129,30 @@ describe('Frames', () => {
     });
   });
 
+  it('should get the fragments of a single frame', () => {
+    const fragment1 = Uint8Array.from([0xff, 0x4f, 0xff]);
+    const fragment2 = Uint8Array.from([0x51, 0x00]);
+    const fragment3 = Uint8Array.from([0x29, 0x00, 0x00, 0x01]);
+    const elements = {
+      NumberOfFrames: 1,
+      Columns: 2,
+      Rows: 2,
+      BitsAllocated: 8,
+      BitsStored: 8,
+      HighBit: 7,
+      SamplesPerPixel: 1,
+      PixelRepresentation: PixelRepresentation.Unsigned,
+      PhotometricInterpretation: PhotometricInterpretation.Monochrome2,
+      PixelData: [fragment1.buffer, fragment2.buffer, fragment3.buffer],
+    };
+
+    const frames = new Frames(elements, TransferSyntax.Jpeg2000Lossless);
+    expect(frames.getFrameFragments(0)).to.deep.equal([fragment1, fragment2, fragment3]);
+    expect(frames.getFrameBuffer(0)).to.deep.equal(
+      Uint8Array.from([0xff, 0x4f, 0xff, 0x51, 0x00, 0x29, 0x00, 0x00, 0x01])
+    );
+  });
+
   it('should throw for missing frame parameters', () => {
     const frames = new Frames(
       {
@@ -2,7 +2,16 @@ const {
   compareContexts,
   createContextFromColorRandomImage,
   createContextFromGrayscaleRandomImage,
+  createContextFromImageFunction,
 } = require('./utils/contextUtils');
+const {
+  Jpeg2000ProgressionOrder,
+  JpegTransformOperation,
+  PhotometricInterpretation,
+  PixelRepresentation,
+  PlanarConfiguration,
+} = require('./../src/Constants');
+const Context = require('./../src/Context');
 const NativeCodecs = require('./../src/NativeCodecs');
 
 const fs = require('fs');
@@ -98,12 +107,34 @@ describe('Uninitialized NativeCodecs', () => {
     expect(() => {
       NativeCodecs.decodeJpegXl(undefined, undefined);
     }).to.throw();
+    expect(() => {
+      NativeCodecs.decodeJpegXlIncremental(undefined, undefined, undefined);
+    }).to.throw();
     expect(() => {
       NativeCodecs.decodeJpeg2000(undefined, undefined);
     }).to.throw();
     expect(() => {
       NativeCodecs.decodeHtJpeg2000(undefined, undefined);
     }).to.throw();
+
+    expect(() => {
+      NativeCodecs.transcodeJpegToJpegXl(undefined, undefined);
+    }).to.throw();
+    expect(() => {
+      NativeCodecs.transcodeJpegXlToJpeg(undefined, undefined);
+    }).to.throw();
+    expect(() => {
+      NativeCodecs.transcodeFrame(undefined, undefined, undefined, undefined, undefined);
+    }).to.throw();
+    expect(() => {
+      NativeCodecs.transformJpeg(undefined, undefined);
+    }).to.throw();
+    expect(() => {
+      NativeCodecs.probeImage(undefined, undefined);
+    }).to.throw();
+    expect(() => {
+      NativeCodecs.getMemoryStatistics();
+    }).to.throw();
   });
 });
 
@@ -139,6 +170,104 @@ describe('NativeCodecs', () => {
     roundTripTest(NativeCodecs.encodeRle.name, NativeCodecs.decodeRle.name);
   }).timeout(timeout);
 
+  it('should correctly encode and decode flat and gradient RleLossless frames', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    [8, 16].forEach((bitsAllocated) => {
+      [
+        { samplesPerPixel: 1, planar: false },
+        { samplesPerPixel: 3, planar: false },
+        { samplesPerPixel: 3, planar: true },
+      ].forEach(({ samplesPerPixel, planar }) => {
+        [
+          (x, y, s) => (bitsAllocated === 8 ? 0x5a + s : 0x1234 + s),
+          (x, y, s) =>
+            bitsAllocated === 8 ? (x * 4 + y + s * 16) & 0xff : (x * 1024 + y * 8 + s) & 0xffff,
+        ].forEach((sampleFn) => {
+          const context = createContextFromImageFunction(
+            bitsAllocated,
+            samplesPerPixel,
+            planar,
+            64,
+            48,
+            sampleFn
+          );
+          const encodedContext = NativeCodecs.encodeRle(context);
+          const decodedContext = NativeCodecs.decodeRle(encodedContext);
+
+          compareContexts(context, decodedContext);
+          expect(decodedContext.getDecodedBuffer()).to.deep.equal(context.getDecodedBuffer());
+        });
+      });
+    });
+  }).timeout(timeout);
+
+  it('should correctly encode RleLossless replicate and literal runs', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    // Encoded lengths include the 64 bytes header and the even segment padding
+    [
+      { name: 'runs of 2', width: 256, sampleFn: (x) => (x >> 1) & 0xff, length: 64 + 128 * 2 },
+      { name: 'runs of 3', width: 255, sampleFn: (x) => Math.floor(x / 3), length: 64 + 85 * 2 },
+      { name: 'runs of 128', width: 256, sampleFn: (x) => (x < 128 ? 10 : 20), length: 64 + 2 * 2 },
+      { name: 'long run', width: 1000, sampleFn: () => 7, length: 64 + 8 * 2 },
+      {
+        name: 'literal row',
+        width: 256,
+        sampleFn: (x) => (x * 37 + 11) & 0xff,
+        length: 64 + 2 * (1 + 128),
+      },
+    ].forEach(({ name, width, sampleFn, length }) => {
+      const context = createContextFromImageFunction(8, 1, false, width, 1, sampleFn);
+      const encodedContext = NativeCodecs.encodeRle(context);
+      expect(encodedContext.getEncodedBuffer().length, name).to.equal(length);
+
+      const decodedContext = NativeCodecs.decodeRle(encodedContext);
+      expect(decodedContext.getDecodedBuffer(), name).to.deep.equal(context.getDecodedBuffer());
+    });
+
+    // Literal rows of 16-bit color samples, and rows mixing both kinds of runs
+    [
+      createContextFromImageFunction(
+        16,
+        3,
+        false,
+        300,
+        2,
+        (x, y, s) => (x * 263 + y * 31 + s * 101) & 0xffff
+      ),
+      createContextFromImageFunction(8, 1, false, 64, 64, (x, y) =>
+        x < 2 * (y % 8) ? 0 : (x * 37 + y) & 0xff
+      ),
+    ].forEach((context) => {
+      const encodedContext = NativeCodecs.encodeRle(context);
+      const decodedContext = NativeCodecs.decodeRle(encodedContext);
+
+      compareContexts(context, decodedContext);
+      expect(decodedContext.getDecodedBuffer()).to.deep.equal(context.getDecodedBuffer());
+    });
+  }).timeout(timeout);
+
+  it('should throw for RleLossless segment offsets beyond the encoded buffer', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    // One segment, starting at offset 4096 of a 128 bytes frame
+    const encodedBuffer = new Uint8Array(128);
+    encodedBuffer[0] = 1;
+    encodedBuffer[5] = 0x10;
+    const context = new Context({
+      width: 8,
+      height: 8,
+      bitsAllocated: 8,
+      bitsStored: 8,
+      samplesPerPixel: 1,
+      pixelRepresentation: PixelRepresentation.Unsigned,
+      photometricInterpretation: PhotometricInterpretation.Monochrome2,
+      encodedBuffer,
+    });
+
+    expect(() => {
+      NativeCodecs.decodeRle(context);
+    }).to.throw();
+  }).timeout(timeout);
+
   it('should correctly encode and decode basic JpegLossless', () => {
     expect(NativeCodecs.isInitialized()).to.be.true;
     roundTripTest(NativeCodecs.encodeJpeg.name, NativeCodecs.decodeJpeg.name);
@@ -154,13 +283,651 @@ describe('NativeCodecs', () => {
     roundTripTest(NativeCodecs.encodeJpeg2000.name, NativeCodecs.decodeJpeg2000.name);
   }).timeout(timeout);
 
+  it('should correctly decode Jpeg2000Lossless frames split into fragments within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const session = NativeCodecs.createSession();
+    for (let i = 0; i < 2; i++) {
+      const context = createContextFromGrayscaleRandomImage(16, 12, false, 64, 48);
+      const encodedBuffer = NativeCodecs.encodeJpeg2000(context).getEncodedBuffer();
+
+      // The SOC and SIZ markers straddle the first fragments, one of them being empty
+      const offsets = [0, 1, 3, 5, 5, encodedBuffer.length >> 1, encodedBuffer.length];
+      const fragments = [];
+      for (let f = 1; f < offsets.length; f++) {
+        fragments.push(encodedBuffer.slice(offsets[f - 1], offsets[f]));
+      }
+      const fragmentedContext = new Context({
+        width: 64,
+        height: 48,
+        bitsAllocated: 16,
+        bitsStored: 12,
+        samplesPerPixel: 1,
+        pixelRepresentation: PixelRepresentation.Unsigned,
+        photometricInterpretation: PhotometricInterpretation.Monochrome2,
+        encodedBuffer: fragments[0],
+        encodedFragments: fragments.slice(1),
+      });
+      const decodedContext = NativeCodecs.decodeJpeg2000(fragmentedContext, undefined, session);
+
+      compareContexts(context, decodedContext);
+      expect(decodedContext.getDecodedBuffer()).to.deep.equal(context.getDecodedBuffer());
+    }
+    NativeCodecs.releaseSession(session);
+  }).timeout(timeout);
+
+  it('should join the Jpeg2000Lossless fragments for a module that does not read them in place', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(16, 12, false, 64, 48);
+    const encodedBuffer = NativeCodecs.encodeJpeg2000(context).getEncodedBuffer();
+    const addFragmentStub = sinon
+      .stub(NativeCodecs.wasmApi, 'wasmAddEncodedFragment')
+      .value(undefined);
+
+    const fragmentedContext = new Context({
+      width: 64,
+      height: 48,
+      bitsAllocated: 16,
+      bitsStored: 12,
+      samplesPerPixel: 1,
+      pixelRepresentation: PixelRepresentation.Unsigned,
+      photometricInterpretation: PhotometricInterpretation.Monochrome2,
+      encodedBuffer: encodedBuffer.slice(0, 3),
+      encodedFragments: [encodedBuffer.slice(3, 100), encodedBuffer.slice(100)],
+    });
+    const decodedContext = NativeCodecs.decodeJpeg2000(fragmentedContext);
+    addFragmentStub.restore();
+
+    expect(decodedContext.getDecodedBuffer()).to.deep.equal(context.getDecodedBuffer());
+  }).timeout(timeout);
+
+  it('should correctly encode and decode planar, interleaved and signed 16-bit Jpeg2000Lossless frames', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    [
+      { samplesPerPixel: 1, planar: false },
+      { samplesPerPixel: 3, planar: false },
+      { samplesPerPixel: 3, planar: true },
+    ].forEach(({ samplesPerPixel, planar }) => {
+      [12, 16].forEach((bitsStored) => {
+        [false, true].forEach((signed) => {
+          // Samples spanning the whole range, sign-extended to 16 bits
+          const range = 1 << bitsStored;
+          const sampleFn = (x, y, s) => {
+            const sample = (x * 7919 + y * 131 + s * 4099) & (range - 1);
+            return signed && sample >= range / 2 ? sample - range : sample;
+          };
+          const context = createContextFromImageFunction(
+            16,
+            samplesPerPixel,
+            planar,
+            64,
+            48,
+            sampleFn
+          );
+          context.setBitsStored(bitsStored);
+          context.setPixelRepresentation(
+            signed ? PixelRepresentation.Signed : PixelRepresentation.Unsigned
+          );
+          const encodedContext = NativeCodecs.encodeJpeg2000(context);
+          const decodedContext = NativeCodecs.decodeJpeg2000(encodedContext);
+
+          compareContexts(context, decodedContext);
+          expect(decodedContext.getDecodedBuffer()).to.deep.equal(context.getDecodedBuffer());
+        });
+      });
+    });
+  }).timeout(timeout);
+
+  it('should correctly decode Jpeg2000Lossless frames of changing sizes within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    // The decoded buffer of the session shrinks and grows back
+    const contexts = [
+      createContextFromGrayscaleRandomImage(16, 12, false, 64, 48),
+      createContextFromGrayscaleRandomImage(16, 12, false, 64, 48),
+      createContextFromGrayscaleRandomImage(16, 12, false, 80, 40),
+      createContextFromGrayscaleRandomImage(8, 8, false, 80, 40),
+      createContextFromGrayscaleRandomImage(16, 12, false, 64, 48),
+    ];
+    const encodedContexts = contexts.map((context) => NativeCodecs.encodeJpeg2000(context));
+
+    const session = NativeCodecs.createSession();
+    encodedContexts.forEach((encodedContext, i) => {
+      const decodedContext = NativeCodecs.decodeJpeg2000(encodedContext, undefined, session);
+
+      compareContexts(contexts[i], decodedContext);
+      expect(decodedContext.getDecodedBuffer()).to.deep.equal(contexts[i].getDecodedBuffer());
+    });
+    NativeCodecs.releaseSession(session);
+  }).timeout(timeout);
+
+  it('should correctly encode and decode tiled Jpeg2000Lossless with a thread count', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    [
+      { tileWidth: 0, tileHeight: 0, threadCount: 1 },
+      { tileWidth: 128, tileHeight: 64, threadCount: 0 },
+      { tileWidth: 100, tileHeight: 0, threadCount: 4 },
+    ].forEach((parameters) => {
+      const context = createContextFromGrayscaleRandomImage(16, 12, false, 300, 280);
+      const encodedContext = NativeCodecs.encodeJpeg2000(context, parameters);
+      const decodedContext = NativeCodecs.decodeJpeg2000(encodedContext);
+
+      compareContexts(context, decodedContext);
+    });
+  }).timeout(timeout);
+
+  it('should correctly encode and decode Jpeg2000Lossless with code-block and layer options', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    roundTripTest(NativeCodecs.encodeJpeg2000.name, NativeCodecs.decodeJpeg2000.name, {
+      rateAllocation: false,
+      codeBlockStyle: 1 | 8,
+      codeBlockWidth: 32,
+      codeBlockHeight: 128,
+    });
+    roundTripTest(NativeCodecs.encodeJpeg2000.name, NativeCodecs.decodeJpeg2000.name, {
+      numberOfLayers: 3,
+    });
+  }).timeout(timeout);
+
   it('should correctly encode and decode basic JpegXlLossless', () => {
     expect(NativeCodecs.isInitialized()).to.be.true;
     roundTripTest(NativeCodecs.encodeJpegXl.name, NativeCodecs.decodeJpegXl.name);
   }).timeout(timeout);
 
+  it('should correctly encode and decode JpegXlLossless with encoder tuning options', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    roundTripTest(NativeCodecs.encodeJpegXl.name, NativeCodecs.decodeJpegXl.name, {
+      effort: 1,
+      decodingSpeed: 2,
+    });
+    roundTripTest(NativeCodecs.encodeJpegXl.name, NativeCodecs.decodeJpegXl.name, {
+      effort: 3,
+      modular: 1,
+      modularPredictor: 5,
+      modularGroupSize: 0,
+      brotliEffort: 4,
+    });
+  }).timeout(timeout);
+
+  it('should keep the native defaults of the encoder parameters a module does not export', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(8, 8, false, 64, 48);
+    const setEffortStub = sinon.stub(NativeCodecs.wasmApi, 'wasmSetEffort').value(undefined);
+
+    const encodedContext = NativeCodecs.encodeJpegXl(context, { effort: 7 });
+    const decodedContext = NativeCodecs.decodeJpegXl(encodedContext);
+    compareContexts(context, decodedContext);
+    expect(() => NativeCodecs.encodeJpegXl(context, { effort: 3 })).to.throw(/SetEffort/);
+    setEffortStub.restore();
+  }).timeout(timeout);
+
+  it('should correctly encode and decode JpegXlLossless frames with a thread count within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const encoderSession = NativeCodecs.createSession();
+    const decoderSession = NativeCodecs.createSession();
+    [0, 1, 4].forEach((threadCount) => {
+      const context = createContextFromGrayscaleRandomImage(16, 12, false, 300, 280);
+      const encodedContext = NativeCodecs.encodeJpegXl(context, { threadCount, effort: 3 }, encoderSession);
+      const decodedContext = NativeCodecs.decodeJpegXl(encodedContext, { threadCount }, decoderSession);
+
+      compareContexts(context, decodedContext);
+    });
+    NativeCodecs.releaseSession(encoderSession);
+    NativeCodecs.releaseSession(decoderSession);
+  }).timeout(timeout);
+
+  it('should correctly encode and decode alternating grayscale and color JpegXlLossless frames within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const encoderSession = NativeCodecs.createSession();
+    const decoderSession = NativeCodecs.createSession();
+    [1, 3, 1, 3].forEach((samplesPerPixel) => {
+      const context =
+        samplesPerPixel === 1
+          ? createContextFromGrayscaleRandomImage(8, 8, false, 64, 48)
+          : createContextFromColorRandomImage(false, 64, 48);
+      const encodedContext = NativeCodecs.encodeJpegXl(context, undefined, encoderSession);
+      const decodedContext = NativeCodecs.decodeJpegXl(encodedContext, undefined, decoderSession);
+
+      compareContexts(context, decodedContext);
+    });
+    NativeCodecs.releaseSession(encoderSession);
+    NativeCodecs.releaseSession(decoderSession);
+  }).timeout(timeout);
+
+  it('should correctly recompress JpegBaseline frames to JpegXl and reconstruct them bit-exactly', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    [
+      createContextFromGrayscaleRandomImage(8, 8, false, 64, 48),
+      createContextFromColorRandomImage(false, 64, 48),
+    ].forEach((context) => {
+      const jpegContext = NativeCodecs.encodeJpeg(context, { lossy: true, quality: 90 });
+      const jpegXlContext = NativeCodecs.transcodeJpegToJpegXl(jpegContext);
+      expect(jpegXlContext.getEncodedBuffer().length).to.be.greaterThan(0);
+
+      const reconstructedContext = NativeCodecs.transcodeJpegXlToJpeg(jpegXlContext);
+      expect(Array.from(reconstructedContext.getEncodedBuffer())).to.deep.equal(
+        Array.from(jpegContext.getEncodedBuffer())
+      );
+    });
+  }).timeout(timeout);
+
+  it('should throw for JpegBaseline recompression with a module that does not export it', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(8, 8, false, 64, 48);
+    const jpegContext = NativeCodecs.encodeJpeg(context, { lossy: true, quality: 90 });
+    const transcodeStub = sinon
+      .stub(NativeCodecs.wasmApi, 'wasmTranscodeJpegToJpegXl')
+      .value(undefined);
+
+    expect(() => NativeCodecs.transcodeJpegToJpegXl(jpegContext)).to.throw(
+      /TranscodeJpegToJpegXl/
+    );
+    transcodeStub.restore();
+  }).timeout(timeout);
+
+  it('should correctly decode JpegXlLossless frames to linear float', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(16, 12, false, 32, 24);
+    const encodedContext = NativeCodecs.encodeJpegXl(context, { effort: 3 });
+    const decodedContext = NativeCodecs.decodeJpegXl(encodedContext, { outputColorSpace: 1 });
+
+    // Grayscale frames are stored with a linear transfer function
+    const pixels = new Uint16Array(context.getDecodedBuffer().slice().buffer);
+    const samples = new Float32Array(decodedContext.getDecodedBuffer().slice().buffer);
+    expect(samples.length).to.be.eq(pixels.length);
+    samples.forEach((sample, i) => {
+      expect(sample).to.be.closeTo(pixels[i] / 65535, 1e-6);
+    });
+
+    // Lossless frames are not stored in XYB
+    expect(() => {
+      NativeCodecs.decodeJpegXl(encodedContext, { outputColorSpace: 2 });
+    }).to.throw();
+  }).timeout(timeout);
+
+  it('should correctly decode progressive JpegXlLossless frames incrementally within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const decoderSession = NativeCodecs.createSession();
+    for (let i = 0; i < 2; i++) {
+      const context = createContextFromGrayscaleRandomImage(16, 12, false, 256, 256);
+      const encodedContext = NativeCodecs.encodeJpegXl(context, { progressive: true, effort: 3 });
+      const encodedBuffer = encodedContext.getEncodedBuffer();
+
+      let result;
+      const chunkSize = 1024;
+      for (let offset = 0; offset < encodedBuffer.length; offset += chunkSize) {
+        encodedContext.setEncodedBuffer(encodedBuffer.slice(offset, offset + chunkSize));
+        result = NativeCodecs.decodeJpegXlIncremental(encodedContext, undefined, decoderSession);
+        if (result.complete) {
+          break;
+        }
+        expect(result.downsamplingRatio).to.be.oneOf([0, 1, 2, 4, 8]);
+      }
+
+      expect(result.complete).to.be.true;
+      expect(result.downsamplingRatio).to.be.eq(1);
+      compareContexts(context, result.context);
+    }
+    NativeCodecs.releaseSession(decoderSession);
+  }).timeout(timeout);
+
+  it('should throw for incremental JpegXl decoding without a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(8, 8, false, 16, 16);
+    const encodedContext = NativeCodecs.encodeJpegXl(context);
+    expect(() => {
+      NativeCodecs.decodeJpegXlIncremental(encodedContext);
+    }).to.throw();
+  });
+
   it('should correctly encode and decode basic HtJpeg2000Lossless', () => {
     expect(NativeCodecs.isInitialized()).to.be.true;
     roundTripTest(NativeCodecs.encodeHtJpeg2000.name, NativeCodecs.decodeHtJpeg2000.name);
   }).timeout(timeout);
+
+  it('should correctly encode and decode tiled HtJpeg2000Lossless with a thread count', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    [
+      { tileWidth: 0, tileHeight: 0, threadCount: 1 },
+      { tileWidth: 128, tileHeight: 64, threadCount: 0 },
+      { tileWidth: 100, tileHeight: 0, threadCount: 4 },
+    ].forEach((parameters) => {
+      const context = createContextFromGrayscaleRandomImage(16, 12, false, 300, 280);
+      const encodedContext = NativeCodecs.encodeHtJpeg2000(context, parameters);
+      const decodedContext = NativeCodecs.decodeHtJpeg2000(encodedContext, {
+        threadCount: parameters.threadCount,
+      });
+
+      compareContexts(context, decodedContext);
+    });
+  }).timeout(timeout);
+
+  it('should correctly decode HtJpeg2000Lossless in strict and resilient modes', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(16, 12, false, 200, 150);
+    const encodedContext = NativeCodecs.encodeHtJpeg2000(context);
+    [false, true].forEach((resilient) => {
+      const decodedContext = NativeCodecs.decodeHtJpeg2000(encodedContext, { resilient });
+
+      compareContexts(context, decodedContext);
+    });
+  }).timeout(timeout);
+
+  it('should keep the native defaults of the decoder parameters a module does not export', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(16, 12, false, 64, 48);
+    const encodedContext = NativeCodecs.encodeHtJpeg2000(context);
+    const setResilientStub = sinon.stub(NativeCodecs.wasmApi, 'wasmSetResilient').value(undefined);
+
+    const decodedContext = NativeCodecs.decodeHtJpeg2000(encodedContext, { resilient: false });
+    compareContexts(context, decodedContext);
+    expect(() => NativeCodecs.decodeHtJpeg2000(encodedContext, { resilient: true })).to.throw(
+      /SetResilient/
+    );
+    setResilientStub.restore();
+  }).timeout(timeout);
+
+  it('should correctly transcode Jpeg2000Lossless frames to HtJpeg2000Lossless within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    expect(NativeCodecs.canTranscodeFrame('decodeJpeg2000', 'encodeHtJpeg2000')).to.be.true;
+    expect(NativeCodecs.canTranscodeFrame('decodeJpeg', 'transformJpeg')).to.be.false;
+    const session = NativeCodecs.createSession();
+    [1, 3, 3].forEach((samplesPerPixel) => {
+      const context =
+        samplesPerPixel === 1
+          ? createContextFromGrayscaleRandomImage(16, 12, false, 120, 90)
+          : createContextFromColorRandomImage(false, 120, 90);
+      const encodedContext = NativeCodecs.encodeJpeg2000(context);
+      const transcodedContext = NativeCodecs.transcodeFrame(
+        encodedContext,
+        NativeCodecs.decodeJpeg2000.name,
+        undefined,
+        NativeCodecs.encodeHtJpeg2000.name,
+        undefined,
+        context.getPhotometricInterpretation(),
+        session
+      );
+      const decodedContext = NativeCodecs.decodeHtJpeg2000(transcodedContext);
+
+      compareContexts(context, decodedContext);
+    });
+    NativeCodecs.releaseSession(session);
+  }).timeout(timeout);
+
+  it('should correctly encode HtJpeg2000Lossy with a quantization step and targets', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(8, 8, false, 256, 256);
+    const getSize = (parameters) => {
+      const encodedContext = NativeCodecs.encodeHtJpeg2000(context, { lossy: true, ...parameters });
+      return encodedContext.getEncodedBuffer().length;
+    };
+
+    const defaultSize = getSize({});
+    expect(getSize({ quantizationStep: 16 })).to.be.lt(defaultSize);
+    expect(getSize({ targetPsnr: 30 })).to.be.lt(getSize({ targetPsnr: 40 }));
+
+    const targetBytes = Math.round(defaultSize / 4);
+    const targetSize = getSize({ targetBytes });
+    expect(targetSize).to.be.within(targetBytes * 0.75, targetBytes * 1.25);
+  }).timeout(timeout);
+
+  it('should correctly encode, index and decode streaming HtJpeg2000Lossless', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    [
+      { streaming: true },
+      { streaming: true, tileWidth: 128, tileHeight: 128 },
+      { progressionOrder: Jpeg2000ProgressionOrder.Lrcp, precinctWidth: 32, precinctHeight: 64 },
+      { progressionOrder: Jpeg2000ProgressionOrder.Pcrl, packetLengthMarkers: true },
+    ].forEach((parameters) => {
+      const context = createContextFromGrayscaleRandomImage(16, 12, false, 300, 280);
+      const encodedContext = NativeCodecs.encodeHtJpeg2000(context, parameters);
+      const decodedContext = NativeCodecs.decodeHtJpeg2000(encodedContext);
+
+      compareContexts(context, decodedContext);
+
+      // Packets follow each other, from the tile-part header to its end
+      const index = NativeCodecs.indexHtJpeg2000(encodedContext);
+      const ends = index.tileParts.map((tilePart) => tilePart.offset + tilePart.headerSize);
+      index.packets.forEach((packet) => {
+        expect(packet.offset).to.be.eq(ends[packet.tilePart]);
+        ends[packet.tilePart] += packet.size;
+      });
+      index.tileParts.forEach((tilePart, i) => {
+        expect(ends[i]).to.be.eq(tilePart.offset + tilePart.size);
+      });
+      expect(index.tileParts[0].offset).to.be.eq(index.mainHeaderSize);
+    });
+  }).timeout(timeout);
+
+  it('should correctly encode and decode JpegLossless frames within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const encoderSession = NativeCodecs.createSession();
+    const decoderSession = NativeCodecs.createSession();
+    for (let i = 0; i < 3; i++) {
+      const context = createContextFromGrayscaleRandomImage(16, 12, false, 64, 64);
+      const encodedContext = NativeCodecs.encodeJpeg(context, undefined, encoderSession);
+      const decodedContext = NativeCodecs.decodeJpeg(encodedContext, undefined, decoderSession);
+
+      compareContexts(context, decodedContext);
+    }
+    NativeCodecs.releaseSession(encoderSession);
+    NativeCodecs.releaseSession(decoderSession);
+  }).timeout(timeout);
+
+  it('should correctly encode and decode planar and interleaved JpegLS frames within a session', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const encoderSession = NativeCodecs.createSession();
+    const decoderSession = NativeCodecs.createSession();
+    [true, false, true].forEach((planar, i) => {
+      const context = createContextFromColorRandomImage(planar, 64 + i * 16, 48);
+      const encodedContext = NativeCodecs.encodeJpegLs(context, undefined, encoderSession);
+      const decodedContext = NativeCodecs.decodeJpegLs(encodedContext, undefined, decoderSession);
+
+      compareContexts(context, decodedContext);
+    });
+    NativeCodecs.releaseSession(encoderSession);
+    NativeCodecs.releaseSession(decoderSession);
+  }).timeout(timeout);
+
+  it('should correctly encode planar and interleaved 16-bit color JpegXl and HtJpeg2000 frames', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const width = 40;
+    const height = 24;
+    const numPixels = width * height;
+    const interleaved = new Uint16Array(numPixels * 3).map(() => Math.floor(Math.random() * 4096));
+    const planar = new Uint16Array(numPixels * 3);
+    for (let p = 0; p < numPixels; p++) {
+      for (let c = 0; c < 3; c++) {
+        planar[c * numPixels + p] = interleaved[p * 3 + c];
+      }
+    }
+
+    [
+      [NativeCodecs.encodeJpegXl.name, NativeCodecs.decodeJpegXl.name],
+      [NativeCodecs.encodeHtJpeg2000.name, NativeCodecs.decodeHtJpeg2000.name],
+    ].forEach(([encoderFnName, decoderFnName]) => {
+      [PlanarConfiguration.Interleaved, PlanarConfiguration.Planar].forEach(
+        (planarConfiguration) => {
+          const pixels = planarConfiguration === PlanarConfiguration.Planar ? planar : interleaved;
+          const context = new Context({
+            width,
+            height,
+            bitsAllocated: 16,
+            bitsStored: 12,
+            samplesPerPixel: 3,
+            pixelRepresentation: PixelRepresentation.Unsigned,
+            photometricInterpretation: PhotometricInterpretation.Rgb,
+            planarConfiguration,
+            decodedBuffer: new Uint8Array(pixels.buffer),
+          });
+          const encodedContext = NativeCodecs[encoderFnName](context);
+          const decodedContext = NativeCodecs[decoderFnName](encodedContext);
+
+          // Frames are always decoded as interleaved
+          const decodedPixels = new Uint16Array(decodedContext.getDecodedBuffer().slice().buffer);
+          expect(decodedPixels).to.deep.equal(interleaved);
+        }
+      );
+    });
+  }).timeout(timeout);
+
+  it('should correctly transform JpegBaseline frames in the DCT domain', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(8, 8, false, 64, 48);
+    const encodedContext = NativeCodecs.encodeJpeg(context, {
+      lossy: true,
+      predictor: 0,
+      pointTransform: 0,
+    });
+
+    const croppedContext = NativeCodecs.transformJpeg(encodedContext, {
+      operations: [{ operation: JpegTransformOperation.Crop, x: 12, y: 8, width: 20, height: 16 }],
+    });
+    expect(croppedContext.getWidth()).to.equal(24);
+    expect(croppedContext.getHeight()).to.equal(16);
+    const decodedCroppedContext = NativeCodecs.decodeJpeg(croppedContext);
+    expect(decodedCroppedContext.getWidth()).to.equal(24);
+    expect(decodedCroppedContext.getHeight()).to.equal(16);
+
+    const rotatedContext = NativeCodecs.transformJpeg(encodedContext, {
+      operations: [
+        { operation: JpegTransformOperation.Blank, x: 0, y: 0, width: 16, height: 16 },
+        { operation: JpegTransformOperation.Rotate90 },
+      ],
+    });
+    expect(rotatedContext.getWidth()).to.equal(48);
+    expect(rotatedContext.getHeight()).to.equal(64);
+    const decodedRotatedContext = NativeCodecs.decodeJpeg(rotatedContext);
+    expect(decodedRotatedContext.getWidth()).to.equal(48);
+    expect(decodedRotatedContext.getHeight()).to.equal(64);
+  }).timeout(timeout);
+
+  it('should report the codec scratch memory of the last call', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(16, 12, false, 256, 256);
+
+    const encodedContext = NativeCodecs.encodeJpeg2000(context);
+    const encoderStatistics = NativeCodecs.getMemoryStatistics();
+    expect(encoderStatistics.highWaterMark).to.be.above(0);
+    expect(encoderStatistics.allocations).to.be.above(0);
+    expect(encoderStatistics.capacity).to.be.above(0);
+
+    const decodedContext = NativeCodecs.decodeJpeg2000(encodedContext);
+    compareContexts(context, decodedContext);
+    const decoderStatistics = NativeCodecs.getMemoryStatistics();
+    expect(decoderStatistics.highWaterMark).to.be.above(0);
+    expect(decoderStatistics.capacity).to.be.at.least(encoderStatistics.capacity);
+  }).timeout(timeout);
+
+  it('should reclaim the codec scratch memory of a failed call', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(16, 12, false, 256, 256);
+    const encodedContext = NativeCodecs.encodeJpeg2000(context);
+
+    NativeCodecs.decodeJpeg2000(encodedContext);
+    const statistics = NativeCodecs.getMemoryStatistics();
+
+    // Truncated codestream, failing in the middle of the tile data
+    const encodedBuffer = encodedContext.getEncodedBuffer();
+    const truncatedContext = new Context({
+      width: 256,
+      height: 256,
+      bitsAllocated: 16,
+      bitsStored: 12,
+      samplesPerPixel: 1,
+      pixelRepresentation: PixelRepresentation.Unsigned,
+      photometricInterpretation: PhotometricInterpretation.Monochrome2,
+      encodedBuffer: encodedBuffer.slice(0, encodedBuffer.length / 2),
+    });
+    expect(() => {
+      NativeCodecs.decodeJpeg2000(truncatedContext);
+    }).to.throw();
+
+    const decodedContext = NativeCodecs.decodeJpeg2000(encodedContext);
+    compareContexts(context, decodedContext);
+    expect(NativeCodecs.getMemoryStatistics().highWaterMark).to.equal(statistics.highWaterMark);
+  }).timeout(timeout);
+
+  it('should correctly probe encoded frames without decoding', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const context = createContextFromGrayscaleRandomImage(8, 8, false, 64, 48);
+
+    const jpegInfo = NativeCodecs.probeImage(
+      NativeCodecs.encodeJpeg(context, { lossy: true, predictor: 0, pointTransform: 0 })
+    );
+    expect(jpegInfo.width).to.equal(64);
+    expect(jpegInfo.height).to.equal(48);
+    expect(jpegInfo.bitsStored).to.equal(8);
+    expect(jpegInfo.samplesPerPixel).to.equal(1);
+    expect(jpegInfo.colorTransform).to.be.false;
+
+    const jpeg2000Info = NativeCodecs.probeImage(NativeCodecs.encodeJpeg2000(context));
+    expect(jpeg2000Info.width).to.equal(64);
+    expect(jpeg2000Info.height).to.equal(48);
+    expect(jpeg2000Info.bitsStored).to.equal(8);
+    expect(jpeg2000Info.samplesPerPixel).to.equal(1);
+    expect(jpeg2000Info.decompositionLevels).to.be.above(0);
+  }).timeout(timeout);
+
+  it('should correctly probe RLE, JPEG-LS, HT-JPEG 2000 and JPEG-XL frames without decoding them', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const grayscaleContext = createContextFromGrayscaleRandomImage(16, 12, false, 64, 48);
+    const colorContext = createContextFromColorRandomImage(false, 128, 96);
+
+    const rleInfo = NativeCodecs.probeImage(NativeCodecs.encodeRle(grayscaleContext));
+    expect(rleInfo.width).to.equal(64);
+    expect(rleInfo.height).to.equal(48);
+    expect(rleInfo.bitsAllocated).to.equal(16);
+    expect(rleInfo.bitsStored).to.equal(12);
+    expect(rleInfo.samplesPerPixel).to.equal(1);
+    const rleColorInfo = NativeCodecs.probeImage(NativeCodecs.encodeRle(colorContext));
+    expect(rleColorInfo.bitsAllocated).to.equal(8);
+    expect(rleColorInfo.samplesPerPixel).to.equal(3);
+    // The segments of a 16-bit grayscale frame cannot describe 8-bit samples
+    const rleMismatchContext = NativeCodecs.encodeRle(grayscaleContext);
+    rleMismatchContext.setBitsAllocated(8);
+    expect(() => {
+      NativeCodecs.probeImage(rleMismatchContext);
+    }).to.throw(/ProbeRle/);
+
+    const jpegLsInfo = NativeCodecs.probeImage(NativeCodecs.encodeJpegLs(grayscaleContext));
+    expect(jpegLsInfo.width).to.equal(64);
+    expect(jpegLsInfo.height).to.equal(48);
+    // The JPEG-LS encoder writes the samples with their bits allocated
+    expect(jpegLsInfo.bitsAllocated).to.equal(16);
+    expect(jpegLsInfo.bitsStored).to.equal(16);
+    expect(jpegLsInfo.samplesPerPixel).to.equal(1);
+    const jpegLsColorInfo = NativeCodecs.probeImage(NativeCodecs.encodeJpegLs(colorContext));
+    expect(jpegLsColorInfo.samplesPerPixel).to.equal(3);
+    expect(jpegLsColorInfo.colorTransform).to.be.false;
+
+    const htJpeg2000Info = NativeCodecs.probeImage(
+      NativeCodecs.encodeHtJpeg2000(colorContext, { tileWidth: 64, tileHeight: 32 })
+    );
+    expect(htJpeg2000Info.width).to.equal(128);
+    expect(htJpeg2000Info.height).to.equal(96);
+    expect(htJpeg2000Info.bitsStored).to.equal(8);
+    expect(htJpeg2000Info.samplesPerPixel).to.equal(3);
+    expect(htJpeg2000Info.pixelRepresentation).to.equal(PixelRepresentation.Unsigned);
+    expect(htJpeg2000Info.colorTransform).to.be.true;
+    expect(htJpeg2000Info.tileWidth).to.equal(64);
+    expect(htJpeg2000Info.tileHeight).to.equal(32);
+    expect(htJpeg2000Info.decompositionLevels).to.be.above(0);
+    const htJpeg2000GrayscaleInfo = NativeCodecs.probeImage(
+      NativeCodecs.encodeHtJpeg2000(createContextFromGrayscaleRandomImage(8, 8, false, 64, 48))
+    );
+    expect(htJpeg2000GrayscaleInfo.samplesPerPixel).to.equal(1);
+    expect(htJpeg2000GrayscaleInfo.colorTransform).to.be.false;
+    expect(htJpeg2000GrayscaleInfo.tileWidth).to.equal(64);
+    expect(htJpeg2000GrayscaleInfo.tileHeight).to.equal(48);
+
+    const jpegXlInfo = NativeCodecs.probeImage(NativeCodecs.encodeJpegXl(colorContext));
+    expect(jpegXlInfo.width).to.equal(128);
+    expect(jpegXlInfo.height).to.equal(96);
+    expect(jpegXlInfo.bitsStored).to.equal(8);
+    expect(jpegXlInfo.samplesPerPixel).to.equal(3);
+    expect(jpegXlInfo.colorTransform).to.be.false;
+    const jpegXlLossyInfo = NativeCodecs.probeImage(
+      NativeCodecs.encodeJpegXl(colorContext, { lossy: true })
+    );
+    expect(jpegXlLossyInfo.colorTransform).to.be.false;
+  }).timeout(timeout);
 });
@@ -7,8 +7,10 @@ const {
 const {
   PhotometricInterpretation,
   PixelRepresentation,
+  PlanarConfiguration,
   TransferSyntax,
 } = require('./../src/Constants');
+const { Codec } = require('./../src/Codecs');
 const NativeCodecs = require('./../src/NativeCodecs');
 const Transcoder = require('./../src/Transcoder');
 
@@ -181,6 +183,27 @@ function allLosslessSyntaxesTest() {
   });
 }
 
+function transcodeElements(elements, transferSyntaxUid, newTransferSyntaxUids) {
+  const transcoder = new Transcoder(
+    { ...elements, PixelData: [...elements.PixelData] },
+    transferSyntaxUid
+  );
+  newTransferSyntaxUids.forEach((syntax) => {
+    transcoder.transcode(syntax);
+  });
+
+  return transcoder.getElements();
+}
+
+function compareTranscodedElements(lElements, rElements) {
+  expect(lElements.PhotometricInterpretation).to.equal(rElements.PhotometricInterpretation);
+  expect(lElements.PlanarConfiguration).to.equal(rElements.PlanarConfiguration);
+  expect(lElements.LossyImageCompressionRatio).to.equal(rElements.LossyImageCompressionRatio);
+  expect(lElements.PixelData.map((frame) => Array.from(new Uint8Array(frame)))).to.deep.equal(
+    rElements.PixelData.map((frame) => Array.from(new Uint8Array(frame)))
+  );
+}
+
 describe('Transcoder', () => {
   before(async () => {
     sinon.stub(NativeCodecs, '_getWebAssemblyBytes').callsFake(async () => {
@@ -320,6 +343,255 @@ describe('Transcoder', () => {
     expect(transcodedElements3.LossyImageCompressionRatio).not.to.be.undefined;
   }).timeout(timeout);
 
+  it('should correctly recompress JpegBaselineProcess1 to JpegXlRecompression and back', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    expect(
+      Codec.getCodec(TransferSyntax.JpegXlRecompression).canTranscodeFrom(
+        TransferSyntax.JpegBaselineProcess1
+      )
+    ).to.be.true;
+    expect(
+      Codec.getCodec(TransferSyntax.JpegBaselineProcess1).canTranscodeFrom(
+        TransferSyntax.JpegXlRecompression
+      )
+    ).to.be.true;
+
+    const colorPart10 = createDicomPart10FromColorRandomImage(2, false, 64, 48);
+    const transcoder = new Transcoder(colorPart10);
+    transcoder.transcode(TransferSyntax.JpegBaselineProcess1);
+    const jpegFrames = transcoder
+      .getElements()
+      .PixelData.map((frame) => Array.from(new Uint8Array(frame)));
+
+    transcoder.transcode(TransferSyntax.JpegXlRecompression);
+    expect(transcoder.getTransferSyntaxUid()).to.equal(TransferSyntax.JpegXlRecompression);
+    expect(transcoder.getElements().PixelData.length).to.equal(jpegFrames.length);
+
+    transcoder.transcode(TransferSyntax.JpegBaselineProcess1);
+    expect(transcoder.getTransferSyntaxUid()).to.equal(TransferSyntax.JpegBaselineProcess1);
+    expect(
+      transcoder.getElements().PixelData.map((frame) => Array.from(new Uint8Array(frame)))
+    ).to.deep.equal(jpegFrames);
+  }).timeout(timeout);
+
+  it('should correctly decode a Jpeg2000Lossless frame split into several fragments', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const width = 64;
+    const height = 48;
+    const pixels = Uint16Array.from({ length: width * height }, (v, i) => (i * 37) & 0xfff);
+
+    const elements = {
+      _vrMap: {
+        PixelData: 'OW',
+      },
+      BitsAllocated: 16,
+      BitsStored: 12,
+      Columns: width,
+      HighBit: 11,
+      NumberOfFrames: 1,
+      PhotometricInterpretation: PhotometricInterpretation.Monochrome2,
+      PixelData: [pixels.buffer],
+      PixelRepresentation: PixelRepresentation.Unsigned,
+      Rows: height,
+      SamplesPerPixel: 1,
+    };
+
+    const transcoder1 = new Transcoder(elements, TransferSyntax.ExplicitVRLittleEndian);
+    transcoder1.transcode(TransferSyntax.Jpeg2000Lossless);
+    const encodedElements = transcoder1.getElements();
+    const encodedFrame = encodedElements.PixelData[0];
+
+    // The SOC and SIZ markers straddle the first fragments
+    const offsets = [0, 1, 3, encodedFrame.byteLength >> 1, encodedFrame.byteLength];
+    encodedElements.PixelData = [];
+    for (let f = 1; f < offsets.length; f++) {
+      encodedElements.PixelData.push(encodedFrame.slice(offsets[f - 1], offsets[f]));
+    }
+
+    const transcoder2 = new Transcoder(encodedElements, TransferSyntax.Jpeg2000Lossless);
+    transcoder2.transcode(TransferSyntax.ExplicitVRLittleEndian);
+    const decodedElements = transcoder2.getElements();
+
+    expect(new Uint8Array(decodedElements.PixelData[0])).to.deep.equal(
+      new Uint8Array(pixels.buffer)
+    );
+  }).timeout(timeout);
+
+  it('should correctly decode Jpeg2000Lossless frames into planar pixels', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const width = 64;
+    const height = 48;
+    const numPixels = width * height;
+
+    [8, 16].forEach((bitsAllocated) => {
+      const PixelArray = bitsAllocated === 8 ? Uint8Array : Uint16Array;
+      const pixels = PixelArray.from(
+        { length: numPixels * 3 },
+        (v, i) => (i * 37 + (i % 3) * 101) & ((1 << bitsAllocated) - 1)
+      );
+      const planarPixels = new PixelArray(numPixels * 3);
+      for (let n = 0; n < numPixels; n++) {
+        for (let s = 0; s < 3; s++) {
+          planarPixels[n + numPixels * s] = pixels[n * 3 + s];
+        }
+      }
+
+      const elements = {
+        _vrMap: {
+          PixelData: bitsAllocated === 8 ? 'OB' : 'OW',
+        },
+        BitsAllocated: bitsAllocated,
+        BitsStored: bitsAllocated,
+        Columns: width,
+        HighBit: bitsAllocated - 1,
+        NumberOfFrames: 1,
+        PhotometricInterpretation: PhotometricInterpretation.Rgb,
+        PixelData: [pixels.buffer],
+        PixelRepresentation: PixelRepresentation.Unsigned,
+        PlanarConfiguration: PlanarConfiguration.Interleaved,
+        Rows: height,
+        SamplesPerPixel: 3,
+      };
+
+      const transcoder1 = new Transcoder(elements, TransferSyntax.ExplicitVRLittleEndian);
+      transcoder1.transcode(TransferSyntax.Jpeg2000Lossless);
+      const encodedElements = transcoder1.getElements();
+
+      // The decoder writes the planar frame itself
+      encodedElements.PlanarConfiguration = PlanarConfiguration.Planar;
+      const transcoder2 = new Transcoder(encodedElements, TransferSyntax.Jpeg2000Lossless);
+      transcoder2.transcode(TransferSyntax.ExplicitVRLittleEndian);
+      const decodedElements = transcoder2.getElements();
+
+      expect(decodedElements.PlanarConfiguration).to.equal(PlanarConfiguration.Planar);
+      expect(new Uint8Array(decodedElements.PixelData[0])).to.deep.equal(
+        new Uint8Array(planarPixels.buffer)
+      );
+    });
+  }).timeout(timeout);
+
+  it('should reset the planar configuration of JpegLsLossless encoded planar frames', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const frames = 2;
+    const transcoder = new Transcoder(createDicomPart10FromColorRandomImage(frames, true, 64, 48));
+    const elements = transcoder.getElements();
+    expect(elements.PlanarConfiguration).to.equal(PlanarConfiguration.Planar);
+
+    const codec = Codec.getCodec(TransferSyntax.JpegLsLossless);
+    const encodedElements = codec.encode(
+      { ...elements, PixelData: elements.PixelData.slice() },
+      TransferSyntax.ExplicitVRLittleEndian
+    );
+    // The layout of non-interleaved scans is not described by the element
+    expect(encodedElements.PlanarConfiguration).to.equal(PlanarConfiguration.Interleaved);
+
+    // The decoder reports the planar frames of the non-interleaved scans
+    const decodedElements = codec.decode(encodedElements, TransferSyntax.JpegLsLossless);
+    expect(decodedElements.PlanarConfiguration).to.equal(PlanarConfiguration.Planar);
+    expect(new Uint8Array(decodedElements.PixelData[0])).to.deep.equal(
+      new Uint8Array(elements.PixelData[0])
+    );
+  }).timeout(timeout);
+
+  it('should natively transcode Jpeg2000 frames to HtJpeg2000 as decode then encode does', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const frames = 3;
+    const sources = [
+      createDicomPart10FromGrayscaleRandomImage(frames, 16, 12, false, 64, 48),
+      createDicomPart10FromColorRandomImage(frames, false, 64, 48),
+      createDicomPart10FromColorRandomImage(frames, true, 64, 48),
+    ].map((part10) => {
+      const transcoder = new Transcoder(part10);
+      transcoder.transcode(TransferSyntax.Jpeg2000Lossless);
+
+      return transcoder.getElements();
+    });
+    // Planar frames are written and encoded natively as well
+    sources[2].PlanarConfiguration = PlanarConfiguration.Planar;
+
+    const transcodeFrameSpy = sinon.spy(NativeCodecs, 'transcodeFrame');
+    sources.forEach((elements) => {
+      [TransferSyntax.HtJpeg2000Lossless, TransferSyntax.HtJpeg2000Lossy].forEach((syntax) => {
+        transcodeFrameSpy.resetHistory();
+        const streamedElements = transcodeElements(elements, TransferSyntax.Jpeg2000Lossless, [
+          syntax,
+        ]);
+        // The first frame is decoded up front, the others are transcoded natively
+        expect(transcodeFrameSpy.callCount).to.equal(frames - 1);
+
+        const referenceElements = transcodeElements(elements, TransferSyntax.Jpeg2000Lossless, [
+          TransferSyntax.ExplicitVRLittleEndian,
+          syntax,
+        ]);
+        compareTranscodedElements(streamedElements, referenceElements);
+        if (syntax === TransferSyntax.HtJpeg2000Lossy) {
+          expect(streamedElements.LossyImageCompressionRatio).not.to.be.undefined;
+        }
+      });
+    });
+    transcodeFrameSpy.restore();
+  }).timeout(timeout);
+
+  it('should transcode frames needing a pixel conversion through their decoded pixels', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const frames = 3;
+    const [ybrElements, planarElements] = [false, true].map((planar) => {
+      const transcoder = new Transcoder(
+        createDicomPart10FromColorRandomImage(frames, planar, 64, 48)
+      );
+      transcoder.transcode(TransferSyntax.RleLossless);
+
+      return transcoder.getElements();
+    });
+    // The JPEG 2000 encoder converts YBR_FULL frames to RGB and the JPEG
+    // encoder interleaves planar frames
+    ybrElements.PhotometricInterpretation = PhotometricInterpretation.YbrFull;
+    expect(planarElements.PlanarConfiguration).to.equal(PlanarConfiguration.Planar);
+
+    const transcodeFrameSpy = sinon.spy(NativeCodecs, 'transcodeFrame');
+    [
+      { elements: ybrElements, syntax: TransferSyntax.Jpeg2000Lossless },
+      { elements: planarElements, syntax: TransferSyntax.JpegBaselineProcess1 },
+    ].forEach(({ elements, syntax }) => {
+      const streamedElements = transcodeElements(elements, TransferSyntax.RleLossless, [syntax]);
+      expect(transcodeFrameSpy.called).to.be.false;
+
+      const referenceElements = transcodeElements(elements, TransferSyntax.RleLossless, [
+        TransferSyntax.ExplicitVRLittleEndian,
+        syntax,
+      ]);
+      compareTranscodedElements(streamedElements, referenceElements);
+    });
+    transcodeFrameSpy.restore();
+  }).timeout(timeout);
+
+  it('should transcode frames through their decoded pixels with a module that cannot fuse', () => {
+    expect(NativeCodecs.isInitialized()).to.be.true;
+    const transcoder = new Transcoder(
+      createDicomPart10FromGrayscaleRandomImage(3, 16, 12, false, 64, 48)
+    );
+    transcoder.transcode(TransferSyntax.Jpeg2000Lossless);
+    const elements = transcoder.getElements();
+
+    const transcodeFrameStub = sinon
+      .stub(NativeCodecs.wasmApi, 'wasmTranscodeFrame')
+      .value(undefined);
+    const transcodeFrameSpy = sinon.spy(NativeCodecs, 'transcodeFrame');
+    expect(NativeCodecs.canTranscodeFrame('decodeJpeg2000', 'encodeHtJpeg2000')).to.be.false;
+    const streamedElements = transcodeElements(elements, TransferSyntax.Jpeg2000Lossless, [
+      TransferSyntax.HtJpeg2000Lossless,
+    ]);
+    expect(transcodeFrameSpy.called).to.be.false;
+    transcodeFrameSpy.restore();
+    transcodeFrameStub.restore();
+
+    const referenceElements = transcodeElements(elements, TransferSyntax.Jpeg2000Lossless, [
+      TransferSyntax.ExplicitVRLittleEndian,
+      TransferSyntax.HtJpeg2000Lossless,
+    ]);
+    compareTranscodedElements(streamedElements, referenceElements);
+  }).timeout(timeout);
+
   it('should correctly encode and decode basic ImplicitVRLittleEndian [DICOM part10]', () => {
     expect(NativeCodecs.isInitialized()).to.be.true;
     roundTripTest(TransferSyntax.ImplicitVRLittleEndian);
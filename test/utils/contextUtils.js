@@ -59,6 +59,58 @@ function createContextFromColorRandomImage(planar, width, height) {
   });
 }
 
+/**
+ * Creates a context from an image whose samples are given by a function.
+ * @param {number} bitsAllocated - Number of bits allocated per sample (8 or 16).
+ * @param {number} samplesPerPixel - Number of samples per pixel (1 or 3).
+ * @param {boolean} planar - Whether the color samples are planar.
+ * @param {number} width - Image width.
+ * @param {number} height - Image height.
+ * @param {function(number, number, number): number} sampleFn - Sample value at x, y and sample.
+ * @returns {Context} - Context.
+ */
+function createContextFromImageFunction(
+  bitsAllocated,
+  samplesPerPixel,
+  planar,
+  width,
+  height,
+  sampleFn
+) {
+  const bytesAllocated = bitsAllocated / 8;
+  const buffer = new Uint8Array(width * height * samplesPerPixel * bytesAllocated);
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      for (let s = 0; s < samplesPerPixel; s++) {
+        const value = sampleFn(x, y, s);
+        const i = planar
+          ? s * width * height + y * width + x
+          : (y * width + x) * samplesPerPixel + s;
+        for (let b = 0; b < bytesAllocated; b++) {
+          buffer[i * bytesAllocated + b] = (value >> (8 * b)) & 0xff;
+        }
+      }
+    }
+  }
+
+  const color = samplesPerPixel === 3;
+  const planarConfiguration = planar ? PlanarConfiguration.Planar : PlanarConfiguration.Interleaved;
+
+  return new Context({
+    width,
+    height,
+    bitsAllocated,
+    bitsStored: bitsAllocated,
+    samplesPerPixel,
+    pixelRepresentation: PixelRepresentation.Unsigned,
+    photometricInterpretation: color
+      ? PhotometricInterpretation.Rgb
+      : PhotometricInterpretation.Monochrome2,
+    planarConfiguration: color ? planarConfiguration : undefined,
+    decodedBuffer: buffer,
+  });
+}
+
 /**
  * Compares two contexts.
  * @param {Context} lContext - Left context.
@@ -111,5 +163,6 @@ function compareContexts(lContext, rContext) {
 module.exports = {
   createContextFromGrayscaleRandomImage,
   createContextFromColorRandomImage,
+  createContextFromImageFunction,
   compareContexts,
 };
@@ -42,8 +42,8 @@ c_files=(
   "$OPENJPEG_SRC_DIR/tcd.c"
   "$OPENJPEG_SRC_DIR/tgt.c"
   "$OPENJPEG_SRC_DIR/function_list.c"
-  "$OPENJPEG_SRC_DIR/opj_malloc.c"
   "$OPENJPEG_SRC_DIR/sparse_array.c"
+  # opj_malloc.c is replaced by $WASM_SRC_DIR/OpjMalloc.cpp
 
   # libijg8
   "$LIBIJG8_SRC_DIR/jaricom.c"
@@ -465,16 +465,25 @@ cpp_files=(
   # common
   "$WASM_SRC_DIR/DecoderParameters.cpp"
   "$WASM_SRC_DIR/EncoderParameters.cpp"
+  "$WASM_SRC_DIR/TransformParameters.cpp"
   "$WASM_SRC_DIR/CodecsContext.cpp"
   "$WASM_SRC_DIR/Exception.cpp"
   "$WASM_SRC_DIR/Logging.cpp"
   "$WASM_SRC_DIR/Jpeg2000Buffer.cpp"
+  "$WASM_SRC_DIR/Jpeg2000Components.cpp"
+  "$WASM_SRC_DIR/Jpeg2000Packets.cpp"
+  "$WASM_SRC_DIR/Jpeg2000RateControl.cpp"
+  "$WASM_SRC_DIR/Jpeg2000Tiles.cpp"
+  "$WASM_SRC_DIR/JpegXlParallelRunner.cpp"
+  "$WASM_SRC_DIR/CodecsArena.cpp"
+  "$WASM_SRC_DIR/OpjMalloc.cpp"
 
   # decoders
   "$WASM_SRC_DIR/Decoders/JpegDecoder.cpp"
   "$WASM_SRC_DIR/Decoders/JpegDecoder8.cpp"
   "$WASM_SRC_DIR/Decoders/JpegDecoder12.cpp"
   "$WASM_SRC_DIR/Decoders/JpegDecoder16.cpp"
+  "$WASM_SRC_DIR/Decoders/JpegLsDecoder.cpp"
   "$WASM_SRC_DIR/Decoders/JpegXlDecoder.cpp"
   "$WASM_SRC_DIR/Decoders/RleDecoder.cpp"
   "$WASM_SRC_DIR/Decoders.cpp"
@@ -483,9 +492,17 @@ cpp_files=(
   "$WASM_SRC_DIR/Encoders/JpegEncoder8.cpp"
   "$WASM_SRC_DIR/Encoders/JpegEncoder12.cpp"
   "$WASM_SRC_DIR/Encoders/JpegEncoder16.cpp"
+  "$WASM_SRC_DIR/Encoders/JpegLsEncoder.cpp"
   "$WASM_SRC_DIR/Encoders/JpegXlEncoder.cpp"
   "$WASM_SRC_DIR/Encoders/RleEncoder.cpp"
   "$WASM_SRC_DIR/Encoders.cpp"
+
+  # transforms
+  "$WASM_SRC_DIR/Transforms/JpegTransform8.cpp"
+  "$WASM_SRC_DIR/Transforms.cpp"
+
+  # transcoders
+  "$WASM_SRC_DIR/Transcoders.cpp"
 )
 
 include_directories=(
@@ -517,11 +534,27 @@ definitions=(
   "-DWASM_CODECS_TRACE"
 )
 
+# Intra-frame JPEG-XL, JPEG 2000 and HT-JPEG 2000 parallelism
+# (WASM_CODECS_THREADS=1 ./build.sh). MUTEX_pthread enables the OpenJPEG
+# thread pool.
+# The module then needs a host that provides the Emscripten pthread runtime,
+# so the default standalone module stays single-threaded.
+thread_options=()
+if [ "${WASM_CODECS_THREADS:-0}" = "1" ]; then
+  cpp_files+=(
+    "$LIBJXL_SRC_DIR/lib/threads/thread_parallel_runner.cc"
+    "$LIBJXL_SRC_DIR/lib/threads/thread_parallel_runner_internal.cc"
+  )
+  definitions+=("-DWASM_CODECS_THREADS" "-DMUTEX_pthread")
+  thread_options=("-pthread" "-s" "PTHREAD_POOL_SIZE=4")
+fi
+
 mkdir -p ./bin
 emcc --no-entry -Werror -O3 -std=c++17 \
   "${c_files[@]}" \
   -x c++ "${cpp_files[@]}" \
   "${include_directories[@]}" "${suppress_warnings[@]}" "${definitions[@]}" \
+  "${thread_options[@]}" \
   -s EXPORTED_FUNCTIONS=[] \
   -s EXPORTED_RUNTIME_METHODS=[cwrap] \
   -s TOTAL_MEMORY=256MB \
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <utility>
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -14,6 +17,28 @@ struct Buffer {
     buffer_.reset(new uint8_t[size]);
     memset(GetData(), 0, size);
     size_ = size;
+    capacity_ = size;
+  }
+  // Resizes without clearing, keeping the allocation when it is large enough.
+  // The contents are not preserved when the buffer grows.
+  void Resize(size_t const size) {
+    if (size > capacity_) {
+      buffer_.reset(new uint8_t[size]);
+      capacity_ = size;
+    }
+    size_ = size;
+  }
+  size_t GetCapacity() const { return capacity_; }
+  // Grows the allocation to at least capacity bytes, preserving the contents.
+  void Reserve(size_t const capacity) {
+    if (capacity > capacity_) {
+      std::unique_ptr<uint8_t[]> buffer(new uint8_t[capacity]);
+      if (size_ > 0) {
+        memcpy(buffer.get(), buffer_.get(), size_);
+      }
+      buffer_ = std::move(buffer);
+      capacity_ = capacity;
+    }
   }
 
   Buffer(Buffer const &) = delete;
@@ -22,4 +47,5 @@ struct Buffer {
  private:
   std::unique_ptr<uint8_t[]> buffer_;
   size_t size_ = 0;
+  size_t capacity_ = 0;
 };
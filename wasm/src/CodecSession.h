@@ -0,0 +1,24 @@
+#pragma once
+
+#include <memory>
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct CodecSession {
+  virtual ~CodecSession() = default;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+template <typename T>
+T *GetCodecSession(std::unique_ptr<CodecSession> &session) {
+  // A session created by another codec is replaced, so a context that switches
+  // codecs simply pays the setup cost once more.
+  auto pSession = dynamic_cast<T *>(session.get());
+  if (pSession == nullptr) {
+    pSession = new T;
+    session.reset(pSession);
+  }
+
+  return pSession;
+}
@@ -0,0 +1,328 @@
+#include "CodecsArena.h"
+
+#include <jxl/memory_manager.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+#ifdef WASM_CODECS_THREADS
+#define ARENA_LOCK() lock_guard<mutex> lock(mutex_)
+#else
+#define ARENA_LOCK()
+#endif
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct alignas(16) CodecsArena::BlockHeader {
+  // Links of the free list (pooled blocks) or of the heap block list
+  BlockHeader *Prev;
+  BlockHeader *Next;
+  // Usable bytes after the header
+  size_t Size;
+  // 0: untracked heap block, 1: tracked heap block, otherwise log2 of the
+  // pooled block size
+  uint32_t SizeClass;
+  // Distance from the start of the heap allocation to the user pointer
+  uint32_t Offset;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+CodecsArena::~CodecsArena() {
+  Reset();
+  for (auto *chunk : chunks_) {
+    free(chunk);
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *CodecsArena::Allocate(size_t const size, size_t const alignment) {
+  ARENA_LOCK();
+
+  allocations_++;
+  auto const blockSize = size + sizeof(BlockHeader);
+  if (scopeDepth_ > 0 && alignment <= alignof(BlockHeader) &&
+      blockSize <= MaxPooledSize) {
+    auto sizeClass = MinSizeClass;
+    while ((size_t(1) << sizeClass) < blockSize) {
+      sizeClass++;
+    }
+
+    return AllocateFromChunks(sizeClass);
+  }
+
+  return AllocateFromHeap(size, alignment, scopeDepth_ > 0);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *CodecsArena::Reallocate(void *ptr, size_t const size,
+                              size_t const alignment) {
+  if (!ptr) {
+    return Allocate(size, alignment);
+  }
+
+  auto *header = reinterpret_cast<BlockHeader *>(ptr) - 1;
+  if (size <= header->Size) {
+    return ptr;
+  }
+
+  // A block that was allocated outside of a scope keeps its lifetime
+  void *newPtr = nullptr;
+  if (header->SizeClass == 0) {
+    ARENA_LOCK();
+    allocations_++;
+    newPtr = AllocateFromHeap(size, alignment, false);
+  } else {
+    newPtr = Allocate(size, alignment);
+  }
+  if (newPtr) {
+    memcpy(newPtr, ptr, header->Size);
+    Free(ptr);
+  }
+
+  return newPtr;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void CodecsArena::Free(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+
+  ARENA_LOCK();
+
+  auto *header = reinterpret_cast<BlockHeader *>(ptr) - 1;
+  if (header->SizeClass >= MinSizeClass) {
+    header->Next = freeLists_[header->SizeClass];
+    freeLists_[header->SizeClass] = header;
+    inUse_ -= size_t(1) << header->SizeClass;
+    return;
+  }
+
+  if (header->SizeClass == 1) {
+    if (header->Prev) {
+      header->Prev->Next = header->Next;
+    } else {
+      heapBlocks_ = header->Next;
+    }
+    if (header->Next) {
+      header->Next->Prev = header->Prev;
+    }
+    inUse_ -= header->Size;
+  }
+  free(reinterpret_cast<uint8_t *>(ptr) - header->Offset);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void CodecsArena::Reset() {
+  ARENA_LOCK();
+
+  while (heapBlocks_) {
+    auto *header = heapBlocks_;
+    heapBlocks_ = header->Next;
+    free(reinterpret_cast<uint8_t *>(header + 1) - header->Offset);
+  }
+  fill(begin(freeLists_), end(freeLists_), nullptr);
+
+  auto const retainedChunks = RetainedCapacity / ChunkSize;
+  while (chunks_.size() > retainedChunks) {
+    free(chunks_.back());
+    chunks_.pop_back();
+  }
+  chunk_ = 0;
+  chunkOffset_ = 0;
+  inUse_ = 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void CodecsArena::ResetStatistics() {
+  ARENA_LOCK();
+
+  highWaterMark_ = inUse_;
+  allocations_ = 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void CodecsArena::EnterScope() {
+  if (scopeDepth_ == 0 && abandoned_) {
+    Reset();
+    abandoned_ = false;
+  }
+  scopeDepth_++;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool CodecsArena::LeaveScope() {
+  // Scopes that are unwound after being abandoned leave the arena as is
+  if (scopeDepth_ == 0) {
+    return false;
+  }
+
+  return --scopeDepth_ == 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void CodecsArena::AbandonScopes() {
+  // Nothing is released here. When the C++ exception does unwind the stack,
+  // the codec objects still free their blocks on the way out.
+  abandoned_ = abandoned_ || scopeDepth_ > 0;
+  scopeDepth_ = 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *CodecsArena::AllocateFromChunks(size_t const sizeClass) {
+  auto const blockSize = size_t(1) << sizeClass;
+
+  auto *header = freeLists_[sizeClass];
+  if (header) {
+    freeLists_[sizeClass] = header->Next;
+  } else {
+    // The tail of a chunk that is too short for the block is left unused
+    if (chunk_ < chunks_.size() && chunkOffset_ + blockSize > ChunkSize) {
+      chunk_++;
+      chunkOffset_ = 0;
+    }
+    if (chunk_ == chunks_.size()) {
+      auto *chunk = static_cast<uint8_t *>(
+          aligned_alloc(alignof(BlockHeader), ChunkSize));
+      if (!chunk) {
+        return nullptr;
+      }
+      chunks_.push_back(chunk);
+    }
+    header = reinterpret_cast<BlockHeader *>(chunks_[chunk_] + chunkOffset_);
+    chunkOffset_ += blockSize;
+  }
+
+  header->Prev = nullptr;
+  header->Next = nullptr;
+  header->Size = blockSize - sizeof(BlockHeader);
+  header->SizeClass = static_cast<uint32_t>(sizeClass);
+  header->Offset = 0;
+  Track(blockSize);
+
+  return header + 1;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *CodecsArena::AllocateFromHeap(size_t const size, size_t const alignment,
+                                    bool const tracked) {
+  auto const align = max(alignment, alignof(BlockHeader));
+  auto *raw =
+      static_cast<uint8_t *>(malloc(sizeof(BlockHeader) + size + align - 1));
+  if (!raw) {
+    return nullptr;
+  }
+
+  auto const address = reinterpret_cast<uintptr_t>(raw + sizeof(BlockHeader));
+  auto *ptr = raw + sizeof(BlockHeader) + (align - address % align) % align;
+  auto *header = reinterpret_cast<BlockHeader *>(ptr) - 1;
+  header->Prev = nullptr;
+  header->Next = nullptr;
+  header->Size = size;
+  header->SizeClass = tracked ? 1 : 0;
+  header->Offset = static_cast<uint32_t>(ptr - raw);
+  if (tracked) {
+    header->Next = heapBlocks_;
+    if (heapBlocks_) {
+      heapBlocks_->Prev = header;
+    }
+    heapBlocks_ = header;
+    Track(size);
+  }
+
+  return ptr;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void CodecsArena::Track(size_t const blockSize) {
+  inUse_ += blockSize;
+  highWaterMark_ = max(highWaterMark_, inUse_);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+CodecsArena &GetCodecsArena() {
+  static CodecsArena arena;
+
+  return arena;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void *AllocateJxlMemory(void *opaque, size_t size) {
+  (void)opaque;
+
+  return GetCodecsArena().Allocate(size);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void FreeJxlMemory(void *opaque, void *address) {
+  (void)opaque;
+
+  GetCodecsArena().Free(address);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+JxlMemoryManager const *GetCodecsArenaJxlMemoryManager() {
+  static JxlMemoryManager const memoryManager = {nullptr, AllocateJxlMemory,
+                                                 FreeJxlMemory};
+
+  return &memoryManager;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+CodecsArenaScope::CodecsArenaScope() {
+  auto &arena = GetCodecsArena();
+  auto const outermost = !arena.IsScoped();
+  arena.EnterScope();
+  if (outermost) {
+    arena.ResetStatistics();
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+CodecsArenaScope::~CodecsArenaScope() {
+  auto &arena = GetCodecsArena();
+  if (arena.LeaveScope()) {
+    arena.Reset();
+  }
+}
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodecsArenaHighWaterMark(void) {
+  return GetCodecsArena().GetHighWaterMark();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodecsArenaCapacity(void) {
+  return GetCodecsArena().GetCapacity();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodecsArenaAllocations(void) {
+  return GetCodecsArena().GetAllocations();
+}
+}
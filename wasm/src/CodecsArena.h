@@ -0,0 +1,117 @@
+#pragma once
+
+#include <emscripten.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef WASM_CODECS_THREADS
+#include <mutex>
+#endif
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct CodecsArena {
+  CodecsArena() {}
+  virtual ~CodecsArena();
+
+  // Blocks up to MaxPooledSize are carved out of ChunkSize chunks in
+  // power-of-two size classes and recycled through per-class free lists.
+  // Larger or over-aligned blocks get their own heap allocation. Blocks
+  // handed out outside of a CodecsArenaScope always come from the heap and
+  // survive Reset.
+  void *Allocate(size_t const size, size_t const alignment = 16);
+  void *Reallocate(void *ptr, size_t const size, size_t const alignment = 16);
+  void Free(void *ptr);
+
+  // Reclaims every block of the call at once. Up to RetainedCapacity bytes of
+  // chunks are kept for the next call, the rest is returned to the heap.
+  void Reset();
+  void ResetStatistics();
+
+  size_t GetHighWaterMark() const { return highWaterMark_; }
+  size_t GetCapacity() const { return chunks_.size() * ChunkSize; }
+  size_t GetAllocations() const { return allocations_; }
+
+  bool IsScoped() const { return scopeDepth_ > 0; }
+  void EnterScope();
+  bool LeaveScope();
+  // Drops the open scopes of a call that fails. The JS exception skips their
+  // destructors, so the blocks of the call are reclaimed when the next
+  // outermost scope is entered instead.
+  void AbandonScopes();
+
+  static constexpr size_t ChunkSize = 1 << 20;
+  static constexpr size_t MaxPooledSize = 1 << 18;
+  static constexpr size_t RetainedCapacity = 32 << 20;
+
+  CodecsArena(CodecsArena const &) = delete;
+  CodecsArena &operator=(CodecsArena const &) = delete;
+
+ private:
+  struct BlockHeader;
+
+  void *AllocateFromChunks(size_t const sizeClass);
+  void *AllocateFromHeap(size_t const size, size_t const alignment,
+                         bool const tracked);
+  void Track(size_t const blockSize);
+
+  static constexpr size_t MinSizeClass = 6;
+  static constexpr size_t MaxSizeClass = 18;
+
+  BlockHeader *freeLists_[MaxSizeClass + 1] = {};
+  BlockHeader *heapBlocks_ = nullptr;
+  std::vector<uint8_t *> chunks_;
+  size_t chunk_ = 0;
+  size_t chunkOffset_ = 0;
+
+  size_t inUse_ = 0;
+  size_t highWaterMark_ = 0;
+  size_t allocations_ = 0;
+  size_t scopeDepth_ = 0;
+  bool abandoned_ = false;
+#ifdef WASM_CODECS_THREADS
+  // Codec worker threads allocate concurrently with the calling thread
+  std::mutex mutex_;
+#endif
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+CodecsArena &GetCodecsArena();
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct CodecsArenaScope {
+  // Placed at the top of every Decode*/Encode* export. Scopes nest, and the
+  // arena is reset when the outermost one exits. Codec errors abandon the
+  // scopes (see ThrowCodecsException), and the blocks of the failed call are
+  // reclaimed by the next outermost scope.
+  CodecsArenaScope();
+  virtual ~CodecsArenaScope();
+
+  CodecsArenaScope(CodecsArenaScope const &) = delete;
+  CodecsArenaScope &operator=(CodecsArenaScope const &) = delete;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Memory manager to pass to JxlDecoderCreate/JxlEncoderCreate. Only suitable
+// for decoders and encoders that are destroyed within the same call.
+struct JxlMemoryManagerStruct;
+JxlMemoryManagerStruct const *GetCodecsArenaJxlMemoryManager();
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodecsArenaHighWaterMark(void);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodecsArenaCapacity(void);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodecsArenaAllocations(void);
+}
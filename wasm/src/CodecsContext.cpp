@@ -122,6 +122,42 @@ EMSCRIPTEN_KEEPALIVE void SetPhotometricInterpretation(
   ctx->PhotometricInterpretation = photometricInterpretation;
 }
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetColorTransform(CodecsContext const *ctx) {
+  return ctx->ColorTransform;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetTileWidth(CodecsContext const *ctx) {
+  return ctx->TileWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetTileHeight(CodecsContext const *ctx) {
+  return ctx->TileHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetDecompositionLevels(CodecsContext const *ctx) {
+  return ctx->DecompositionLevels;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetDecodingComplete(CodecsContext const *ctx) {
+  return ctx->DecodingComplete;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetDownsamplingRatio(CodecsContext const *ctx) {
+  return ctx->DownsamplingRatio;
+}
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 EMSCRIPTEN_KEEPALIVE uint8_t *GetEncodedBuffer(CodecsContext const *ctx) {
@@ -141,6 +177,7 @@ EMSCRIPTEN_KEEPALIVE void SetEncodedBuffer(CodecsContext *ctx,
                                            size_t const size) {
   ctx->EncodedBuffer.Reset(size);
   memcpy(ctx->EncodedBuffer.GetData(), data, size);
+  ctx->EncodedFragments.clear();
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -148,6 +185,31 @@ EMSCRIPTEN_KEEPALIVE void SetEncodedBuffer(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void SetEncodedBufferSize(CodecsContext *ctx,
                                                size_t const size) {
   ctx->EncodedBuffer.Reset(size);
+  ctx->EncodedFragments.clear();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE uint8_t *AddEncodedFragment(CodecsContext *ctx,
+                                                size_t const size) {
+  auto fragment = make_unique<Buffer>();
+  fragment->Reset(size);
+  auto *data = fragment->GetData();
+  ctx->EncodedFragments.push_back(std::move(fragment));
+
+  return data;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetEncodedFragmentCount(CodecsContext const *ctx) {
+  return ctx->EncodedFragments.size();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void ClearEncodedFragments(CodecsContext *ctx) {
+  ctx->EncodedFragments.clear();
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -206,6 +268,7 @@ string ContextToString(CodecsContext const *ctx) {
       << (photometricInterpretation ? photometricInterpretation->_to_string()
                                     : "");
   oss << ", EncodedBufferSize: " << to_string(GetEncodedBufferSize(ctx));
+  oss << ", EncodedFragmentCount: " << to_string(GetEncodedFragmentCount(ctx));
   oss << ", DecodedBufferSize: " << to_string(GetDecodedBufferSize(ctx));
 
   return oss.str();
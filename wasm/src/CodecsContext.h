@@ -3,9 +3,12 @@
 #include <emscripten.h>
 #include <enum.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "Buffer.h"
+#include "CodecSession.h"
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -33,8 +36,27 @@ struct CodecsContext {
   size_t PlanarConfiguration = 0;
   size_t PhotometricInterpretation = 0;
 
+  // Coding layout, reported by ProbeImage
+  bool ColorTransform = false;
+  size_t TileWidth = 0;
+  size_t TileHeight = 0;
+  size_t DecompositionLevels = 0;
+
+  // Progressive decoding state, reported by DecodeJpegXlIncremental
+  // (a downsampling ratio of 0 means that no pixels are available yet)
+  bool DecodingComplete = true;
+  size_t DownsamplingRatio = 1;
+
   Buffer EncodedBuffer;
   Buffer DecodedBuffer;
+
+  // Pixel data fragments of the encoded frame, following the encoded buffer,
+  // read in place by the JPEG 2000 decoder instead of being joined first
+  std::vector<std::unique_ptr<Buffer>> EncodedFragments;
+
+  // Codec state kept alive across the frames of an instance
+  std::unique_ptr<CodecSession> DecoderSession;
+  std::unique_ptr<CodecSession> EncoderSession;
 };
 
 extern "C" {
@@ -116,6 +138,30 @@ GetPhotometricInterpretation(CodecsContext const *ctx);
 EMSCRIPTEN_KEEPALIVE void SetPhotometricInterpretation(
     CodecsContext *ctx, size_t photometricInterpretation);
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetColorTransform(CodecsContext const *ctx);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetTileWidth(CodecsContext const *ctx);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetTileHeight(CodecsContext const *ctx);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetDecompositionLevels(CodecsContext const *ctx);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetDecodingComplete(CodecsContext const *ctx);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetDownsamplingRatio(CodecsContext const *ctx);
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 EMSCRIPTEN_KEEPALIVE uint8_t *GetEncodedBuffer(CodecsContext const *ctx);
@@ -133,6 +179,19 @@ EMSCRIPTEN_KEEPALIVE void SetEncodedBuffer(CodecsContext *ctx,
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 EMSCRIPTEN_KEEPALIVE void SetEncodedBufferSize(CodecsContext *ctx, size_t size);
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE uint8_t *AddEncodedFragment(CodecsContext *ctx,
+                                                size_t size);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetEncodedFragmentCount(CodecsContext const *ctx);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void ClearEncodedFragments(CodecsContext *ctx);
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 EMSCRIPTEN_KEEPALIVE uint8_t *GetDecodedBuffer(CodecsContext const *ctx);
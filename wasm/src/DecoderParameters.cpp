@@ -33,6 +33,47 @@ EMSCRIPTEN_KEEPALIVE void SetConvertColorspaceToRgb(
     DecoderParameters *params, bool const convertColorspaceToRgb) {
   params->ConvertColorspaceToRgb = convertColorspaceToRgb;
 }
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetDecoderThreadCount(DecoderParameters const *params) {
+  return params->ThreadCount;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetDecoderThreadCount(DecoderParameters *params,
+                                                size_t const threadCount) {
+  params->ThreadCount = threadCount;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetResilient(DecoderParameters const *params) {
+  return params->Resilient;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetResilient(DecoderParameters *params,
+                                       bool const resilient) {
+  params->Resilient = resilient;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t
+GetOutputColorSpace(DecoderParameters const *params) {
+  return params->OutputColorSpace;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetOutputColorSpace(DecoderParameters *params,
+                                              int32_t const outputColorSpace) {
+  params->OutputColorSpace = outputColorSpace;
+}
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -42,6 +83,11 @@ string DecoderParametersToString(DecoderParameters const *params) {
 
   oss << "ConvertColorspaceToRgb [JPEG]: "
       << to_string(params->ConvertColorspaceToRgb);
+  oss << ", ThreadCount [HT-JPEG 2000 / JPEG-XL]: "
+      << to_string(params->ThreadCount);
+  oss << ", Resilient [HT-JPEG 2000]: " << to_string(params->Resilient);
+  oss << ", OutputColorSpace [JPEG-XL]: "
+      << to_string(params->OutputColorSpace);
 
   return oss.str();
 }
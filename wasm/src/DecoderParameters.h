@@ -8,6 +8,16 @@
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 struct DecoderParameters {
   bool ConvertColorspaceToRgb = false;
+
+  // HT-JPEG 2000, JPEG-XL (0: hardware concurrency, 1: serial)
+  size_t ThreadCount = 0;
+
+  // HT-JPEG 2000 (false: strict parsing, for trusted codestreams; true:
+  // OpenJPH resilience to corrupted or truncated codestreams)
+  bool Resilient = false;
+
+  // JPEG-XL (0: sRGB, 1: linear sRGB float, 2: XYB float)
+  int32_t OutputColorSpace = 0;
 };
 
 extern "C" {
@@ -29,6 +39,35 @@ EMSCRIPTEN_KEEPALIVE bool GetConvertColorspaceToRgb(
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 EMSCRIPTEN_KEEPALIVE void SetConvertColorspaceToRgb(
     DecoderParameters *params, bool convertColorspaceToRgb);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetDecoderThreadCount(DecoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetDecoderThreadCount(DecoderParameters *params,
+                                                size_t threadCount);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetResilient(DecoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetResilient(DecoderParameters *params,
+                                       bool resilient);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t
+GetOutputColorSpace(DecoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetOutputColorSpace(DecoderParameters *params,
+                                              int32_t outputColorSpace);
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
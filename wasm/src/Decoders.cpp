@@ -1,25 +1,32 @@
 #include <charls/charls.h>
 #include <emscripten.h>
+#include <jxl/decode.h>
 #include <ojph_codestream.h>
 #include <ojph_file.h>
 #include <ojph_mem.h>
 #include <ojph_params.h>
 #include <opj_includes.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Buffer.h"
+#include "CodecsArena.h"
 #include "CodecsContext.h"
 #include "DecoderParameters.h"
 #include "Decoders/JpegDecoder.h"
 #include "Decoders/JpegDecoder12.h"
 #include "Decoders/JpegDecoder16.h"
 #include "Decoders/JpegDecoder8.h"
+#include "Decoders/JpegLsDecoder.h"
 #include "Decoders/JpegXlDecoder.h"
 #include "Decoders/RleDecoder.h"
 #include "Exception.h"
 #include "Jpeg2000Buffer.h"
+#include "Jpeg2000Components.h"
+#include "Jpeg2000Packets.h"
+#include "Jpeg2000Tiles.h"
 #include "Logging.h"
 
 using namespace std;
@@ -30,44 +37,348 @@ using namespace ojph;
 #define JP2_MAGIC "\x0d\x0a\x87\x0a"
 #define J2K_CODESTREAM_MAGIC "\xff\x4f\xff\x51"
 
-extern "C" {
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-EMSCRIPTEN_KEEPALIVE void DecodeRle(CodecsContext *ctx,
-                                    DecoderParameters *params) {
-  DECODER_TRACE_ENTRY(ctx, params);
+static void SetProbedImageInfo(CodecsContext *ctx, size_t columns, size_t rows,
+                               size_t bitsStored, size_t samplesPerPixel) {
+  SetColumns(ctx, columns);
+  SetRows(ctx, rows);
+  SetBitsStored(ctx, bitsStored);
+  SetBitsAllocated(ctx, bitsStored <= 8 ? 8 : 16);
+  SetSamplesPerPixel(ctx, samplesPerPixel);
+  ctx->ColorTransform = false;
+  ctx->TileWidth = columns;
+  ctx->TileHeight = rows;
+  ctx->DecompositionLevels = 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ProbeRle(CodecsContext *ctx) {
+  if (GetEncodedBufferSize(ctx) < 64) {
+    ThrowCodecsException("ProbeImage::ProbeRle::RLE header is truncated");
+  }
 
   RleDecoder decoder(GetEncodedBuffer(ctx),
                      static_cast<int32_t>(GetEncodedBufferSize(ctx)));
+  auto const segments = static_cast<size_t>(decoder.GetNumberOfSegments());
+  if (segments < 1 || segments > 15) {
+    ThrowCodecsException("ProbeImage::ProbeRle::Invalid number of segments (" +
+                         to_string(segments) + ")");
+  }
+
+  // The RLE header only describes the byte segments. The dimensions are
+  // kept from the dataset, and the sample layout is derived from the bits
+  // allocated, when known.
+  auto bytesAllocated = (GetBitsAllocated(ctx) / 8) +
+                        ((GetBitsAllocated(ctx) % 8 == 0) ? 0 : 1);
+  if (bytesAllocated == 0) {
+    bytesAllocated = segments % 3 == 0 ? segments / 3 : segments;
+  }
+  // Each sample is split in one segment per byte, so the segments have to
+  // describe either one or three samples per pixel
+  if (segments % bytesAllocated != 0 ||
+      (segments / bytesAllocated != 1 && segments / bytesAllocated != 3)) {
+    ThrowCodecsException("ProbeImage::ProbeRle::Number of segments (" +
+                         to_string(segments) +
+                         ") does not match the bits allocated (" +
+                         to_string(bytesAllocated * 8) + ")");
+  }
+  auto const bitsStored = GetBitsStored(ctx) > 0 &&
+                                  GetBitsStored(ctx) <= bytesAllocated * 8
+                              ? GetBitsStored(ctx)
+                              : bytesAllocated * 8;
+  SetProbedImageInfo(ctx, GetColumns(ctx), GetRows(ctx), bitsStored,
+                     segments / bytesAllocated);
+  SetBitsAllocated(ctx, bytesAllocated * 8);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ThrowIfJpegLsProbeFailed(string const &call,
+                                     jpegls_errc const errc) {
+  if (errc != jpegls_errc::success) {
+    ThrowCodecsException("ProbeImage::" + call +
+                         "::" + string(charls_get_error_message(errc)));
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ProbeJpegLs(CodecsContext *ctx) {
+  unique_ptr<charls_jpegls_decoder, decltype(&charls_jpegls_decoder_destroy)>
+      decoder(charls_jpegls_decoder_create(), &charls_jpegls_decoder_destroy);
+  if (!decoder) {
+    ThrowCodecsException(
+        "ProbeImage::charls_jpegls_decoder_create::Failed to create decoder");
+  }
+
+  ThrowIfJpegLsProbeFailed(
+      "charls_jpegls_decoder_set_source_buffer",
+      charls_jpegls_decoder_set_source_buffer(
+          decoder.get(), GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx)));
+  ThrowIfJpegLsProbeFailed("charls_jpegls_decoder_read_header",
+                           charls_jpegls_decoder_read_header(decoder.get()));
+
+  charls_frame_info frameInfo = {};
+  ThrowIfJpegLsProbeFailed(
+      "charls_jpegls_decoder_get_frame_info",
+      charls_jpegls_decoder_get_frame_info(decoder.get(), &frameInfo));
+  auto colorTransformation = color_transformation::none;
+  ThrowIfJpegLsProbeFailed("charls_jpegls_decoder_get_color_transformation",
+                           charls_jpegls_decoder_get_color_transformation(
+                               decoder.get(), &colorTransformation));
+
+  SetProbedImageInfo(ctx, static_cast<size_t>(frameInfo.width),
+                     static_cast<size_t>(frameInfo.height),
+                     static_cast<size_t>(frameInfo.bits_per_sample),
+                     static_cast<size_t>(frameInfo.component_count));
+  ctx->ColorTransform = colorTransformation != color_transformation::none;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ProbeJpeg(CodecsContext *ctx) {
+  JpegFrameHeader header;
+  if (!ScanJpegDataForFrameHeader(GetEncodedBuffer(ctx),
+                                  GetEncodedBufferSize(ctx), &header)) {
+    ThrowCodecsException(
+        "ProbeImage::ScanJpegDataForFrameHeader::No frame header");
+  }
+  if (header.Marker == 0xfff7) {
+    ProbeJpegLs(ctx);
+    return;
+  }
+
+  SetProbedImageInfo(ctx, header.Columns, header.Rows, header.Precision,
+                     header.Components);
+  // Same rules as libjpeg, for DCT-based processes. Lossless (SOF3) frames
+  // are stored without a colour transform.
+  auto const isLossless = header.Marker == 0xffc3 || header.Marker == 0xffc7;
+  ctx->ColorTransform = !isLossless && header.Components == 3 &&
+                        !header.RgbComponentIds && header.AdobeTransform != 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static bool IsHtJpeg2000Codestream(uint8_t const *data, size_t const nBytes) {
+  if (nBytes < 4 || memcmp(data, J2K_CODESTREAM_MAGIC, 4) != 0) {
+    return false;
+  }
+
+  // Looks for the CAP marker, which is mandatory in HTJ2K main headers
+  size_t offset = 2;
+  while ((offset + 4) <= nBytes) {
+    auto const marker = static_cast<uint16_t>((data[offset] << 8) |
+                                              data[offset + 1]);
+    if (marker == 0xff50) {
+      return true;
+    }
+    if (marker == 0xff90 || (marker & 0xff00) != 0xff00) {
+      return false;
+    }
+    offset += 2 + static_cast<size_t>((data[offset + 2] << 8) |
+                                      data[offset + 3]);
+  }
+
+  return false;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ProbeHtJpeg2000(CodecsContext *ctx) {
+  mem_infile sourceBuffer;
+  codestream codestream;
+
+  sourceBuffer.open(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx));
+  codestream.read_headers(&sourceBuffer);
+
+  auto const siz = codestream.access_siz();
+  auto const cod = codestream.access_cod();
+  auto const width = siz.get_image_extent().x - siz.get_image_offset().x;
+  auto const height = siz.get_image_extent().y - siz.get_image_offset().y;
+
+  SetProbedImageInfo(ctx, width, height, siz.get_bit_depth(0),
+                     siz.get_num_components());
+  SetPixelRepresentation(ctx, siz.is_signed(0)
+                                  ? +PixelRepresentationEnum::Signed
+                                  : +PixelRepresentationEnum::Unsigned);
+  ctx->ColorTransform = cod.is_using_color_transform();
+  ctx->TileWidth = siz.get_tile_size().w;
+  ctx->TileHeight = siz.get_tile_size().h;
+  ctx->DecompositionLevels = cod.get_num_decompositions();
+
+  codestream.close();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// The codestream is the encoded buffer followed by the encoded fragments
+static vector<Jpeg2000Fragment> GetJpeg2000Fragments(CodecsContext const *ctx) {
+  vector<Jpeg2000Fragment> fragments;
+  fragments.reserve(1 + ctx->EncodedFragments.size());
+  fragments.push_back({GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx)});
+  for (auto const &fragment : ctx->EncodedFragments) {
+    fragments.push_back({fragment->GetData(), fragment->GetSize()});
+  }
+
+  return fragments;
+}
 
-  auto const bytesAllocated =
-      (GetBitsAllocated(ctx) / 8) + ((GetBitsAllocated(ctx) % 8 == 0) ? 0 : 1);
-  auto const pixelCount = GetColumns(ctx) * GetRows(ctx);
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ProbeJpeg2000(CodecsContext *ctx, OPJ_CODEC_FORMAT codecFormat) {
+  Jpeg2000ReadBuffer sourceBuffer(GetJpeg2000Fragments(ctx));
+
+  auto pStream = OpjCreateReadStream(&sourceBuffer);
+  if (!pStream) {
+    ThrowCodecsException(
+        "ProbeImage::OpjCreateReadStream::Failed to create stream");
+  }
 
-  auto const decodedBufferSize =
-      pixelCount * bytesAllocated * GetSamplesPerPixel(ctx);
-  SetDecodedBufferSize(ctx, decodedBufferSize);
-  auto const pDest = GetDecodedBuffer(ctx);
+  auto pCodec = opj_create_decompress(codecFormat);
+  if (!pCodec) {
+    opj_stream_destroy(pStream);
+    ThrowCodecsException(
+        "ProbeImage::opj_create_decompress::Failed to create codec");
+  }
 
-  for (auto s = 0; s < decoder.GetNumberOfSegments(); s++) {
-    auto const sample = static_cast<size_t>(s) / bytesAllocated;
-    auto const sabyte = static_cast<size_t>(s) % bytesAllocated;
+  opj_set_info_handler(pCodec, OpjMessageCallbackInfo, nullptr);
+  opj_set_warning_handler(pCodec, OpjMessageCallbackWarning, nullptr);
+  opj_set_error_handler(pCodec, OpjMessageCallbackError, nullptr);
 
-    auto pos =
-        GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Interleaved
-            ? sample * bytesAllocated
-            : sample * bytesAllocated * pixelCount;
-    pos += bytesAllocated - sabyte - 1;
-    auto const offset =
-        GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Interleaved
-            ? GetSamplesPerPixel(ctx) * bytesAllocated
-            : bytesAllocated;
+  opj_dparameters_t parameters;
+  opj_set_default_decoder_parameters(&parameters);
+  opj_image_t *pImage = nullptr;
+  if (!opj_setup_decoder(pCodec, &parameters) ||
+      !opj_read_header(pStream, pCodec, &pImage)) {
+    opj_stream_destroy(pStream);
+    opj_destroy_codec(pCodec);
+    opj_image_destroy(pImage);
+    ThrowCodecsException(
+        "ProbeImage::opj_read_header::Failed to read the header");
+  }
 
-    decoder.DecodeSegment(s, pDest, static_cast<int32_t>(decodedBufferSize),
-                          static_cast<int32_t>(pos),
-                          static_cast<int32_t>(offset));
+  // The image returned by opj_read_header has no component data allocated
+  SetProbedImageInfo(ctx, pImage->x1 - pImage->x0, pImage->y1 - pImage->y0,
+                     pImage->comps[0].prec, pImage->numcomps);
+  SetPixelRepresentation(ctx, pImage->comps[0].sgnd
+                                  ? +PixelRepresentationEnum::Signed
+                                  : +PixelRepresentationEnum::Unsigned);
+
+  auto pInfo = opj_get_cstr_info(pCodec);
+  if (pInfo) {
+    ctx->ColorTransform = pInfo->m_default_tile_info.mct != 0;
+    ctx->TileWidth = pInfo->tdx;
+    ctx->TileHeight = pInfo->tdy;
+    if (pInfo->m_default_tile_info.tccp_info) {
+      ctx->DecompositionLevels =
+          pInfo->m_default_tile_info.tccp_info[0].numresolutions - 1;
+    }
+    opj_destroy_cstr_info(&pInfo);
   }
 
+  opj_stream_destroy(pStream);
+  opj_destroy_codec(pCodec);
+  opj_image_destroy(pImage);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Decodes the codestream to destination, rowStride bytes apart. Without a
+// destination, the whole image is decoded into the decoded buffer. OpenJPH
+// resilience, which tolerates corrupted codestreams on slower parsing paths,
+// is only enabled on request.
+static void DecodeHtJpeg2000Codestream(CodecsContext *ctx,
+                                       uint8_t const *data,
+                                       size_t const size, uint8_t *destination,
+                                       size_t rowStride,
+                                       bool const resilient) {
+  mem_infile sourceBuffer;
+  codestream codestream;
+
+  sourceBuffer.open(data, size);
+  if (resilient) {
+    codestream.enable_resilience();
+  }
+  codestream.read_headers(&sourceBuffer);
+  codestream.restrict_input_resolution(0, 0);
+
+  auto const siz = codestream.access_siz();
+  auto const cod = codestream.access_cod();
+  codestream.set_planar(siz.get_num_components() == 1
+                            ? true
+                            : (cod.is_using_color_transform() ? false : true));
+  codestream.create();
+
+  auto const width = siz.get_image_extent().x - siz.get_image_offset().x;
+  auto const height = siz.get_image_extent().y - siz.get_image_offset().y;
+
+  auto const samplesPerPixel = GetSamplesPerPixel(ctx);
+  auto const bytesPerPixel = GetBitsAllocated(ctx) / 8;
+  if (!destination) {
+    rowStride = width * samplesPerPixel * bytesPerPixel;
+    SetDecodedBufferSize(ctx, rowStride * height);
+    destination = GetDecodedBuffer(ctx);
+  }
+
+  ui32 comp_num;
+  for (auto y = 0u; y < height; y++) {
+    auto *lineStart = destination + y * rowStride;
+    for (auto c = 0u; c < samplesPerPixel; c++) {
+      auto line = codestream.pull(comp_num);
+      if (GetBitsAllocated(ctx) <= 8) {
+        auto dp = lineStart + c;
+        for (auto x = 0u; x < width; x++) {
+          auto const val = line->i32[x];
+          dp[x * samplesPerPixel] =
+              static_cast<uint8_t>(max(0, min(val, UCHAR_MAX)));
+        }
+      } else {
+        if (GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed) {
+          auto dp = reinterpret_cast<int16_t *>(lineStart) + c;
+          for (auto x = 0u; x < width; x++) {
+            auto const val = line->i32[x];
+            dp[x * samplesPerPixel] =
+                static_cast<int16_t>(max(SHRT_MIN, min(val, SHRT_MAX)));
+          }
+        } else {
+          auto dp = reinterpret_cast<uint16_t *>(lineStart) + c;
+          for (auto x = 0u; x < width; x++) {
+            auto const val = line->i32[x];
+            dp[x * samplesPerPixel] =
+                static_cast<uint16_t>(max(0, min(val, USHRT_MAX)));
+          }
+        }
+      }
+    }
+  }
+
+  codestream.close();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// OpenJPEG binds a codec to a single codestream and allocates from the
+// per-call arena, so the codec itself cannot outlive a frame. The session
+// only keeps the decoder parameters, while the decoded buffer of the context
+// is reused by the frames of an instance.
+struct Jpeg2000DecoderSession : public CodecSession {
+  Jpeg2000DecoderSession() { opj_set_default_decoder_parameters(&Parameters); }
+
+  opj_dparameters_t Parameters;
+};
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void DecodeRle(CodecsContext *ctx,
+                                    DecoderParameters *params) {
+  DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
+
+  DecodeRleImpl(ctx, params);
+
   DECODER_TRACE_EXIT(ctx);
 }
 
@@ -76,6 +387,7 @@ EMSCRIPTEN_KEEPALIVE void DecodeRle(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void DecodeJpeg(CodecsContext *ctx,
                                      DecoderParameters *params) {
   DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
   auto jpegBitDepth =
       ScanJpegDataForBitDepth(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx));
@@ -105,29 +417,9 @@ EMSCRIPTEN_KEEPALIVE void DecodeJpeg(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void DecodeJpegLs(CodecsContext *ctx,
                                        DecoderParameters *params) {
   DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
-  JlsParameters jlsParams = {};
-
-  char errorMsg[256 + 1] = {'\0'};
-  auto retCode = JpegLsReadHeader(
-      GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx), &jlsParams, errorMsg);
-  if (retCode != ApiResult::OK) {
-    ThrowCodecsException("DecodeJpegLs::JpegLsReadHeader::" + string(errorMsg));
-  }
-  jlsParams.outputBgr = false;
-
-  auto const bytesPerSample = (jlsParams.bitsPerSample / 8) +
-                              (jlsParams.bitsPerSample % 8 == 0 ? 0 : 1);
-  auto const decodedBufferSize = jlsParams.width * jlsParams.height *
-                                 jlsParams.components * bytesPerSample;
-  SetDecodedBufferSize(ctx, static_cast<size_t>(decodedBufferSize));
-
-  retCode = JpegLsDecode(GetDecodedBuffer(ctx), GetDecodedBufferSize(ctx),
-                         GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx),
-                         &jlsParams, errorMsg);
-  if (retCode != ApiResult::OK) {
-    ThrowCodecsException("DecodeJpegLs::JpegLsDecode::" + string(errorMsg));
-  }
+  DecodeJpegLsImpl(ctx, params);
 
   DECODER_TRACE_EXIT(ctx);
 }
@@ -137,12 +429,22 @@ EMSCRIPTEN_KEEPALIVE void DecodeJpegLs(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void DecodeJpeg2000(CodecsContext *ctx,
                                          DecoderParameters *params) {
   DECODER_TRACE_ENTRY(ctx, params);
-
-  Jpeg2000Buffer sourceBuffer(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx));
-
-  uint8_t buf12[12];
+  CodecsArenaScope arenaScope;
+
+  auto session = GetCodecSession<Jpeg2000DecoderSession>(ctx->DecoderSession);
+  Jpeg2000ReadBuffer sourceBuffer(GetJpeg2000Fragments(ctx));
+
+  // The signature may straddle fragments
+  uint8_t buf12[12] = {};
+  size_t offset = 0;
+  for (auto const &fragment : sourceBuffer.Fragments) {
+    auto const length = min<size_t>(sizeof(buf12) - offset, fragment.Size);
+    if (length > 0) {
+      memcpy(buf12 + offset, fragment.Data, length);
+      offset += length;
+    }
+  }
   auto codecFormat = OPJ_CODEC_FORMAT::OPJ_CODEC_UNKNOWN;
-  memcpy(buf12, GetEncodedBuffer(ctx), 12);
   if (memcmp(buf12, JP2_RFC3745_MAGIC, 12) == 0 ||
       memcmp(buf12, JP2_MAGIC, 4) == 0) {
     codecFormat = OPJ_CODEC_FORMAT::OPJ_CODEC_JP2;
@@ -150,11 +452,10 @@ EMSCRIPTEN_KEEPALIVE void DecodeJpeg2000(CodecsContext *ctx,
     codecFormat = OPJ_CODEC_FORMAT::OPJ_CODEC_J2K;
   }
 
-  auto pStream =
-      OpjCreateMemoryStream(&sourceBuffer, OPJ_J2K_STREAM_CHUNK_SIZE, true);
+  auto pStream = OpjCreateReadStream(&sourceBuffer);
   if (!pStream) {
     ThrowCodecsException(
-        "DecodeJpeg2000::OpjCreateMemoryStream::Failed to create stream");
+        "DecodeJpeg2000::OpjCreateReadStream::Failed to create stream");
   }
 
   auto pCodec = opj_create_decompress(codecFormat);
@@ -168,9 +469,7 @@ EMSCRIPTEN_KEEPALIVE void DecodeJpeg2000(CodecsContext *ctx,
   opj_set_warning_handler(pCodec, OpjMessageCallbackWarning, nullptr);
   opj_set_error_handler(pCodec, OpjMessageCallbackError, nullptr);
 
-  opj_dparameters_t parameters;
-  opj_set_default_decoder_parameters(&parameters);
-  if (!opj_setup_decoder(pCodec, &parameters)) {
+  if (!opj_setup_decoder(pCodec, &session->Parameters)) {
     opj_stream_destroy(pStream);
     opj_destroy_codec(pCodec);
     ThrowCodecsException(
@@ -186,6 +485,16 @@ EMSCRIPTEN_KEEPALIVE void DecodeJpeg2000(CodecsContext *ctx,
         "DecodeJpeg2000::opj_read_header::Failed to read the header");
   }
 
+  if (!IsJpeg2000ComponentLayoutSupported(pImage)) {
+    auto const numberOfComponents = pImage->numcomps;
+    opj_stream_destroy(pStream);
+    opj_destroy_codec(pCodec);
+    opj_image_destroy(pImage);
+    ThrowCodecsException(
+        "DecodeJpeg2000::Unsupported component layout (components: " +
+        to_string(numberOfComponents) + ")");
+  }
+
   if (!(opj_decode(pCodec, pStream, pImage) &&
         opj_end_decompress(pCodec, pStream))) {
     opj_stream_destroy(pStream);
@@ -194,38 +503,7 @@ EMSCRIPTEN_KEEPALIVE void DecodeJpeg2000(CodecsContext *ctx,
     ThrowCodecsException("DecodeJpeg2000::opj_decode::Failed to decode image");
   }
 
-  auto const depth = (pImage->comps[0].prec + 7) / 8;
-  auto const decodedBufferSize =
-      GetColumns(ctx) * GetRows(ctx) * pImage->numcomps * depth;
-  SetDecodedBufferSize(ctx, decodedBufferSize);
-
-  auto const numPixels = GetColumns(ctx) * GetRows(ctx);
-  if (pImage->numcomps == 1) {
-    if (pImage->comps[0].prec <= 8) {
-      auto pDest = GetDecodedBuffer(ctx);
-      auto pSource = pImage->comps[0].data;
-      for (auto i = numPixels; i; i--) {
-        *pDest++ = static_cast<uint8_t>(*pSource++);
-      }
-    }
-    if (pImage->comps[0].prec > 8) {
-      auto pDest = reinterpret_cast<uint16_t *>(GetDecodedBuffer(ctx));
-      auto pSource = pImage->comps[0].data;
-      for (auto i = numPixels; i; i--) {
-        *pDest++ = static_cast<uint16_t>(*pSource++);
-      }
-    }
-  } else if (pImage->numcomps == 3) {
-    auto pDest = GetDecodedBuffer(ctx);
-    auto pSourceR = pImage->comps[0].data;
-    auto pSourceG = pImage->comps[1].data;
-    auto pSourceB = pImage->comps[2].data;
-    for (auto i = numPixels; i; i--) {
-      *pDest++ = static_cast<uint8_t>(*pSourceR++);
-      *pDest++ = static_cast<uint8_t>(*pSourceG++);
-      *pDest++ = static_cast<uint8_t>(*pSourceB++);
-    }
-  }
+  AssembleJpeg2000Components(ctx, pImage);
 
   opj_stream_destroy(pStream);
   opj_destroy_codec(pCodec);
@@ -239,111 +517,151 @@ EMSCRIPTEN_KEEPALIVE void DecodeJpeg2000(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void DecodeHtJpeg2000(CodecsContext *ctx,
                                            DecoderParameters *params) {
   DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
+
+  // Tiled codestreams are split into codestreams of one tile each, decoded in
+  // parallel into disjoint areas of the decoded buffer. The first tile is
+  // decoded before the workers start, as OpenJPH initializes its shared
+  // tables on first use.
+  Jpeg2000TileGrid grid;
+  vector<vector<uint8_t>> tiles;
+  auto const workers = GetJpeg2000WorkerCount(params->ThreadCount);
+  if (workers > 1 &&
+      ReadJpeg2000TileGrid(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx),
+                           &grid) &&
+      grid.GetNumberOfTiles() > 1 &&
+      SplitJpeg2000Tiles(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx),
+                         grid, &tiles)) {
+    auto const width = grid.ImageX1 - grid.ImageX0;
+    auto const height = grid.ImageY1 - grid.ImageY0;
+    auto const bytesPerPixel =
+        GetSamplesPerPixel(ctx) * (GetBitsAllocated(ctx) / 8);
+    SetDecodedBufferSize(ctx, width * height * bytesPerPixel);
+
+    auto const decodeTile = [&](size_t const t) {
+      auto const tileRect = grid.GetTileRect(t);
+      auto *destination =
+          GetDecodedBuffer(ctx) +
+          ((tileRect.org.y - grid.ImageY0) * width + tileRect.org.x -
+           grid.ImageX0) *
+              bytesPerPixel;
+      DecodeHtJpeg2000Codestream(ctx, tiles[t].data(), tiles[t].size(),
+                                 destination, width * bytesPerPixel,
+                                 params->Resilient);
+    };
+    decodeTile(0);
+    RunJpeg2000TileJobs(tiles.size() - 1, workers,
+                        [&](size_t const t) { decodeTile(t + 1); });
+  } else {
+    DecodeHtJpeg2000Codestream(ctx, GetEncodedBuffer(ctx),
+                               GetEncodedBufferSize(ctx), nullptr, 0,
+                               params->Resilient);
+  }
 
-  mem_infile sourceBuffer;
-  codestream codestream;
+  DECODER_TRACE_EXIT(ctx);
+}
 
-  sourceBuffer.open(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx));
-  codestream.enable_resilience();
-  codestream.read_headers(&sourceBuffer);
-  codestream.restrict_input_resolution(0, 0);
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void DecodeJpegXl(CodecsContext *ctx,
+                                       DecoderParameters *params) {
+  DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
-  auto const siz = codestream.access_siz();
-  ui32 bitDepths[4] = {0, 0, 0, 0};
-  for (auto c = 0u; c < siz.get_num_components(); c++) {
-    bitDepths[c] = siz.get_bit_depth(c);
-  }
+  DecodeJpegXlImpl(ctx, params);
 
-  auto const cod = codestream.access_cod();
-  codestream.set_planar(siz.get_num_components() == 1
-                            ? true
-                            : (cod.is_using_color_transform() ? false : true));
-  codestream.create();
+  DECODER_TRACE_EXIT(ctx);
+}
 
-  auto const width = siz.get_image_extent().x - siz.get_image_offset().x;
-  auto const height = siz.get_image_extent().y - siz.get_image_offset().y;
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void DecodeJpegXlIncremental(CodecsContext *ctx,
+                                                  DecoderParameters *params) {
+  DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
-  auto const bytesPerPixel = GetBitsAllocated(ctx) / 8;
-  auto const decodedBufferSize =
-      width * height * GetSamplesPerPixel(ctx) * bytesPerPixel;
-  vector<uint8_t> decodedBuffer;
-  decodedBuffer.resize(decodedBufferSize);
+  DecodeJpegXlIncrementalImpl(ctx, params);
 
-  ui32 comp_num;
-  for (auto y = 0u; y < height; y++) {
-    auto const lineStart = y * width * GetSamplesPerPixel(ctx) * bytesPerPixel;
-    if (GetSamplesPerPixel(ctx) == 1) {
-      auto line = codestream.pull(comp_num);
-      if (GetBitsAllocated(ctx) <= 8) {
-        auto dp = &decodedBuffer[lineStart];
-        for (auto x = 0; x < width; x++) {
-          auto const val = line->i32[x];
-          dp[x] = static_cast<uint8_t>(max(0, min(val, UCHAR_MAX)));
-        }
-      } else {
-        if (GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed) {
-          auto dp = reinterpret_cast<int16_t *>(&(decodedBuffer)[lineStart]);
-          for (auto x = 0; x < width; x++) {
-            auto const val = line->i32[x];
-            dp[x] = static_cast<int16_t>(max(SHRT_MIN, min(val, SHRT_MAX)));
-          }
-        } else {
-          auto dp = reinterpret_cast<uint16_t *>(&(decodedBuffer)[lineStart]);
-          for (auto x = 0u; x < width; x++) {
-            auto const val = line->i32[x];
-            dp[x] = static_cast<uint16_t>(max(0, min(val, USHRT_MAX)));
-          }
-        }
-      }
-    } else {
-      for (auto c = 0; c < GetSamplesPerPixel(ctx); c++) {
-        auto line = codestream.pull(comp_num);
-        if (GetBitsAllocated(ctx) <= 8) {
-          auto dp = &(decodedBuffer)[lineStart] + c;
-          for (auto x = 0u; x < width; x++) {
-            auto const val = line->i32[x];
-            dp[x * GetSamplesPerPixel(ctx)] =
-                static_cast<uint8_t>(max(0, min(val, UCHAR_MAX)));
-          }
-        } else {
-          if (GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed) {
-            auto dp =
-                reinterpret_cast<int16_t *>(&(decodedBuffer)[lineStart]) + c;
-            for (auto x = 0u; x < width; x++) {
-              auto const val = line->i32[x];
-              dp[x * GetSamplesPerPixel(ctx)] =
-                  static_cast<int16_t>(max(SHRT_MIN, min(val, SHRT_MAX)));
-            }
-          } else {
-            auto dp =
-                reinterpret_cast<uint16_t *>(&(decodedBuffer)[lineStart]) + c;
-            for (auto x = 0u; x < width; x++) {
-              auto const val = line->i32[x];
-              dp[x * GetSamplesPerPixel(ctx)] =
-                  static_cast<uint16_t>(max(0, min(val, USHRT_MAX)));
-            }
-          }
-        }
-      }
-    }
-  }
+  DECODER_TRACE_EXIT(ctx);
+}
 
-  codestream.close();
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void TranscodeJpegXlToJpeg(CodecsContext *ctx,
+                                                DecoderParameters *params) {
+  DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
-  SetDecodedBufferSize(ctx, decodedBufferSize);
-  auto pDest = GetDecodedBuffer(ctx);
-  memcpy(pDest, decodedBuffer.data(), decodedBufferSize);
+  TranscodeJpegXlToJpegImpl(ctx, params);
 
   DECODER_TRACE_EXIT(ctx);
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-EMSCRIPTEN_KEEPALIVE void DecodeJpegXl(CodecsContext *ctx,
-                                       DecoderParameters *params) {
+EMSCRIPTEN_KEEPALIVE void ProbeImage(CodecsContext *ctx,
+                                     DecoderParameters *params) {
   DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
+
+  auto const pData = GetEncodedBuffer(ctx);
+  auto const size = GetEncodedBufferSize(ctx);
+
+  // The codec is sniffed from the signature. Only the headers are parsed and
+  // no decoded buffer is allocated.
+  if (size >= 2 && pData[0] == 0xff && pData[1] == 0xd8) {
+    ProbeJpeg(ctx);
+  } else if (size >= 12 && (memcmp(pData, JP2_RFC3745_MAGIC, 12) == 0 ||
+                            memcmp(pData, JP2_MAGIC, 4) == 0)) {
+    ProbeJpeg2000(ctx, OPJ_CODEC_FORMAT::OPJ_CODEC_JP2);
+  } else if (IsHtJpeg2000Codestream(pData, size)) {
+    ProbeHtJpeg2000(ctx);
+  } else if (size >= 4 && memcmp(pData, J2K_CODESTREAM_MAGIC, 4) == 0) {
+    ProbeJpeg2000(ctx, OPJ_CODEC_FORMAT::OPJ_CODEC_J2K);
+  } else if (JxlSignatureCheck(pData, size) == JXL_SIG_CODESTREAM ||
+             JxlSignatureCheck(pData, size) == JXL_SIG_CONTAINER) {
+    ProbeJpegXlImpl(ctx);
+  } else {
+    ProbeRle(ctx);
+  }
 
-  DecodeJpegXlImpl(ctx, params);
+  DECODER_TRACE_EXIT(ctx);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void IndexHtJpeg2000(CodecsContext *ctx,
+                                          DecoderParameters *params) {
+  DECODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
+
+  Jpeg2000PacketIndex index;
+  BuildJpeg2000PacketIndex(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx),
+                           &index);
+
+  // The index is laid out in the decoded buffer as 32-bit words: the main
+  // header size, the tile-part and packet counts, then 4 words per tile-part
+  // (tile, offset, header size, size) and 7 words per packet (tile, tile-part,
+  // resolution, component, precinct, offset, size)
+  vector<uint32_t> words = {static_cast<uint32_t>(index.MainHeaderSize),
+                            static_cast<uint32_t>(index.TileParts.size()),
+                            static_cast<uint32_t>(index.Packets.size())};
+  words.reserve(3 + index.TileParts.size() * 4 + index.Packets.size() * 7);
+  for (auto const &tilePart : index.TileParts) {
+    words.insert(words.end(), {tilePart.Tile,
+                               static_cast<uint32_t>(tilePart.Offset),
+                               static_cast<uint32_t>(tilePart.HeaderSize),
+                               static_cast<uint32_t>(tilePart.Size)});
+  }
+  for (auto const &packet : index.Packets) {
+    words.insert(words.end(),
+                 {packet.Tile, packet.TilePart, packet.Resolution,
+                  packet.Component, packet.Precinct,
+                  static_cast<uint32_t>(packet.Offset),
+                  static_cast<uint32_t>(packet.Size)});
+  }
+  SetDecodedBufferSize(ctx, words.size() * sizeof(uint32_t));
+  memcpy(GetDecodedBuffer(ctx), words.data(), words.size() * sizeof(uint32_t));
 
   DECODER_TRACE_EXIT(ctx);
 }
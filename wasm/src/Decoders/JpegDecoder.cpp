@@ -1,5 +1,7 @@
 #include "JpegDecoder.h"
 
+#include <cstring>
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 uint16_t ReadUint16(uint8_t const *data) {
@@ -141,3 +143,67 @@ size_t ScanJpegDataForBitDepth(uint8_t const *data, size_t const nBytes) {
 
   return 0;
 }
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool ScanJpegDataForFrameHeader(uint8_t const *data, size_t const nBytes,
+                                JpegFrameHeader *header) {
+  if (data == nullptr || nBytes < 4 || ReadUint16(data) != 0xffd8) {
+    return false;
+  }
+
+  size_t offset = 2;
+  while ((offset + 4) <= nBytes) {
+    if (data[offset] != 0xff) {
+      return false;
+    }
+    auto const marker = ReadUint16(data + offset);
+    if (marker == 0xffff) {
+      offset += 1;
+      continue;
+    }
+    if (marker == 0xff01 || (marker >= 0xffd0 && marker <= 0xffd8)) {
+      offset += 2;
+      continue;
+    }
+    if (marker == 0xffd9 || marker == 0xffda) {
+      // The frame header has to precede the first scan
+      return false;
+    }
+
+    auto const length = static_cast<size_t>(ReadUint16(data + offset + 2));
+    if (length < 2 || (offset + 2 + length) > nBytes) {
+      return false;
+    }
+    auto const segment = data + offset + 4;
+
+    if (marker == 0xffee && length >= 14 && memcmp(segment, "Adobe", 5) == 0) {
+      header->AdobeTransform = segment[11];
+    }
+
+    auto const isFrameHeader = (marker >= 0xffc0 && marker <= 0xffcf &&
+                                marker != 0xffc4 && marker != 0xffc8 &&
+                                marker != 0xffcc) ||
+                               marker == 0xfff7;
+    if (isFrameHeader) {
+      if (length < 8) {
+        return false;
+      }
+      header->Marker = marker;
+      header->Precision = segment[0];
+      header->Rows = ReadUint16(segment + 1);
+      header->Columns = ReadUint16(segment + 3);
+      header->Components = segment[5];
+      if (header->Components == 3 && length >= 17) {
+        header->RgbComponentIds =
+            segment[6] == 'R' && segment[9] == 'G' && segment[12] == 'B';
+      }
+
+      return true;
+    }
+
+    offset += 2 + length;
+  }
+
+  return false;
+}
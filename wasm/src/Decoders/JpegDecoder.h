@@ -1,7 +1,27 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdio>
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 size_t ScanJpegDataForBitDepth(uint8_t const *data, size_t const nBytes);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegFrameHeader {
+  // SOFn marker (0xffc0 - 0xffcf), or SOF55 (0xfff7) for JPEG-LS
+  uint16_t Marker = 0;
+  size_t Precision = 0;
+  size_t Rows = 0;
+  size_t Columns = 0;
+  size_t Components = 0;
+  // Adobe APP14 transform flag, or -1 when the marker is absent
+  int AdobeTransform = -1;
+  bool RgbComponentIds = false;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool ScanJpegDataForFrameHeader(uint8_t const *data, size_t const nBytes,
+                                JpegFrameHeader *header);
@@ -16,60 +16,85 @@ using namespace std;
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void DecodeJpeg12(CodecsContext *ctx, DecoderParameters *params) {
-  jpeg_error_mgr jerr;
+struct JpegDecoderSession12 : public CodecSession {
+  JpegDecoderSession12() {
+    dinfo.err = jpeg_std_error(&jerr);
+    dinfo.err->error_exit = [](j_common_ptr dinfo) {
+      char buf[JMSG_LENGTH_MAX];
+      (*dinfo->err->format_message)(dinfo, buf);
+      ThrowCodecsException("JpegDecoder12::ErrorExit::" + string(buf));
+    };
+    dinfo.err->output_message = [](j_common_ptr dinfo) {
+      char buf[JMSG_LENGTH_MAX];
+      (*dinfo->err->format_message)(dinfo, buf);
+      OutputCodecsInfo("JpegDecoder12::OutputMessage::" + string(buf));
+    };
+    dinfo.err->emit_message = [](j_common_ptr dinfo, int messageLevel) {
+      char buf[JMSG_LENGTH_MAX];
+      (*dinfo->err->format_message)(dinfo, buf);
+      OutputCodecsInfo("JpegDecoder12::EmitMessage::" + string(buf));
+    };
+    jpeg_create_decompress(&dinfo);
 
-  jpeg_decompress_struct dinfo;
-  dinfo.err = jpeg_std_error(&jerr);
-  dinfo.err->error_exit = [](j_common_ptr dinfo) {
-    char buf[JMSG_LENGTH_MAX];
-    (*dinfo->err->format_message)(dinfo, buf);
-    ThrowCodecsException("JpegDecoder12::ErrorExit::" + string(buf));
-  };
-  dinfo.err->output_message = [](j_common_ptr dinfo) {
-    char buf[JMSG_LENGTH_MAX];
-    (*dinfo->err->format_message)(dinfo, buf);
-    OutputCodecsInfo("JpegDecoder12::OutputMessage::" + string(buf));
-  };
-  dinfo.err->emit_message = [](j_common_ptr dinfo, int messageLevel) {
-    char buf[JMSG_LENGTH_MAX];
-    (*dinfo->err->format_message)(dinfo, buf);
-    OutputCodecsInfo("JpegDecoder12::EmitMessage::" + string(buf));
-  };
-  jpeg_create_decompress(&dinfo);
+    memset(&src, 0, sizeof(src));
+    src.init_source = [](j_decompress_ptr dinfo) {};
+    src.fill_input_buffer = [](j_decompress_ptr dinfo) -> boolean {
+      static uint8_t buf[4] = {0xff, 0xd9, 0, 0};
+      dinfo->src->next_input_byte = buf;
+      dinfo->src->bytes_in_buffer = 2;
 
-  jpeg_source_mgr src;
-  memset(&src, 0, sizeof(src));
-
-  src.init_source = [](j_decompress_ptr dinfo) {};
-  src.fill_input_buffer = [](j_decompress_ptr dinfo) -> boolean {
-    static uint8_t buf[4] = {0xff, 0xd9, 0, 0};
-    dinfo->src->next_input_byte = buf;
-    dinfo->src->bytes_in_buffer = 2;
-
-    return TRUE;
-  };
-  src.skip_input_data = [](j_decompress_ptr dinfo, long nBytes) {
-    auto &src = *dinfo->src;
-    if (nBytes > 0) {
-      while (nBytes > static_cast<long>(src.bytes_in_buffer)) {
-        nBytes -= static_cast<long>(src.bytes_in_buffer);
-        (*src.fill_input_buffer)(dinfo);
+      return TRUE;
+    };
+    src.skip_input_data = [](j_decompress_ptr dinfo, long nBytes) {
+      auto &src = *dinfo->src;
+      if (nBytes > 0) {
+        while (nBytes > static_cast<long>(src.bytes_in_buffer)) {
+          nBytes -= static_cast<long>(src.bytes_in_buffer);
+          (*src.fill_input_buffer)(dinfo);
+        }
+        src.next_input_byte += nBytes;
+        src.bytes_in_buffer -= static_cast<size_t>(nBytes);
       }
-      src.next_input_byte += nBytes;
-      src.bytes_in_buffer -= static_cast<size_t>(nBytes);
-    }
-  };
-  src.resync_to_restart = jpeg_resync_to_restart;
-  src.term_source = [](j_decompress_ptr) {};
-  src.bytes_in_buffer = GetEncodedBufferSize(ctx);
-  src.next_input_byte = GetEncodedBuffer(ctx);
-  dinfo.src = &src;
-
-  if (jpeg_read_header(&dinfo, TRUE) == JPEG_SUSPENDED) {
+    };
+    src.resync_to_restart = jpeg_resync_to_restart;
+    src.term_source = [](j_decompress_ptr) {};
+    dinfo.src = &src;
+  }
+
+  ~JpegDecoderSession12() override { jpeg_destroy_decompress(&dinfo); }
+
+  jpeg_error_mgr jerr;
+  jpeg_source_mgr src;
+  jpeg_decompress_struct dinfo;
+  vector<JSAMPLE *> rows;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeJpeg12(CodecsContext *ctx, DecoderParameters *params) {
+  auto session = GetCodecSession<JpegDecoderSession12>(ctx->DecoderSession);
+  auto &dinfo = session->dinfo;
+
+  // Returns the decompressor to its idle state, in case the previous frame
+  // failed mid-way. Tables loaded by earlier frames are retained, which allows
+  // abbreviated (image-only) datastreams to be decoded.
+  jpeg_abort_decompress(&dinfo);
+  session->src.bytes_in_buffer = GetEncodedBufferSize(ctx);
+  session->src.next_input_byte = GetEncodedBuffer(ctx);
+
+  // A tables-only datastream may precede the image datastream
+  auto ret = jpeg_read_header(&dinfo, FALSE);
+  while (ret == JPEG_HEADER_TABLES_ONLY && session->src.bytes_in_buffer > 2) {
+    ret = jpeg_read_header(&dinfo, FALSE);
+  }
+  if (ret == JPEG_SUSPENDED) {
     ThrowCodecsException(
         "JpegDecoder12::DecodeJpeg12::jpeg_read_header::Suspended");
   }
+  if (ret != JPEG_HEADER_OK) {
+    ThrowCodecsException(
+        "JpegDecoder12::DecodeJpeg12::jpeg_read_header::No image");
+  }
 
   if (params->ConvertColorspaceToRgb && (dinfo.out_color_space == JCS_YCbCr ||
                                          dinfo.out_color_space == JCS_RGB)) {
@@ -98,7 +123,7 @@ void DecodeJpeg12(CodecsContext *ctx, DecoderParameters *params) {
 
   jpeg_start_decompress(&dinfo);
 
-  vector<JSAMPLE *> rows;
+  auto &rows = session->rows;
   auto const scanlineBytes = dinfo.image_width * bytesAllocated *
                              static_cast<size_t>(dinfo.num_components);
   auto pDecodedBuffer = GetDecodedBuffer(ctx);
@@ -116,6 +141,6 @@ void DecodeJpeg12(CodecsContext *ctx, DecoderParameters *params) {
     pDecodedBuffer += scanlineBytes * n;
   }
 
+  // Leaves the decompressor idle, ready for the next frame of the session
   jpeg_finish_decompress(&dinfo);
-  jpeg_destroy_decompress(&dinfo);
 }
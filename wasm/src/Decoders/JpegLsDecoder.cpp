@@ -0,0 +1,77 @@
+#include "JpegLsDecoder.h"
+
+#include <charls/charls.h>
+
+#include <memory>
+#include <string>
+
+#include "Exception.h"
+
+using namespace std;
+using namespace charls;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ThrowIfJpegLsDecoderFailed(string const &call,
+                                       jpegls_errc const errc) {
+  if (errc != jpegls_errc::success) {
+    ThrowCodecsException("DecodeJpegLs::" + call +
+                         "::" + string(charls_get_error_message(errc)));
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeJpegLsImpl(CodecsContext *ctx, DecoderParameters *params) {
+  // A CharLS 2.3 decoder accepts a single source buffer, so it lives for one
+  // frame. The header is parsed once and reused for the destination size.
+  unique_ptr<charls_jpegls_decoder, decltype(&charls_jpegls_decoder_destroy)>
+      decoder(charls_jpegls_decoder_create(), &charls_jpegls_decoder_destroy);
+  if (!decoder) {
+    ThrowCodecsException(
+        "DecodeJpegLs::charls_jpegls_decoder_create::Failed to create decoder");
+  }
+
+  ThrowIfJpegLsDecoderFailed(
+      "charls_jpegls_decoder_set_source_buffer",
+      charls_jpegls_decoder_set_source_buffer(
+          decoder.get(), GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx)));
+  ThrowIfJpegLsDecoderFailed("charls_jpegls_decoder_read_header",
+                             charls_jpegls_decoder_read_header(decoder.get()));
+
+  charls_frame_info frameInfo = {};
+  ThrowIfJpegLsDecoderFailed(
+      "charls_jpegls_decoder_get_frame_info",
+      charls_jpegls_decoder_get_frame_info(decoder.get(), &frameInfo));
+  auto interleaveMode = interleave_mode::none;
+  ThrowIfJpegLsDecoderFailed("charls_jpegls_decoder_get_interleave_mode",
+                             charls_jpegls_decoder_get_interleave_mode(
+                                 decoder.get(), &interleaveMode));
+
+  // Non-interleaved scans are written plane by plane, straight into the
+  // decoded buffer, and reported as planar.
+  auto const components = static_cast<size_t>(frameInfo.component_count);
+  auto const isPlanar =
+      interleaveMode == interleave_mode::none && components > 1;
+  auto const bytesPerSample = (frameInfo.bits_per_sample / 8) +
+                              (frameInfo.bits_per_sample % 8 == 0 ? 0 : 1);
+  auto const stride = static_cast<uint32_t>(
+      frameInfo.width * bytesPerSample * (isPlanar ? 1 : components));
+
+  size_t destinationSize = 0;
+  ThrowIfJpegLsDecoderFailed("charls_jpegls_decoder_get_destination_size",
+                             charls_jpegls_decoder_get_destination_size(
+                                 decoder.get(), stride, &destinationSize));
+  ctx->DecodedBuffer.Resize(destinationSize);
+
+  ThrowIfJpegLsDecoderFailed("charls_jpegls_decoder_decode_to_buffer",
+                             charls_jpegls_decoder_decode_to_buffer(
+                                 decoder.get(), GetDecodedBuffer(ctx),
+                                 destinationSize, stride));
+
+  if (components > 1) {
+    SetPlanarConfiguration(ctx, isPlanar
+                                    ? +PlanarConfigurationEnum::Planar
+                                    : +PlanarConfigurationEnum::Interleaved);
+  }
+}
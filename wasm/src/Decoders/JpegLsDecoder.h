@@ -0,0 +1,8 @@
+#pragma once
+
+#include "CodecsContext.h"
+#include "DecoderParameters.h"
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeJpegLsImpl(CodecsContext *ctx, DecoderParameters *params);
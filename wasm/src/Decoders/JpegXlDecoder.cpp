@@ -1,10 +1,13 @@
 #include "JpegXlDecoder.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <vector>
 
+#include "CodecsArena.h"
 #include "Exception.h"
-#include "jxl/cms.h"
+#include "JpegXlParallelRunner.h"
 #include "jxl/decode.h"
 #include "jxl/types.h"
 
@@ -12,86 +15,223 @@ using namespace std;
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void DecodeJpegXlImpl(CodecsContext* ctx, DecoderParameters* params) {
-  auto const* encodedBuffer = GetEncodedBuffer(ctx);
-  auto const encodedSize = GetEncodedBufferSize(ctx);
+struct JpegXlDecoderSession : public CodecSession {
+  ~JpegXlDecoderSession() override {
+    ResetIncremental();
+    if (FrameDecoder) {
+      JxlDecoderDestroy(FrameDecoder);
+    }
+  }
 
-  auto* dec = JxlDecoderCreate(nullptr);
-  if (!dec) {
-    ThrowCodecsException(
-        "DecodeJpegXl::JxlDecoderCreate::Failed to create decoder");
+  JpegXlParallelRunner Runner;
+
+  // Whole-frame decoder, reset between the frames of the session
+  JxlDecoder* FrameDecoder = nullptr;
+
+  // Incremental decoding state, kept until the frame is complete
+  JxlDecoder* Decoder = nullptr;
+  vector<uint8_t> Input;
+  vector<uint8_t> Pixels;
+  JxlBasicInfo BasicInfo = {};
+  JxlPixelFormat PixelFormat = {};
+  bool Linearize = false;
+  bool HasImageOutBuffer = false;
+
+  void ResetIncremental() {
+    if (Decoder) {
+      JxlDecoderDestroy(Decoder);
+      Decoder = nullptr;
+    }
+    Input.clear();
+    HasImageOutBuffer = false;
   }
+};
 
-  if (JxlDecoderSetCms(dec, *JxlGetDefaultCms()) != JXL_DEC_SUCCESS) {
-    JxlDecoderDestroy(dec);
-    ThrowCodecsException("DecodeJpegXl::JxlDecoderSetCms::Failed");
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static JxlDecoder* ResetJpegXlFrameDecoder(JpegXlDecoderSession* session,
+                                           size_t const threadCount,
+                                           string const& name) {
+  // The decoder is created once per session and only rewound for the next
+  // frame. It outlives the call, so it stays on the general heap rather than
+  // on the codecs arena.
+  if (session->FrameDecoder) {
+    JxlDecoderReset(session->FrameDecoder);
+  } else {
+    session->FrameDecoder = JxlDecoderCreate(nullptr);
+    if (!session->FrameDecoder) {
+      ThrowCodecsException(name +
+                           "::JxlDecoderCreate::Failed to create decoder");
+    }
+  }
+
+  // JxlDecoderReset also detaches the parallel runner
+  if (!session->Runner.Attach(session->FrameDecoder, threadCount)) {
+    ThrowCodecsException(name + "::JxlDecoderSetParallelRunner::Failed");
   }
 
+  return session->FrameDecoder;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void SetJpegXlPixelFormat(JxlPixelFormat* pixelFormat,
+                                 JxlBasicInfo const& basicInfo,
+                                 int32_t const outputColorSpace) {
+  pixelFormat->num_channels = basicInfo.num_color_channels;
+  if (outputColorSpace != 0) {
+    pixelFormat->data_type = JXL_TYPE_FLOAT;
+  } else {
+    pixelFormat->data_type =
+        basicInfo.bits_per_sample <= 8 ? JXL_TYPE_UINT8 : JXL_TYPE_UINT16;
+  }
+  pixelFormat->endianness = JXL_NATIVE_ENDIAN;
+  pixelFormat->align = 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static bool SetJpegXlOutputColorProfile(JxlDecoder* dec,
+                                        JxlBasicInfo const& basicInfo,
+                                        int32_t const outputColorSpace,
+                                        bool* linearize) {
+  *linearize = false;
+
+  // libjxl only converts colours in the inverse XYB transform of lossy
+  // frames. Frames stored with their original profile, which includes all
+  // the frames written by EncodeJpegXl, come out as stored whatever output
+  // profile is set, so neither the CMS nor an output profile is attached.
+  if (basicInfo.uses_original_profile) {
+    if (outputColorSpace != 1) {
+      return outputColorSpace == 0;
+    }
+
+    // Linear output is done here for sRGB samples
+    JxlColorEncoding encoding = {};
+    if (JxlDecoderGetColorAsEncodedProfile(
+            dec, JXL_COLOR_PROFILE_TARGET_ORIGINAL, &encoding) !=
+        JXL_DEC_SUCCESS) {
+      return false;
+    }
+    *linearize = encoding.transfer_function == JXL_TRANSFER_FUNCTION_SRGB;
+
+    return *linearize ||
+           encoding.transfer_function == JXL_TRANSFER_FUNCTION_LINEAR;
+  }
+
+  auto const gray = basicInfo.num_color_channels < 3;
+  // Grayscale frames are returned as stored unless linear output is asked
+  if (gray && outputColorSpace != 1) {
+    return outputColorSpace == 0;
+  }
+
+  JxlColorEncoding target = {};
+  target.color_space = gray ? JXL_COLOR_SPACE_GRAY : JXL_COLOR_SPACE_RGB;
+  target.white_point = JXL_WHITE_POINT_D65;
+  target.primaries = JXL_PRIMARIES_SRGB;
+  target.transfer_function = outputColorSpace == 0
+                                 ? JXL_TRANSFER_FUNCTION_SRGB
+                                 : JXL_TRANSFER_FUNCTION_LINEAR;
+  target.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
+  if (outputColorSpace == 2) {
+    // libjxl only describes XYB with the perceptual intent
+    target.color_space = JXL_COLOR_SPACE_XYB;
+    target.rendering_intent = JXL_RENDERING_INTENT_PERCEPTUAL;
+  }
+
+  // Nothing to do if the pixels already come out in the target encoding
+  JxlColorEncoding encoding = {};
+  if (JxlDecoderGetColorAsEncodedProfile(dec, JXL_COLOR_PROFILE_TARGET_DATA,
+                                         &encoding) == JXL_DEC_SUCCESS &&
+      encoding.color_space == target.color_space &&
+      encoding.white_point == target.white_point &&
+      (gray || encoding.primaries == target.primaries) &&
+      encoding.transfer_function == target.transfer_function) {
+    return true;
+  }
+
+  // Without a CMS, the inverse XYB transform writes any encoded target
+  // directly, whatever the embedded profile (ICC included). With one, libjxl
+  // would run an extra per-pixel CMS pass from linear to the target.
+  return JxlDecoderSetOutputColorProfile(dec, &target, nullptr, 0) ==
+         JXL_DEC_SUCCESS;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void LinearizeJpegXlSrgbSamples(uint8_t* pixels, size_t const size,
+                                       uint32_t const bitsPerSample) {
+  // The float samples of frames stored as integers are exact multiples of
+  // 1 / maxValue, so a table over the integer values is enough
+  auto const maxValue = (1u << bitsPerSample) - 1;
+  vector<float> table(maxValue + 1);
+  for (size_t i = 0; i <= maxValue; i++) {
+    auto const v = static_cast<double>(i) / maxValue;
+    table[i] = static_cast<float>(
+        v <= 0.04045 ? v / 12.92 : pow((v + 0.055) / 1.055, 2.4));
+  }
+
+  auto* samples = reinterpret_cast<float*>(pixels);
+  for (size_t i = 0; i < size / sizeof(float); i++) {
+    auto const index = lround(clamp(samples[i], 0.0f, 1.0f) * maxValue);
+    samples[i] = table[index];
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeJpegXlImpl(CodecsContext* ctx, DecoderParameters* params) {
+  auto session = GetCodecSession<JpegXlDecoderSession>(ctx->DecoderSession);
+  auto const* encodedBuffer = GetEncodedBuffer(ctx);
+  auto const encodedSize = GetEncodedBufferSize(ctx);
+
+  auto* dec =
+      ResetJpegXlFrameDecoder(session, params->ThreadCount, "DecodeJpegXl");
+
   if (JxlDecoderSubscribeEvents(dec,
                                 JXL_DEC_BASIC_INFO | JXL_DEC_COLOR_ENCODING |
                                     JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS) {
-    JxlDecoderDestroy(dec);
     ThrowCodecsException("DecodeJpegXl::JxlDecoderSubscribeEvents::Failed");
   }
 
   if (JxlDecoderSetInput(dec, encodedBuffer, encodedSize) != JXL_DEC_SUCCESS) {
-    JxlDecoderDestroy(dec);
     ThrowCodecsException("DecodeJpegXl::JxlDecoderSetInput::Failed");
   }
   JxlDecoderCloseInput(dec);
 
+  JxlBasicInfo basicInfo = {};
   JxlPixelFormat pixelFormat = {};
   vector<uint8_t> decodedPixels;
-  size_t samplesPerPixel = 0;
+  auto linearize = false;
 
   for (;;) {
     auto const status = JxlDecoderProcessInput(dec);
 
     if (status == JXL_DEC_ERROR) {
-      JxlDecoderDestroy(dec);
       ThrowCodecsException(
           "DecodeJpegXl::JxlDecoderProcessInput::Decoding failed");
     }
 
     if (status == JXL_DEC_NEED_MORE_INPUT) {
-      JxlDecoderDestroy(dec);
       ThrowCodecsException(
           "DecodeJpegXl::JxlDecoderProcessInput::Unexpected end of input");
     }
 
     if (status == JXL_DEC_BASIC_INFO) {
-      JxlBasicInfo basicInfo;
       if (JxlDecoderGetBasicInfo(dec, &basicInfo) != JXL_DEC_SUCCESS) {
-        JxlDecoderDestroy(dec);
         ThrowCodecsException("DecodeJpegXl::JxlDecoderGetBasicInfo::Failed");
       }
 
-      auto const bitsStored = static_cast<size_t>(basicInfo.bits_per_sample);
-      auto const bitsAllocated = bitsStored <= 8 ? 8u : 16u;
-      samplesPerPixel = static_cast<size_t>(basicInfo.num_color_channels);
-
-      pixelFormat.num_channels = static_cast<uint32_t>(samplesPerPixel);
-      pixelFormat.data_type =
-          bitsAllocated <= 8 ? JXL_TYPE_UINT8 : JXL_TYPE_UINT16;
-      pixelFormat.endianness = JXL_NATIVE_ENDIAN;
-      pixelFormat.align = 0;
+      SetJpegXlPixelFormat(&pixelFormat, basicInfo, params->OutputColorSpace);
       continue;
     }
 
     if (status == JXL_DEC_COLOR_ENCODING) {
-      if (samplesPerPixel > 1) {
-        JxlColorEncoding srgb = {};
-        srgb.color_space = JXL_COLOR_SPACE_RGB;
-        srgb.white_point = JXL_WHITE_POINT_D65;
-        srgb.primaries = JXL_PRIMARIES_SRGB;
-        srgb.transfer_function = JXL_TRANSFER_FUNCTION_SRGB;
-        srgb.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
-        if (JxlDecoderSetOutputColorProfile(dec, &srgb, nullptr, 0) !=
-            JXL_DEC_SUCCESS) {
-          JxlDecoderDestroy(dec);
-          ThrowCodecsException(
-              "DecodeJpegXl::JxlDecoderSetOutputColorProfile::Failed");
-        }
+      if (!SetJpegXlOutputColorProfile(dec, basicInfo, params->OutputColorSpace,
+                                       &linearize)) {
+        ThrowCodecsException(
+            "DecodeJpegXl::JxlDecoderSetOutputColorProfile::Output color "
+            "space not available for this frame");
       }
       continue;
     }
@@ -100,7 +240,6 @@ void DecodeJpegXlImpl(CodecsContext* ctx, DecoderParameters* params) {
       size_t bufferSize = 0;
       if (JxlDecoderImageOutBufferSize(dec, &pixelFormat, &bufferSize) !=
           JXL_DEC_SUCCESS) {
-        JxlDecoderDestroy(dec);
         ThrowCodecsException(
             "DecodeJpegXl::JxlDecoderImageOutBufferSize::Failed");
       }
@@ -109,7 +248,6 @@ void DecodeJpegXlImpl(CodecsContext* ctx, DecoderParameters* params) {
       if (JxlDecoderSetImageOutBuffer(dec, &pixelFormat, decodedPixels.data(),
                                       decodedPixels.size()) !=
           JXL_DEC_SUCCESS) {
-        JxlDecoderDestroy(dec);
         ThrowCodecsException(
             "DecodeJpegXl::JxlDecoderSetImageOutBuffer::Failed");
       }
@@ -124,14 +262,325 @@ void DecodeJpegXlImpl(CodecsContext* ctx, DecoderParameters* params) {
       break;
     }
 
-    JxlDecoderDestroy(dec);
     ThrowCodecsException(
         "DecodeJpegXl::JxlDecoderProcessInput::Unexpected status");
   }
 
-  JxlDecoderDestroy(dec);
+  if (linearize) {
+    LinearizeJpegXlSrgbSamples(decodedPixels.data(), decodedPixels.size(),
+                               basicInfo.bits_per_sample);
+  }
 
   auto const decodedSize = decodedPixels.size();
   SetDecodedBufferSize(ctx, decodedSize);
   memcpy(GetDecodedBuffer(ctx), decodedPixels.data(), decodedSize);
 }
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void TranscodeJpegXlToJpegImpl(CodecsContext* ctx, DecoderParameters* params) {
+  auto session = GetCodecSession<JpegXlDecoderSession>(ctx->DecoderSession);
+  auto const* encodedBuffer = GetEncodedBuffer(ctx);
+  auto const encodedSize = GetEncodedBufferSize(ctx);
+
+  auto* dec = ResetJpegXlFrameDecoder(session, params->ThreadCount,
+                                      "TranscodeJpegXlToJpeg");
+
+  if (JxlDecoderSubscribeEvents(
+          dec, JXL_DEC_JPEG_RECONSTRUCTION | JXL_DEC_FULL_IMAGE) !=
+      JXL_DEC_SUCCESS) {
+    ThrowCodecsException(
+        "TranscodeJpegXlToJpeg::JxlDecoderSubscribeEvents::Failed");
+  }
+
+  if (JxlDecoderSetInput(dec, encodedBuffer, encodedSize) != JXL_DEC_SUCCESS) {
+    ThrowCodecsException("TranscodeJpegXlToJpeg::JxlDecoderSetInput::Failed");
+  }
+  JxlDecoderCloseInput(dec);
+
+  // The reconstructed JPEG is usually somewhat larger than the JPEG-XL
+  // codestream
+  vector<uint8_t> jpegData(max<size_t>(encodedSize * 2, 65536));
+
+  for (;;) {
+    auto const status = JxlDecoderProcessInput(dec);
+
+    if (status == JXL_DEC_ERROR) {
+      ThrowCodecsException(
+          "TranscodeJpegXlToJpeg::JxlDecoderProcessInput::Decoding failed");
+    }
+
+    if (status == JXL_DEC_NEED_MORE_INPUT) {
+      ThrowCodecsException(
+          "TranscodeJpegXlToJpeg::JxlDecoderProcessInput::Unexpected end of "
+          "input");
+    }
+
+    if (status == JXL_DEC_JPEG_RECONSTRUCTION) {
+      if (JxlDecoderSetJPEGBuffer(dec, jpegData.data(), jpegData.size()) !=
+          JXL_DEC_SUCCESS) {
+        ThrowCodecsException(
+            "TranscodeJpegXlToJpeg::JxlDecoderSetJPEGBuffer::Failed");
+      }
+      continue;
+    }
+
+    if (status == JXL_DEC_JPEG_NEED_MORE_OUTPUT) {
+      // The JPEG buffer always spans up to the end of the vector
+      auto const used = jpegData.size() - JxlDecoderReleaseJPEGBuffer(dec);
+      jpegData.resize(jpegData.size() * 2);
+      if (JxlDecoderSetJPEGBuffer(dec, jpegData.data() + used,
+                                  jpegData.size() - used) != JXL_DEC_SUCCESS) {
+        ThrowCodecsException(
+            "TranscodeJpegXlToJpeg::JxlDecoderSetJPEGBuffer::Failed");
+      }
+      continue;
+    }
+
+    if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+      // Only raised if the codestream has no JPEG reconstruction data
+      ThrowCodecsException(
+          "TranscodeJpegXlToJpeg::JxlDecoderProcessInput::No JPEG "
+          "reconstruction data");
+    }
+
+    if (status == JXL_DEC_FULL_IMAGE) {
+      continue;
+    }
+
+    if (status == JXL_DEC_SUCCESS) {
+      break;
+    }
+
+    ThrowCodecsException(
+        "TranscodeJpegXlToJpeg::JxlDecoderProcessInput::Unexpected status");
+  }
+
+  auto const jpegDataSize = jpegData.size() - JxlDecoderReleaseJPEGBuffer(dec);
+
+  SetEncodedBufferSize(ctx, jpegDataSize);
+  memcpy(GetEncodedBuffer(ctx), jpegData.data(), jpegDataSize);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void ProbeJpegXlImpl(CodecsContext* ctx) {
+  auto* dec = JxlDecoderCreate(GetCodecsArenaJxlMemoryManager());
+  if (!dec) {
+    ThrowCodecsException(
+        "ProbeJpegXl::JxlDecoderCreate::Failed to create decoder");
+  }
+
+  // Only the basic info event is subscribed, so the decoder stops right after
+  // the image header and no pixel buffers are needed
+  if (JxlDecoderSubscribeEvents(dec, JXL_DEC_BASIC_INFO) != JXL_DEC_SUCCESS) {
+    JxlDecoderDestroy(dec);
+    ThrowCodecsException("ProbeJpegXl::JxlDecoderSubscribeEvents::Failed");
+  }
+
+  if (JxlDecoderSetInput(dec, GetEncodedBuffer(ctx),
+                         GetEncodedBufferSize(ctx)) != JXL_DEC_SUCCESS) {
+    JxlDecoderDestroy(dec);
+    ThrowCodecsException("ProbeJpegXl::JxlDecoderSetInput::Failed");
+  }
+  JxlDecoderCloseInput(dec);
+
+  JxlBasicInfo basicInfo;
+  if (JxlDecoderProcessInput(dec) != JXL_DEC_BASIC_INFO ||
+      JxlDecoderGetBasicInfo(dec, &basicInfo) != JXL_DEC_SUCCESS) {
+    JxlDecoderDestroy(dec);
+    ThrowCodecsException(
+        "ProbeJpegXl::JxlDecoderGetBasicInfo::Failed to read the header");
+  }
+  JxlDecoderDestroy(dec);
+
+  auto const bitsStored = static_cast<size_t>(basicInfo.bits_per_sample);
+  SetColumns(ctx, basicInfo.xsize);
+  SetRows(ctx, basicInfo.ysize);
+  SetBitsStored(ctx, bitsStored);
+  SetBitsAllocated(ctx, bitsStored <= 8 ? 8 : 16);
+  SetSamplesPerPixel(ctx, basicInfo.num_color_channels);
+  // Lossy frames are stored in the XYB colour space
+  ctx->ColorTransform = !basicInfo.uses_original_profile;
+  ctx->TileWidth = basicInfo.xsize;
+  ctx->TileHeight = basicInfo.ysize;
+  ctx->DecompositionLevels = 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ThrowJpegXlIncrementalException(JpegXlDecoderSession* session,
+                                            string const& message) {
+  session->ResetIncremental();
+  ThrowCodecsException("DecodeJpegXlIncremental::" + message);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void CreateJpegXlIncrementalDecoder(JpegXlDecoderSession* session,
+                                           DecoderParameters* params) {
+  // The decoder outlives the call, so it stays on the general heap rather
+  // than on the codecs arena
+  session->Decoder = JxlDecoderCreate(nullptr);
+  if (!session->Decoder) {
+    ThrowJpegXlIncrementalException(
+        session, "JxlDecoderCreate::Failed to create decoder");
+  }
+  auto* dec = session->Decoder;
+
+  if (!session->Runner.Attach(dec, params->ThreadCount)) {
+    ThrowJpegXlIncrementalException(session,
+                                    "JxlDecoderSetParallelRunner::Failed");
+  }
+
+  if (JxlDecoderSubscribeEvents(
+          dec, JXL_DEC_BASIC_INFO | JXL_DEC_COLOR_ENCODING |
+                   JXL_DEC_FRAME_PROGRESSION | JXL_DEC_FULL_IMAGE) !=
+      JXL_DEC_SUCCESS) {
+    ThrowJpegXlIncrementalException(session,
+                                    "JxlDecoderSubscribeEvents::Failed");
+  }
+
+  // Reports the DC (1:8) pass and every further pass of the frame
+  if (JxlDecoderSetProgressiveDetail(dec, kPasses) != JXL_DEC_SUCCESS) {
+    ThrowJpegXlIncrementalException(session,
+                                    "JxlDecoderSetProgressiveDetail::Failed");
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void CopyJpegXlIncrementalPixels(CodecsContext* ctx,
+                                        JpegXlDecoderSession* session) {
+  // The decoder keeps writing into the session pixels, so the linear
+  // conversion is done on the copy
+  ctx->DecodedBuffer.Resize(session->Pixels.size());
+  memcpy(ctx->DecodedBuffer.GetData(), session->Pixels.data(),
+         session->Pixels.size());
+  if (session->Linearize) {
+    LinearizeJpegXlSrgbSamples(ctx->DecodedBuffer.GetData(),
+                               session->Pixels.size(),
+                               session->BasicInfo.bits_per_sample);
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeJpegXlIncrementalImpl(CodecsContext* ctx,
+                                 DecoderParameters* params) {
+  auto session = GetCodecSession<JpegXlDecoderSession>(ctx->DecoderSession);
+  if (!session->Decoder) {
+    CreateJpegXlIncrementalDecoder(session, params);
+  }
+  auto* dec = session->Decoder;
+
+  // The bytes left over by the previous call are given again, followed by
+  // the newly arrived ones
+  auto const* encodedBuffer = GetEncodedBuffer(ctx);
+  session->Input.insert(session->Input.end(), encodedBuffer,
+                        encodedBuffer + GetEncodedBufferSize(ctx));
+  if (JxlDecoderSetInput(dec, session->Input.data(), session->Input.size()) !=
+      JXL_DEC_SUCCESS) {
+    ThrowJpegXlIncrementalException(session, "JxlDecoderSetInput::Failed");
+  }
+
+  for (;;) {
+    auto const status = JxlDecoderProcessInput(dec);
+
+    if (status == JXL_DEC_ERROR) {
+      ThrowJpegXlIncrementalException(
+          session, "JxlDecoderProcessInput::Decoding failed");
+    }
+
+    if (status == JXL_DEC_NEED_MORE_INPUT) {
+      auto const remaining = JxlDecoderReleaseInput(dec);
+      session->Input.erase(session->Input.begin(),
+                           session->Input.end() - remaining);
+
+      // Renders the best approximation available so far, which is empty
+      // until the DC of the frame has arrived
+      ctx->DecodingComplete = false;
+      if (session->HasImageOutBuffer &&
+          JxlDecoderFlushImage(dec) == JXL_DEC_SUCCESS) {
+        ctx->DownsamplingRatio = JxlDecoderGetIntendedDownsamplingRatio(dec);
+        CopyJpegXlIncrementalPixels(ctx, session);
+      } else {
+        ctx->DownsamplingRatio = 0;
+        ctx->DecodedBuffer.Resize(0);
+      }
+      return;
+    }
+
+    if (status == JXL_DEC_BASIC_INFO) {
+      auto& basicInfo = session->BasicInfo;
+      if (JxlDecoderGetBasicInfo(dec, &basicInfo) != JXL_DEC_SUCCESS) {
+        ThrowJpegXlIncrementalException(session,
+                                        "JxlDecoderGetBasicInfo::Failed");
+      }
+
+      auto const bitsStored = static_cast<size_t>(basicInfo.bits_per_sample);
+      auto const bitsAllocated = bitsStored <= 8 ? 8u : 16u;
+
+      SetColumns(ctx, basicInfo.xsize);
+      SetRows(ctx, basicInfo.ysize);
+      SetBitsAllocated(ctx, bitsAllocated);
+      SetBitsStored(ctx, bitsStored);
+      SetSamplesPerPixel(ctx, basicInfo.num_color_channels);
+      SetJpegXlPixelFormat(&session->PixelFormat, basicInfo,
+                           params->OutputColorSpace);
+      continue;
+    }
+
+    if (status == JXL_DEC_COLOR_ENCODING) {
+      if (!SetJpegXlOutputColorProfile(dec, session->BasicInfo,
+                                       params->OutputColorSpace,
+                                       &session->Linearize)) {
+        ThrowJpegXlIncrementalException(
+            session,
+            "JxlDecoderSetOutputColorProfile::Output color space not "
+            "available for this frame");
+      }
+      continue;
+    }
+
+    if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
+      size_t bufferSize = 0;
+      if (JxlDecoderImageOutBufferSize(dec, &session->PixelFormat,
+                                       &bufferSize) != JXL_DEC_SUCCESS) {
+        ThrowJpegXlIncrementalException(session,
+                                        "JxlDecoderImageOutBufferSize::Failed");
+      }
+
+      // The decoder writes into this buffer across calls, so it must not be
+      // reallocated until the frame is complete
+      session->Pixels.resize(bufferSize);
+      if (JxlDecoderSetImageOutBuffer(dec, &session->PixelFormat,
+                                      session->Pixels.data(),
+                                      session->Pixels.size()) !=
+          JXL_DEC_SUCCESS) {
+        ThrowJpegXlIncrementalException(session,
+                                        "JxlDecoderSetImageOutBuffer::Failed");
+      }
+      session->HasImageOutBuffer = true;
+      continue;
+    }
+
+    if (status == JXL_DEC_FRAME_PROGRESSION) {
+      continue;
+    }
+
+    if (status == JXL_DEC_FULL_IMAGE || status == JXL_DEC_SUCCESS) {
+      break;
+    }
+
+    ThrowJpegXlIncrementalException(
+        session, "JxlDecoderProcessInput::Unexpected status");
+  }
+
+  // A single frame per DICOM frame is expected, so the full image ends the
+  // decoding and the next call starts over with a new frame
+  ctx->DecodingComplete = true;
+  ctx->DownsamplingRatio = 1;
+  CopyJpegXlIncrementalPixels(ctx, session);
+  session->ResetIncremental();
+}
@@ -1,6 +1,8 @@
 #include "RleDecoder.h"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "Exception.h"
 
@@ -57,13 +59,12 @@ RleDecoder::RleDecoder(uint8_t const *data, int32_t const size)
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-RleDecoder::~RleDecoder() { delete offsets_; }
+RleDecoder::~RleDecoder() { delete[] offsets_; }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void RleDecoder::DecodeSegment(const int32_t segment, uint8_t *buffer,
-                               const int32_t size, const int32_t start,
-                               const int32_t sampleOffset) {
+                               const int32_t size) {
   if (segment < 0 || segment >= segmentCount_) {
     ThrowCodecsException(
         "RleDecoder::DecodeSegment::Segment number out of range (" +
@@ -71,63 +72,58 @@ void RleDecoder::DecodeSegment(const int32_t segment, uint8_t *buffer,
   }
   auto const offset = GetSegmentOffset(segment);
   auto const length = GetSegmentLength(segment);
-  Decode(buffer, size, start, sampleOffset, data_, offset, length);
+  if (offset < 64 || length < 0 || offset > size_ - length) {
+    ThrowCodecsException(
+        "RleDecoder::DecodeSegment::Segment exceeds input buffer length (" +
+        to_string(segment) + ")");
+  }
+  Decode(buffer, size, data_, offset, length);
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void RleDecoder::Decode(uint8_t *buffer, const int32_t size,
-                        const int32_t start, const int32_t sampleOffset,
                         uint8_t const *rleData, const int32_t offset,
                         const int32_t count) {
-  auto pos = start;
+  auto pos = 0;
   auto const end = offset + count;
   auto const bufferLength = size;
 
+  // Runs are copied and filled as a whole, into a contiguous byte plane
   for (auto i = offset; i < end && pos < bufferLength;) {
     auto const control = static_cast<int8_t>(rleData[i++]);
     if (control >= 0) {
-      auto length = control + 1;
+      auto const length = control + 1;
       if ((end - i) < length) {
         ThrowCodecsException(
             "RleDecoder::Decode::RLE literal run exceeds input buffer length");
       }
-      if ((pos + ((length - 1) * sampleOffset)) >= bufferLength) {
+      if ((pos + length) > bufferLength) {
         ThrowCodecsException(
             "RleDecoder::Decode::RLE literal run exceeds output buffer length");
       }
-      if (sampleOffset == 1) {
-        memcpy(&buffer[pos], &rleData[i], static_cast<size_t>(length));
-        pos += length;
-        i += length;
-      } else {
-        while (length-- > 0) {
-          buffer[pos] = rleData[i++];
-          pos += sampleOffset;
-        }
-      }
+      memcpy(&buffer[pos], &rleData[i], static_cast<size_t>(length));
+      pos += length;
+      i += length;
     } else if (control >= -127) {
-      auto length = -control;
-      if ((pos + ((length - 1) * sampleOffset)) >= bufferLength) {
+      if (i >= end) {
         ThrowCodecsException(
-            "RleDecoder::Decode::RLE repeat run exceeds output buffer length.");
-      }
-      auto const b = rleData[i++];
-      if (sampleOffset == 1) {
-        while (length-- >= 0) {
-          buffer[pos++] = b;
-        }
-      } else {
-        while (length-- >= 0) {
-          buffer[pos] = b;
-          pos += sampleOffset;
-        }
+            "RleDecoder::Decode::RLE repeat run exceeds input buffer length");
       }
+      // Repeat runs padding the segment past the plane end are clamped
+      auto const length = min(1 - control, bufferLength - pos);
+      memset(&buffer[pos], rleData[i++], static_cast<size_t>(length));
+      pos += length;
     }
     if ((i + 1) >= end) {
       break;
     }
   }
+
+  // Truncated segments leave the rest of the plane blank
+  if (pos < bufferLength) {
+    memset(&buffer[pos], 0, static_cast<size_t>(bufferLength - pos));
+  }
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -147,3 +143,108 @@ int32_t RleDecoder::GetSegmentLength(int32_t segment) const {
 
   return size_ - offset;
 }
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct RleDecoderSession : public CodecSession {
+  // Byte planes of the segments that are not decoded in place. The capacity
+  // grown by the previous frames of the session is kept.
+  vector<uint8_t> planes;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void InterleaveRlePlanes(uint8_t const *const *planes,
+                                size_t const planeCount,
+                                size_t const bytesAllocated,
+                                size_t const pixelCount, uint8_t *dest) {
+  // Planes hold the sample bytes, most significant byte first, while samples
+  // are stored little endian. The common layouts have dedicated loops, which
+  // the compiler vectorizes.
+  if (planeCount == 2 && bytesAllocated == 2) {
+    auto const hi = planes[0];
+    auto const lo = planes[1];
+    for (size_t i = 0; i < pixelCount; i++) {
+      dest[2 * i] = lo[i];
+      dest[2 * i + 1] = hi[i];
+    }
+  } else if (planeCount == 3 && bytesAllocated == 1) {
+    auto const p0 = planes[0];
+    auto const p1 = planes[1];
+    auto const p2 = planes[2];
+    for (size_t i = 0; i < pixelCount; i++) {
+      dest[3 * i] = p0[i];
+      dest[3 * i + 1] = p1[i];
+      dest[3 * i + 2] = p2[i];
+    }
+  } else {
+    for (size_t p = 0; p < planeCount; p++) {
+      auto const plane = planes[p];
+      auto const sample = p / bytesAllocated;
+      auto const sampleByte = p % bytesAllocated;
+      auto pDest =
+          &dest[sample * bytesAllocated + bytesAllocated - sampleByte - 1];
+      for (size_t i = 0; i < pixelCount; i++, pDest += planeCount) {
+        *pDest = plane[i];
+      }
+    }
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeRleImpl(CodecsContext *ctx, DecoderParameters *params) {
+  auto session = GetCodecSession<RleDecoderSession>(ctx->DecoderSession);
+
+  RleDecoder decoder(GetEncodedBuffer(ctx),
+                     static_cast<int32_t>(GetEncodedBufferSize(ctx)));
+
+  auto const bytesAllocated =
+      (GetBitsAllocated(ctx) / 8) + ((GetBitsAllocated(ctx) % 8 == 0) ? 0 : 1);
+  auto const samplesPerPixel = GetSamplesPerPixel(ctx);
+  auto const pixelCount = GetColumns(ctx) * GetRows(ctx);
+  auto const segmentCount = bytesAllocated * samplesPerPixel;
+  if (segmentCount < 1 || segmentCount > 15 ||
+      static_cast<size_t>(decoder.GetNumberOfSegments()) > segmentCount) {
+    ThrowCodecsException("DecodeRle::Unexpected number of segments (" +
+                         to_string(decoder.GetNumberOfSegments()) + ")");
+  }
+
+  // Every byte is written below, so the buffer is not cleared
+  ctx->DecodedBuffer.Resize(pixelCount * segmentCount);
+  auto const pDest = GetDecodedBuffer(ctx);
+
+  // Segments holding single byte planar or grayscale samples are decoded in
+  // place. Others are decoded into contiguous planes and interleaved in one
+  // pass per group of segments, which is a sample for planar frames and the
+  // whole pixel otherwise. Segments are independent from each other.
+  auto const isPlanar =
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Planar;
+  auto const groupSize = isPlanar ? bytesAllocated : segmentCount;
+  auto const groupCount = segmentCount / groupSize;
+  if (groupSize > 1) {
+    session->planes.resize(groupSize * pixelCount);
+  }
+
+  uint8_t const *planes[15];
+  for (size_t g = 0; g < groupCount; g++) {
+    auto const pGroupDest = &pDest[g * groupSize * pixelCount];
+    for (size_t p = 0; p < groupSize; p++) {
+      auto const s = g * groupSize + p;
+      auto const pPlane = groupSize == 1
+                              ? pGroupDest
+                              : &session->planes[p * pixelCount];
+      if (s < static_cast<size_t>(decoder.GetNumberOfSegments())) {
+        decoder.DecodeSegment(static_cast<int32_t>(s), pPlane,
+                              static_cast<int32_t>(pixelCount));
+      } else {
+        memset(pPlane, 0, pixelCount);
+      }
+      planes[p] = pPlane;
+    }
+    if (groupSize > 1) {
+      InterleaveRlePlanes(planes, groupSize, bytesAllocated, pixelCount,
+                          pGroupDest);
+    }
+  }
+}
@@ -2,6 +2,9 @@
 
 #include <cstdio>
 
+#include "CodecsContext.h"
+#include "DecoderParameters.h"
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 class RleDecoder {
@@ -10,8 +13,8 @@ class RleDecoder {
   ~RleDecoder();
 
   int32_t GetNumberOfSegments() const { return segmentCount_; }
-  void DecodeSegment(int32_t segment, uint8_t *buffer, int32_t size,
-                     int32_t start, int32_t sampleOffset);
+  // Decodes a segment into a contiguous byte plane of the given size
+  void DecodeSegment(int32_t segment, uint8_t *buffer, int32_t size);
 
   RleDecoder(RleDecoder const &) = delete;
   RleDecoder &operator=(RleDecoder const &) = delete;
@@ -23,9 +26,12 @@ class RleDecoder {
   int32_t segmentCount_;
   int32_t *offsets_;
 
-  void Decode(uint8_t *buffer, int32_t size, int32_t start,
-              int32_t sampleOffset, uint8_t const *rleData, int32_t offset,
-              int32_t count);
+  void Decode(uint8_t *buffer, int32_t size, uint8_t const *rleData,
+              int32_t offset, int32_t count);
   int32_t GetSegmentOffset(int32_t segment) const;
   int32_t GetSegmentLength(int32_t segment) const;
 };
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeRleImpl(CodecsContext *ctx, DecoderParameters *params);
@@ -152,6 +152,288 @@ EMSCRIPTEN_KEEPALIVE void SetAllowMct(EncoderParameters *params,
                                       size_t const allowMct) {
   params->AllowMct = allowMct;
 }
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetEncoderTileWidth(EncoderParameters const *params) {
+  return params->TileWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEncoderTileWidth(EncoderParameters *params,
+                                              size_t const tileWidth) {
+  params->TileWidth = tileWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetEncoderTileHeight(EncoderParameters const *params) {
+  return params->TileHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEncoderTileHeight(EncoderParameters *params,
+                                               size_t const tileHeight) {
+  params->TileHeight = tileHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodeBlockStyle(EncoderParameters const *params) {
+  return params->CodeBlockStyle;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetCodeBlockStyle(EncoderParameters *params,
+                                            size_t const codeBlockStyle) {
+  params->CodeBlockStyle = codeBlockStyle;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodeBlockWidth(EncoderParameters const *params) {
+  return params->CodeBlockWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetCodeBlockWidth(EncoderParameters *params,
+                                            size_t const codeBlockWidth) {
+  params->CodeBlockWidth = codeBlockWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetCodeBlockHeight(EncoderParameters const *params) {
+  return params->CodeBlockHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetCodeBlockHeight(EncoderParameters *params,
+                                             size_t const codeBlockHeight) {
+  params->CodeBlockHeight = codeBlockHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetNumberOfLayers(EncoderParameters const *params) {
+  return params->NumberOfLayers;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetNumberOfLayers(EncoderParameters *params,
+                                            size_t const numberOfLayers) {
+  params->NumberOfLayers = numberOfLayers;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetRateAllocation(EncoderParameters const *params) {
+  return params->RateAllocation;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetRateAllocation(EncoderParameters *params,
+                                            bool const rateAllocation) {
+  params->RateAllocation = rateAllocation;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE float
+GetQuantizationStep(EncoderParameters const *params) {
+  return params->QuantizationStep;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetQuantizationStep(EncoderParameters *params,
+                                              float const quantizationStep) {
+  params->QuantizationStep = quantizationStep;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetTargetBytes(EncoderParameters const *params) {
+  return params->TargetBytes;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetTargetBytes(EncoderParameters *params,
+                                         size_t const targetBytes) {
+  params->TargetBytes = targetBytes;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE float GetTargetPsnr(EncoderParameters const *params) {
+  return params->TargetPsnr;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetTargetPsnr(EncoderParameters *params,
+                                        float const targetPsnr) {
+  params->TargetPsnr = targetPsnr;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetPrecinctWidth(EncoderParameters const *params) {
+  return params->PrecinctWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetPrecinctWidth(EncoderParameters *params,
+                                           size_t const precinctWidth) {
+  params->PrecinctWidth = precinctWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetPrecinctHeight(EncoderParameters const *params) {
+  return params->PrecinctHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetPrecinctHeight(EncoderParameters *params,
+                                            size_t const precinctHeight) {
+  params->PrecinctHeight = precinctHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool
+GetPacketLengthMarkers(EncoderParameters const *params) {
+  return params->PacketLengthMarkers;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void
+SetPacketLengthMarkers(EncoderParameters *params,
+                       bool const packetLengthMarkers) {
+  params->PacketLengthMarkers = packetLengthMarkers;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetEffort(EncoderParameters const *params) {
+  return params->Effort;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEffort(EncoderParameters *params,
+                                    size_t const effort) {
+  params->Effort = effort;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetDecodingSpeed(EncoderParameters const *params) {
+  return params->DecodingSpeed;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetDecodingSpeed(EncoderParameters *params,
+                                           size_t const decodingSpeed) {
+  params->DecodingSpeed = decodingSpeed;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t GetModular(EncoderParameters const *params) {
+  return params->Modular;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetModular(EncoderParameters *params,
+                                     int32_t const modular) {
+  params->Modular = modular;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t
+GetModularPredictor(EncoderParameters const *params) {
+  return params->ModularPredictor;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetModularPredictor(EncoderParameters *params,
+                                              int32_t const modularPredictor) {
+  params->ModularPredictor = modularPredictor;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t
+GetModularGroupSize(EncoderParameters const *params) {
+  return params->ModularGroupSize;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetModularGroupSize(EncoderParameters *params,
+                                              int32_t const modularGroupSize) {
+  params->ModularGroupSize = modularGroupSize;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t GetBrotliEffort(EncoderParameters const *params) {
+  return params->BrotliEffort;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetBrotliEffort(EncoderParameters *params,
+                                          int32_t const brotliEffort) {
+  params->BrotliEffort = brotliEffort;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetProgressive(EncoderParameters const *params) {
+  return params->Progressive;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetProgressive(EncoderParameters *params,
+                                         bool const progressive) {
+  params->Progressive = progressive;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetEncoderThreadCount(EncoderParameters const *params) {
+  return params->ThreadCount;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEncoderThreadCount(EncoderParameters *params,
+                                                size_t const threadCount) {
+  params->ThreadCount = threadCount;
+}
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -176,6 +458,36 @@ string EncoderParametersToString(EncoderParameters const *params) {
       << (progressionOrder ? progressionOrder->_to_string() : "");
   oss << ", Rate [JPEG 2000]: " << to_string(params->Rate);
   oss << ", AllowMct [JPEG 2000]: " << to_string(params->AllowMct);
+  oss << ", TileWidth [JPEG 2000 / HT-JPEG 2000]: "
+      << to_string(params->TileWidth);
+  oss << ", TileHeight [JPEG 2000 / HT-JPEG 2000]: "
+      << to_string(params->TileHeight);
+  oss << ", CodeBlockStyle [JPEG 2000]: " << to_string(params->CodeBlockStyle);
+  oss << ", CodeBlockWidth [JPEG 2000]: " << to_string(params->CodeBlockWidth);
+  oss << ", CodeBlockHeight [JPEG 2000]: "
+      << to_string(params->CodeBlockHeight);
+  oss << ", NumberOfLayers [JPEG 2000]: " << to_string(params->NumberOfLayers);
+  oss << ", RateAllocation [JPEG 2000]: " << to_string(params->RateAllocation);
+  oss << ", QuantizationStep [HT-JPEG 2000]: "
+      << to_string(params->QuantizationStep);
+  oss << ", TargetBytes [HT-JPEG 2000]: " << to_string(params->TargetBytes);
+  oss << ", TargetPsnr [HT-JPEG 2000]: " << to_string(params->TargetPsnr);
+  oss << ", PrecinctWidth [HT-JPEG 2000]: " << to_string(params->PrecinctWidth);
+  oss << ", PrecinctHeight [HT-JPEG 2000]: "
+      << to_string(params->PrecinctHeight);
+  oss << ", PacketLengthMarkers [HT-JPEG 2000]: "
+      << to_string(params->PacketLengthMarkers);
+  oss << ", Effort [JPEG-XL]: " << to_string(params->Effort);
+  oss << ", DecodingSpeed [JPEG-XL]: " << to_string(params->DecodingSpeed);
+  oss << ", Modular [JPEG-XL]: " << to_string(params->Modular);
+  oss << ", ModularPredictor [JPEG-XL]: "
+      << to_string(params->ModularPredictor);
+  oss << ", ModularGroupSize [JPEG-XL]: "
+      << to_string(params->ModularGroupSize);
+  oss << ", BrotliEffort [JPEG-XL]: " << to_string(params->BrotliEffort);
+  oss << ", Progressive [JPEG-XL]: " << to_string(params->Progressive);
+  oss << ", ThreadCount [JPEG 2000 / HT-JPEG 2000 / JPEG-XL]: "
+      << to_string(params->ThreadCount);
 
   return oss.str();
 }
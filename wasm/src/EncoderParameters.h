@@ -31,9 +31,44 @@ struct EncoderParameters {
   size_t ProgressionOrder = 0;
   size_t Rate = 20;
   size_t AllowMct = 1;
+  // JPEG 2000, HT-JPEG 2000 (0: single tile)
+  size_t TileWidth = 0;
+  size_t TileHeight = 0;
+  // Code-block style flags (1: BYPASS, 2: RESET, 4: TERMALL, 8: VSC,
+  // 16: PTERM, 32: SEGSYM)
+  size_t CodeBlockStyle = 0;
+  size_t CodeBlockWidth = 64;
+  size_t CodeBlockHeight = 64;
+  // Quality layers, each halving the compression ratio of the previous one
+  // and ending at Rate (lossless frames get an additional lossless layer)
+  size_t NumberOfLayers = 1;
+  // false: a single layer with every coding pass, skipping the
+  // rate-distortion search
+  bool RateAllocation = true;
 
   // HT-JPEG 2000
-  size_t QuantizationStep = 0;
+  // Lossy quantization step, in sample units (0: OpenJPH default of 1)
+  float QuantizationStep = 0.0f;
+  // Lossy step predicted for a codestream size or a PSNR (0: none), in place
+  // of QuantizationStep
+  size_t TargetBytes = 0;
+  float TargetPsnr = 0.0f;
+  // Precinct size of every resolution (0: a single precinct per resolution)
+  size_t PrecinctWidth = 0;
+  size_t PrecinctHeight = 0;
+  // PLT marker segments, with the packet lengths of each tile-part
+  bool PacketLengthMarkers = false;
+
+  // JPEG-XL (-1: left to libjxl)
+  size_t Effort = 7;
+  size_t DecodingSpeed = 0;
+  int32_t Modular = -1;
+  int32_t ModularPredictor = -1;
+  int32_t ModularGroupSize = -1;
+  int32_t BrotliEffort = -1;
+  bool Progressive = false;
+  // JPEG 2000, HT-JPEG 2000, JPEG-XL (0: hardware concurrency, 1: serial)
+  size_t ThreadCount = 0;
 };
 
 extern "C" {
@@ -134,6 +169,201 @@ EMSCRIPTEN_KEEPALIVE size_t GetAllowMct(EncoderParameters const *params);
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 EMSCRIPTEN_KEEPALIVE void SetAllowMct(EncoderParameters *params,
                                       size_t allowMct);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetEncoderTileWidth(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEncoderTileWidth(EncoderParameters *params,
+                                              size_t tileWidth);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetEncoderTileHeight(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEncoderTileHeight(EncoderParameters *params,
+                                               size_t tileHeight);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodeBlockStyle(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetCodeBlockStyle(EncoderParameters *params,
+                                            size_t codeBlockStyle);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodeBlockWidth(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetCodeBlockWidth(EncoderParameters *params,
+                                            size_t codeBlockWidth);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetCodeBlockHeight(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetCodeBlockHeight(EncoderParameters *params,
+                                             size_t codeBlockHeight);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetNumberOfLayers(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetNumberOfLayers(EncoderParameters *params,
+                                            size_t numberOfLayers);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetRateAllocation(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetRateAllocation(EncoderParameters *params,
+                                            bool rateAllocation);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE float
+GetQuantizationStep(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetQuantizationStep(EncoderParameters *params,
+                                              float quantizationStep);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetTargetBytes(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetTargetBytes(EncoderParameters *params,
+                                         size_t targetBytes);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE float GetTargetPsnr(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetTargetPsnr(EncoderParameters *params,
+                                        float targetPsnr);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetPrecinctWidth(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetPrecinctWidth(EncoderParameters *params,
+                                           size_t precinctWidth);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetPrecinctHeight(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetPrecinctHeight(EncoderParameters *params,
+                                            size_t precinctHeight);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool
+GetPacketLengthMarkers(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetPacketLengthMarkers(EncoderParameters *params,
+                                                 bool packetLengthMarkers);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetEffort(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEffort(EncoderParameters *params, size_t effort);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t GetDecodingSpeed(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetDecodingSpeed(EncoderParameters *params,
+                                           size_t decodingSpeed);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t GetModular(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetModular(EncoderParameters *params,
+                                     int32_t modular);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t
+GetModularPredictor(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetModularPredictor(EncoderParameters *params,
+                                              int32_t modularPredictor);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t
+GetModularGroupSize(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetModularGroupSize(EncoderParameters *params,
+                                              int32_t modularGroupSize);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE int32_t GetBrotliEffort(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetBrotliEffort(EncoderParameters *params,
+                                          int32_t brotliEffort);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE bool GetProgressive(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetProgressive(EncoderParameters *params,
+                                         bool progressive);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetEncoderThreadCount(EncoderParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void SetEncoderThreadCount(EncoderParameters *params,
+                                                size_t threadCount);
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
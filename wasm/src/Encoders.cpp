@@ -6,72 +6,186 @@
 #include <ojph_params.h>
 #include <opj_includes.h>
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Buffer.h"
+#include "CodecsArena.h"
 #include "CodecsContext.h"
 #include "EncoderParameters.h"
 #include "Encoders/JpegEncoder12.h"
 #include "Encoders/JpegEncoder16.h"
 #include "Encoders/JpegEncoder8.h"
+#include "Encoders/JpegLsEncoder.h"
 #include "Encoders/JpegXlEncoder.h"
 #include "Encoders/RleEncoder.h"
 #include "Exception.h"
 #include "Jpeg2000Buffer.h"
+#include "Jpeg2000Packets.h"
+#include "Jpeg2000RateControl.h"
+#include "Jpeg2000Tiles.h"
 #include "Logging.h"
 
 using namespace std;
 using namespace charls;
 using namespace ojph;
 
-extern "C" {
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-EMSCRIPTEN_KEEPALIVE void EncodeRle(CodecsContext *ctx,
-                                    EncoderParameters *params) {
-  ENCODER_TRACE_ENTRY(ctx, params);
+// Reads count samples of a component, step samples apart, as the 32-bit
+// samples OpenJPEG and OpenJPH take
+template <typename T>
+static void ReadJpeg2000Samples(uint8_t const *source, size_t const step,
+                                size_t const count, int32_t *destination) {
+  auto const *sp = reinterpret_cast<T const *>(source);
+  for (auto x = 0u; x < count; x++) {
+    *destination++ = *sp;
+    sp += step;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static ui32 GetHtJpeg2000Decompositions(ui32 width, ui32 height) {
+  auto numberOfDecompositions = 0u;
+  while (width > 64 && height > 64) {
+    numberOfDecompositions++;
+    width /= 2;
+    height /= 2;
+  }
+
+  return min(max(numberOfDecompositions, 1u), 6u);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Encodes a region of the frame as a codestream whose image origin is the
+// region origin (a zero tile size codes the region as a single tile)
+static void EncodeHtJpeg2000Region(CodecsContext *ctx,
+                                   EncoderParameters *params,
+                                   rect const &region,
+                                   ojph::size const &tileSize,
+                                   point const &tileOrigin,
+                                   ui32 const numberOfDecompositions,
+                                   float const quantizationStep,
+                                   mem_outfile *destinationBuffer) {
+  codestream codestream;
+
+  auto const colorTransform = GetSamplesPerPixel(ctx) > 1 ? true : false;
+  codestream.set_planar(colorTransform == false);
+  // A tile-part per resolution lets a resolution be fetched on its own; the
+  // position-first orders (PCRL, CPRL) would need a tile-part per precinct
+  codestream.set_tilepart_divisions(
+      params->ProgressionOrder <= +ProgressionOrderEnum::Rpcl, false);
+  codestream.request_tlm_marker(true);
+
+  auto siz = codestream.access_siz();
+  siz.set_image_extent(
+      point(region.org.x + region.siz.w, region.org.y + region.siz.h));
+  siz.set_num_components(GetSamplesPerPixel(ctx));
+  for (auto c = 0u; c < GetSamplesPerPixel(ctx); c++) {
+    siz.set_component(
+        c, point(1, 1), GetBitsAllocated(ctx),
+        GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed
+            ? true
+            : false);
+  }
+  siz.set_image_offset(region.org);
+  siz.set_tile_size(tileSize);
+  siz.set_tile_offset(tileOrigin);
+
+  auto cod = codestream.access_cod();
+  const string ProgressionOrders[] = {"LRCP", "RLCP", "RPCL", "PCRL", "CPRL"};
+  cod.set_progression_order(
+      ProgressionOrders[params->ProgressionOrder].c_str());
+  cod.set_color_transform(colorTransform);
+  cod.set_block_dims(64, 64);
+  if (params->PrecinctWidth > 0) {
+    // The size is repeated for every resolution
+    ojph::size precinctSize(static_cast<ui32>(params->PrecinctWidth),
+                            static_cast<ui32>(params->PrecinctHeight));
+    cod.set_precinct_size(1, &precinctSize);
+  } else {
+    cod.set_precinct_size(0, nullptr);
+  }
+  cod.set_reversible(!params->Lossy);
+  cod.set_num_decomposition(numberOfDecompositions);
+  if (params->Lossy && quantizationStep > 0.0f) {
+    // OpenJPH expects the step relative to the sample range
+    codestream.access_qcd().set_irrev_quant(
+        quantizationStep / static_cast<float>(1u << GetBitsAllocated(ctx)));
+  }
 
-  auto const bytesAllocated =
-      (GetBitsAllocated(ctx) / 8) + ((GetBitsAllocated(ctx) % 8 == 0) ? 0 : 1);
-  auto const pixelCount = GetColumns(ctx) * GetRows(ctx);
-  auto const numberOfSegments = bytesAllocated * GetSamplesPerPixel(ctx);
-
-  RleEncoder encoder;
-  auto pSource = GetDecodedBuffer(ctx);
-
-  for (auto s = 0; s < numberOfSegments; s++) {
-    encoder.NextSegment();
-
-    auto const sample = static_cast<size_t>(s) / bytesAllocated;
-    auto const sabyte = static_cast<size_t>(s) % bytesAllocated;
-
-    auto pos =
-        GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Interleaved
-            ? sample * bytesAllocated
-            : sample * bytesAllocated * pixelCount;
-    pos += bytesAllocated - sabyte - 1;
-    auto const offset =
-        GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Interleaved
-            ? GetSamplesPerPixel(ctx) * bytesAllocated
-            : bytesAllocated;
-
-    for (auto p = 0; p < pixelCount; p++) {
-      if (pos >= GetDecodedBufferSize(ctx)) {
-        ThrowCodecsException(
-            "EncodeRle::Read position is past end of frame buffer");
+  comment_exchange com_ex;
+  codestream.write_headers(destinationBuffer, &com_ex, 0);
+
+  // Each component line is read in place through a strided view of the
+  // decoded buffer, for planar and interleaved frames alike
+  auto const width = GetColumns(ctx);
+  auto const samplesPerPixel = GetSamplesPerPixel(ctx);
+  auto const bytesPerSample = GetBitsAllocated(ctx) <= 8 ? 1u : 2u;
+  auto const isPlanar =
+      samplesPerPixel > 1 &&
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Planar;
+  auto const sampleStep = isPlanar ? 1u : samplesPerPixel;
+  auto const rowStride = width * bytesPerSample * sampleStep;
+  auto const componentOffset =
+      isPlanar ? width * GetRows(ctx) * bytesPerSample : bytesPerSample;
+  auto const isSigned =
+      GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed;
+  auto const *regionStart = GetDecodedBuffer(ctx) + region.org.y * rowStride +
+                            region.org.x * bytesPerSample * sampleStep;
+
+  ui32 next_comp;
+  auto *cur_line = codestream.exchange(nullptr, next_comp);
+  for (auto y = 0u; y < region.siz.h; y++) {
+    for (auto c = 0; c < siz.get_num_components(); c++) {
+      auto const *sp = regionStart + y * rowStride + c * componentOffset;
+      if (bytesPerSample == 1) {
+        ReadJpeg2000Samples<uint8_t>(sp, sampleStep, region.siz.w,
+                                     cur_line->i32);
+      } else if (isSigned) {
+        ReadJpeg2000Samples<int16_t>(sp, sampleStep, region.siz.w,
+                                     cur_line->i32);
+      } else {
+        ReadJpeg2000Samples<uint16_t>(sp, sampleStep, region.siz.w,
+                                      cur_line->i32);
       }
-      encoder.Encode(pSource[pos]);
-      pos += offset;
+      cur_line = codestream.exchange(cur_line, next_comp);
     }
-    encoder.Flush();
   }
 
-  encoder.MakeEvenLength();
-  auto const encodedData = encoder.GetBuffer();
+  codestream.flush();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Adds PLT marker segments, which OpenJPH does not write, to the encoded
+// codestream
+static void AddHtJpeg2000PacketLengths(CodecsContext *ctx) {
+  Jpeg2000PacketIndex index;
+  BuildJpeg2000PacketIndex(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx),
+                           &index);
+
+  vector<uint8_t> codestream;
+  InsertJpeg2000PacketLengths(GetEncodedBuffer(ctx), GetEncodedBufferSize(ctx),
+                              index, &codestream);
+  SetEncodedBufferSize(ctx, codestream.size());
+  memcpy(GetEncodedBuffer(ctx), codestream.data(), codestream.size());
+}
 
-  SetEncodedBufferSize(ctx, encoder.GetLength());
-  memcpy(GetEncodedBuffer(ctx), encodedData, encoder.GetLength());
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void EncodeRle(CodecsContext *ctx,
+                                    EncoderParameters *params) {
+  ENCODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
+
+  EncodeRleImpl(ctx, params);
 
   ENCODER_TRACE_EXIT(ctx);
 }
@@ -81,6 +195,7 @@ EMSCRIPTEN_KEEPALIVE void EncodeRle(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void EncodeJpeg(CodecsContext *ctx,
                                      EncoderParameters *params) {
   ENCODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
   auto const jpegBitDepth = GetBitsStored(ctx);
   if (params->Lossy && jpegBitDepth != 8) {
@@ -107,48 +222,9 @@ EMSCRIPTEN_KEEPALIVE void EncodeJpeg(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void EncodeJpegLs(CodecsContext *ctx,
                                        EncoderParameters *params) {
   ENCODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
-  JlsParameters jlsParams = {};
-  auto const bytesAllocated =
-      (GetBitsAllocated(ctx) / 8) + ((GetBitsAllocated(ctx) % 8 == 0) ? 0 : 1);
-
-  jlsParams.width = static_cast<int32_t>(GetColumns(ctx));
-  jlsParams.height = static_cast<int32_t>(GetRows(ctx));
-  jlsParams.bitsPerSample = static_cast<int32_t>(GetBitsAllocated(ctx));
-  jlsParams.stride = static_cast<int32_t>(bytesAllocated * GetColumns(ctx) *
-                                          GetSamplesPerPixel(ctx));
-  jlsParams.components = static_cast<int32_t>(GetSamplesPerPixel(ctx));
-  jlsParams.interleaveMode =
-      GetSamplesPerPixel(ctx) == 1 ? InterleaveMode::None
-      : GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Interleaved
-          ? InterleaveMode::Sample
-          : InterleaveMode::Line;
-  jlsParams.colorTransformation = ColorTransformation::None;
-  jlsParams.allowedLossyError =
-      params->Lossy ? static_cast<int32_t>(params->AllowedLossyError) : 0;
-
-  // Taken from estimated_destination_size in charls_jpegls_encoder.cpp
-  // Add 20% to the estimated size to avoid running out of buffer space.
-  auto const estimatedJpegLsDataSize = GetColumns(ctx) * GetRows(ctx) *
-                                           GetSamplesPerPixel(ctx) *
-                                           bytesAllocated +
-                                       1024 + 34;
-  size_t actualJpegLsDataSize = 0;
-
-  Buffer tmpBuffer;
-  tmpBuffer.Reset(static_cast<size_t>(estimatedJpegLsDataSize * 0.2 +
-                                      estimatedJpegLsDataSize));
-
-  char errorMsg[256 + 1] = {'\0'};
-  auto const retCode = JpegLsEncode(
-      tmpBuffer.GetData(), tmpBuffer.GetSize(), &actualJpegLsDataSize,
-      GetDecodedBuffer(ctx), GetDecodedBufferSize(ctx), &jlsParams, errorMsg);
-  if (retCode != ApiResult::OK) {
-    ThrowCodecsException("EncodeJpegLs::JpegLsEncode::" + string(errorMsg));
-  }
-
-  SetEncodedBufferSize(ctx, actualJpegLsDataSize);
-  memcpy(GetEncodedBuffer(ctx), tmpBuffer.GetData(), actualJpegLsDataSize);
+  EncodeJpegLsImpl(ctx, params);
 
   ENCODER_TRACE_EXIT(ctx);
 }
@@ -158,6 +234,7 @@ EMSCRIPTEN_KEEPALIVE void EncodeJpegLs(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void EncodeJpeg2000(CodecsContext *ctx,
                                          EncoderParameters *params) {
   ENCODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
   auto pCodec = opj_create_compress(OPJ_CODEC_J2K);
   if (!pCodec) {
@@ -179,17 +256,56 @@ EMSCRIPTEN_KEEPALIVE void EncodeJpeg2000(CodecsContext *ctx,
     parameters.tcp_mct = 1;
   }
 
-  parameters.tcp_numlayers++;
-  parameters.tcp_rates[0] = static_cast<float>(
-      params->Rate * GetBitsStored(ctx) / GetBitsAllocated(ctx));
-  if (!params->Lossy) {
+  if (params->CodeBlockStyle > 63) {
+    opj_destroy_codec(pCodec);
+    ThrowCodecsException("EncodeJpeg2000::Unsupported code-block style (" +
+                         to_string(params->CodeBlockStyle) + ")");
+  }
+  parameters.mode = static_cast<int>(params->CodeBlockStyle);
+  parameters.cblockw_init = static_cast<int>(params->CodeBlockWidth);
+  parameters.cblockh_init = static_cast<int>(params->CodeBlockHeight);
+
+  // Without rate allocation, a single layer takes every coding pass and the
+  // rate-distortion threshold search is skipped
+  if (params->RateAllocation) {
+    auto const numberOfLayers =
+        params->NumberOfLayers + (params->Lossy ? 0 : 1);
+    if (params->NumberOfLayers == 0 || numberOfLayers > 100) {
+      opj_destroy_codec(pCodec);
+      ThrowCodecsException("EncodeJpeg2000::Invalid number of layers (" +
+                           to_string(params->NumberOfLayers) + ")");
+    }
+    auto const rate = static_cast<float>(params->Rate * GetBitsStored(ctx) /
+                                         GetBitsAllocated(ctx));
+    for (auto i = 0u; i < params->NumberOfLayers; i++) {
+      parameters.tcp_rates[parameters.tcp_numlayers++] =
+          ldexp(rate, static_cast<int>(params->NumberOfLayers - 1 - i));
+    }
+    if (!params->Lossy) {
+      parameters.tcp_rates[parameters.tcp_numlayers++] = 0;
+    }
+  } else {
     parameters.tcp_rates[parameters.tcp_numlayers++] = 0;
   }
   parameters.cp_disto_alloc = 1;
 
+  // The resolution levels are bounded by the smallest tile, so that every
+  // tile keeps at least one sample per level
+  auto tileWidth = GetColumns(ctx);
+  auto tileHeight = GetRows(ctx);
+  if (params->TileWidth || params->TileHeight) {
+    tileWidth =
+        params->TileWidth ? min(params->TileWidth, tileWidth) : tileWidth;
+    tileHeight =
+        params->TileHeight ? min(params->TileHeight, tileHeight) : tileHeight;
+    parameters.tile_size_on = OPJ_TRUE;
+    parameters.cp_tdx = static_cast<int>(tileWidth);
+    parameters.cp_tdy = static_cast<int>(tileHeight);
+  }
+
   auto numberOfResolutions = 0;
-  auto tw = GetColumns(ctx) >> 1;
-  auto th = GetRows(ctx) >> 1;
+  auto tw = tileWidth >> 1;
+  auto th = tileHeight >> 1;
   while (tw && th) {
     numberOfResolutions++;
     tw >>= 1;
@@ -223,39 +339,29 @@ EMSCRIPTEN_KEEPALIVE void EncodeJpeg2000(CodecsContext *ctx,
       pImage->y0 +
       (GetRows(ctx) - 1) * static_cast<size_t>(parameters.subsampling_dy) + 1;
 
+  // Each component is read from a strided view of the decoded buffer, for
+  // planar and interleaved frames of 8 or 16-bit samples alike
   auto const numPixels = GetColumns(ctx) * GetRows(ctx);
-  if (pImage->numcomps == 1) {
-    if (pImage->comps[0].prec <= 8) {
-      auto pDest = pImage->comps[0].data;
-      auto pSource = GetDecodedBuffer(ctx);
-      for (auto i = numPixels; i; i--) {
-        *pDest++ = *pSource++;
-      }
-    }
-    if (pImage->comps[0].prec > 8) {
-      if (GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Unsigned) {
-        auto pDest = pImage->comps[0].data;
-        auto pSource = reinterpret_cast<uint16_t *>(GetDecodedBuffer(ctx));
-        for (auto i = numPixels; i; i--) {
-          *pDest++ = *pSource++;
-        }
-      } else {
-        auto pDest = pImage->comps[0].data;
-        auto pSource = reinterpret_cast<int16_t *>(GetDecodedBuffer(ctx));
-        for (auto i = numPixels; i; i--) {
-          *pDest++ = *pSource++;
-        }
-      }
-    }
-  } else if (pImage->numcomps == 3) {
-    auto pDestR = pImage->comps[0].data;
-    auto pDestG = pImage->comps[1].data;
-    auto pDestB = pImage->comps[2].data;
-    auto pSource = GetDecodedBuffer(ctx);
-    for (auto i = numPixels; i; i--) {
-      *pDestR++ = *pSource++;
-      *pDestG++ = *pSource++;
-      *pDestB++ = *pSource++;
+  auto const bytesPerSample = GetBitsAllocated(ctx) <= 8 ? 1u : 2u;
+  auto const isPlanar =
+      pImage->numcomps > 1 &&
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Planar;
+  auto const sampleStep = isPlanar ? 1u : pImage->numcomps;
+  auto const componentOffset =
+      isPlanar ? numPixels * bytesPerSample : bytesPerSample;
+  auto const isSigned =
+      GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed;
+  for (auto c = 0u; c < pImage->numcomps; c++) {
+    auto const *sp = GetDecodedBuffer(ctx) + c * componentOffset;
+    if (bytesPerSample == 1) {
+      ReadJpeg2000Samples<uint8_t>(sp, sampleStep, numPixels,
+                                   pImage->comps[c].data);
+    } else if (isSigned) {
+      ReadJpeg2000Samples<int16_t>(sp, sampleStep, numPixels,
+                                   pImage->comps[c].data);
+    } else {
+      ReadJpeg2000Samples<uint16_t>(sp, sampleStep, numPixels,
+                                    pImage->comps[c].data);
     }
   }
 
@@ -266,25 +372,35 @@ EMSCRIPTEN_KEEPALIVE void EncodeJpeg2000(CodecsContext *ctx,
         "EncodeJpeg2000::opj_setup_encoder::Failed to setup encoder");
   }
 
-  auto estimatedJpeg2000DataSize = 0;
-  for (auto i = 0; i < pImage->numcomps; i++) {
-    estimatedJpeg2000DataSize +=
-        pImage->comps[i].w * pImage->comps[i].h * pImage->comps[i].prec;
+  // Tier-1 coding of the code-blocks is spread over the OpenJPEG thread pool;
+  // the tiles themselves are encoded one after the other
+  auto const workers = GetJpeg2000WorkerCount(params->ThreadCount);
+  if (workers > 1 &&
+      !opj_codec_set_threads(pCodec, static_cast<int>(workers))) {
+    opj_image_destroy(pImage);
+    opj_destroy_codec(pCodec);
+    ThrowCodecsException(
+        "EncodeJpeg2000::opj_codec_set_threads::Failed to set threads");
   }
-  size_t actualJpeg2000DataSize = 0;
 
-  Buffer tmpBuffer;
-  tmpBuffer.Reset(
-      static_cast<size_t>(0.1625 * estimatedJpeg2000DataSize + 2000));
+  // The codestream is written straight into the encoded buffer, which grows
+  // as needed. The initial reservation assumes a 4:1 compression ratio.
+  size_t estimatedJpeg2000DataSize = 0;
+  for (auto i = 0u; i < pImage->numcomps; i++) {
+    auto const &comp = pImage->comps[i];
+    estimatedJpeg2000DataSize +=
+        static_cast<size_t>(comp.w) * comp.h * ((comp.prec + 7) / 8);
+  }
 
-  Jpeg2000Buffer destinationBuffer(tmpBuffer.GetData(), tmpBuffer.GetSize());
-  auto pStream = OpjCreateMemoryStream(&destinationBuffer,
-                                       OPJ_J2K_STREAM_CHUNK_SIZE, false);
+  ctx->EncodedFragments.clear();
+  Jpeg2000WriteBuffer destinationBuffer(&ctx->EncodedBuffer);
+  ctx->EncodedBuffer.Reserve(max<size_t>(estimatedJpeg2000DataSize / 4, 65536));
+  auto pStream = OpjCreateWriteStream(&destinationBuffer);
   if (!pStream) {
     opj_image_destroy(pImage);
     opj_destroy_codec(pCodec);
     ThrowCodecsException(
-        "EncodeJpeg2000::OpjCreateMemoryStream::Failed to create stream");
+        "EncodeJpeg2000::OpjCreateWriteStream::Failed to create stream");
   }
 
   if (!opj_start_compress(pCodec, pImage, pStream)) {
@@ -314,10 +430,6 @@ EMSCRIPTEN_KEEPALIVE void EncodeJpeg2000(CodecsContext *ctx,
   opj_destroy_codec(pCodec);
   opj_image_destroy(pImage);
 
-  actualJpeg2000DataSize = destinationBuffer.Offset;
-  SetEncodedBufferSize(ctx, actualJpeg2000DataSize);
-  memcpy(GetEncodedBuffer(ctx), tmpBuffer.GetData(), actualJpeg2000DataSize);
-
   ENCODER_TRACE_EXIT(ctx);
 }
 
@@ -326,100 +438,81 @@ EMSCRIPTEN_KEEPALIVE void EncodeJpeg2000(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void EncodeHtJpeg2000(CodecsContext *ctx,
                                            EncoderParameters *params) {
   ENCODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
-  codestream codestream;
-  mem_outfile destinationBuffer;
-
-  auto const colorTransform = GetSamplesPerPixel(ctx) > 1 ? true : false;
-  codestream.set_planar(colorTransform == false);
-  codestream.set_tilepart_divisions(true, false);
-  codestream.request_tlm_marker(true);
-
-  auto siz = codestream.access_siz();
-  siz.set_image_extent(point(GetColumns(ctx), GetRows(ctx)));
-  siz.set_num_components(GetSamplesPerPixel(ctx));
-  for (auto c = 0u; c < GetSamplesPerPixel(ctx); c++) {
-    siz.set_component(
-        c, point(1, 1), GetBitsAllocated(ctx),
-        GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed
-            ? true
-            : false);
-  }
-  siz.set_image_offset(point(0, 0));
-  siz.set_tile_size(ojph::size(0, 0));
-  siz.set_tile_offset(point(0, 0));
-
-  auto cod = codestream.access_cod();
-  const string ProgressionOrders[] = {"LRCP", "RLCP", "RPCL", "PCRL", "CPRL"};
-  cod.set_progression_order(
-      ProgressionOrders[params->ProgressionOrder].c_str());
-  cod.set_color_transform(colorTransform);
-  cod.set_block_dims(64, 64);
-  cod.set_precinct_size(0, nullptr);
-  cod.set_reversible(!params->Lossy);
-
-  auto numberOfDecompositions = 0u;
-  auto tw = GetColumns(ctx);
-  auto th = GetRows(ctx);
-  while (tw > 64 && th > 64) {
-    numberOfDecompositions++;
-    tw = static_cast<size_t>(ceil(tw / 2));
-    th = static_cast<size_t>(ceil(th / 2));
+  auto const columns = static_cast<ui32>(GetColumns(ctx));
+  auto const rows = static_cast<ui32>(GetRows(ctx));
+  auto const bytesPerSample = GetBitsAllocated(ctx) <= 8 ? 1u : 2u;
+  if (GetDecodedBufferSize(ctx) <
+      columns * rows * GetSamplesPerPixel(ctx) * bytesPerSample) {
+    ThrowCodecsException(
+        "EncodeHtJpeg2000::Decoded buffer is smaller than the frame");
   }
-  if (numberOfDecompositions == 0) {
-    numberOfDecompositions = 1;
+  auto const isPrecinctSize = [](size_t const size) {
+    return size >= 8 && size <= 32768 && (size & (size - 1)) == 0;
+  };
+  if ((params->PrecinctWidth > 0 || params->PrecinctHeight > 0) &&
+      (!isPrecinctSize(params->PrecinctWidth) ||
+       !isPrecinctSize(params->PrecinctHeight))) {
+    ThrowCodecsException("EncodeHtJpeg2000::Invalid precinct size (" +
+                         to_string(params->PrecinctWidth) + "x" +
+                         to_string(params->PrecinctHeight) + ")");
   }
-  cod.set_num_decomposition(
-      numberOfDecompositions > 6 ? 6 : numberOfDecompositions);
-
-  destinationBuffer.open();
-
-  comment_exchange com_ex;
-  codestream.write_headers(&destinationBuffer, &com_ex, 0);
 
-  ui32 next_comp;
-  auto const bytesPerPixel = GetBitsAllocated(ctx) / 8;
-  auto *cur_line = codestream.exchange(nullptr, next_comp);
-  auto const height = siz.get_image_extent().y - siz.get_image_offset().y;
-  for (auto y = 0u; y < height; y++) {
-    for (auto c = 0; c < siz.get_num_components(); c++) {
-      auto dp = cur_line->i32;
-      if (GetBitsAllocated(ctx) <= 8) {
-        auto sp = reinterpret_cast<uint8_t *>(
-            GetDecodedBuffer(ctx) +
-            (y * GetColumns(ctx) * bytesPerPixel * siz.get_num_components()) +
-            c);
-        for (auto x = 0; x < GetColumns(ctx); x++) {
-          *dp++ = *sp;
-          sp += siz.get_num_components();
-        }
-      } else {
-        if (GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed) {
-          auto sp = reinterpret_cast<int16_t *>(
-              GetDecodedBuffer(ctx) + (y * GetColumns(ctx) * bytesPerPixel));
-          for (auto x = 0; x < GetColumns(ctx); x++) {
-            *dp++ = *sp++;
-          }
-        } else {
-          auto sp = reinterpret_cast<uint16_t *>(
-              GetDecodedBuffer(ctx) + (y * GetColumns(ctx) * bytesPerPixel));
-          for (auto x = 0; x < GetColumns(ctx); x++) {
-            *dp++ = *sp++;
-          }
-        }
-      }
-      cur_line = codestream.exchange(cur_line, next_comp);
-    }
+  Jpeg2000TileGrid grid;
+  grid.ImageX1 = columns;
+  grid.ImageY1 = rows;
+  grid.TileWidth = params->TileWidth
+                       ? min(static_cast<ui32>(params->TileWidth), columns)
+                       : columns;
+  grid.TileHeight = params->TileHeight
+                        ? min(static_cast<ui32>(params->TileHeight), rows)
+                        : rows;
+  auto const numberOfDecompositions =
+      GetHtJpeg2000Decompositions(grid.TileWidth, grid.TileHeight);
+  auto quantizationStep = params->QuantizationStep;
+  if (params->Lossy && (params->TargetBytes > 0 || params->TargetPsnr > 0.0f)) {
+    quantizationStep = PredictHtJpeg2000QuantizationStep(
+        ctx, numberOfDecompositions, params->TargetBytes, params->TargetPsnr);
   }
 
-  codestream.flush();
-
-  auto const actualHtJpeg2000DataSize = destinationBuffer.tell();
-  SetEncodedBufferSize(ctx, static_cast<size_t>(actualHtJpeg2000DataSize));
-  memcpy(GetEncodedBuffer(ctx), destinationBuffer.get_data(),
-         static_cast<size_t>(actualHtJpeg2000DataSize));
+  if (grid.GetNumberOfTiles() == 1) {
+    mem_outfile destinationBuffer;
+    destinationBuffer.open();
+    EncodeHtJpeg2000Region(ctx, params, grid.GetTileRect(0), ojph::size(0, 0),
+                           point(0, 0), numberOfDecompositions,
+                           quantizationStep, &destinationBuffer);
+
+    auto const actualHtJpeg2000DataSize = destinationBuffer.tell();
+    SetEncodedBufferSize(ctx, static_cast<size_t>(actualHtJpeg2000DataSize));
+    memcpy(GetEncodedBuffer(ctx), destinationBuffer.get_data(),
+           static_cast<size_t>(actualHtJpeg2000DataSize));
+    destinationBuffer.close();
+  } else {
+    // Each tile is encoded as a codestream of its own, with the image and tile
+    // origins at the tile position, so that the tiles can be coded in parallel
+    // and stitched afterwards. The first tile is encoded before the workers
+    // start, as OpenJPH initializes its shared tables on first use.
+    vector<unique_ptr<mem_outfile>> tiles(grid.GetNumberOfTiles());
+    auto const encodeTile = [&](size_t const t) {
+      tiles[t].reset(new mem_outfile());
+      tiles[t]->open();
+      EncodeHtJpeg2000Region(ctx, params, grid.GetTileRect(t),
+                             ojph::size(grid.TileWidth, grid.TileHeight),
+                             grid.GetTileOrigin(t), numberOfDecompositions,
+                             quantizationStep, tiles[t].get());
+    };
+    encodeTile(0);
+    RunJpeg2000TileJobs(
+        tiles.size() - 1, GetJpeg2000WorkerCount(params->ThreadCount),
+        [&](size_t const t) { encodeTile(t + 1); });
+
+    StitchJpeg2000Tiles(ctx, grid, tiles);
+  }
 
-  codestream.close();
+  if (params->PacketLengthMarkers) {
+    AddHtJpeg2000PacketLengths(ctx);
+  }
 
   ENCODER_TRACE_EXIT(ctx);
 }
@@ -429,9 +522,22 @@ EMSCRIPTEN_KEEPALIVE void EncodeHtJpeg2000(CodecsContext *ctx,
 EMSCRIPTEN_KEEPALIVE void EncodeJpegXl(CodecsContext *ctx,
                                        EncoderParameters *params) {
   ENCODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
 
   EncodeJpegXlImpl(ctx, params);
 
   ENCODER_TRACE_EXIT(ctx);
 }
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void TranscodeJpegToJpegXl(CodecsContext *ctx,
+                                                EncoderParameters *params) {
+  ENCODER_TRACE_ENTRY(ctx, params);
+  CodecsArenaScope arenaScope;
+
+  TranscodeJpegToJpegXlImpl(ctx, params);
+
+  ENCODER_TRACE_EXIT(ctx);
+}
 }
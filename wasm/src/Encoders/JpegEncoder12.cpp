@@ -4,6 +4,7 @@
 #include <jpeglib12.h>
 #include <setjmp.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -22,97 +23,161 @@ struct JpegEncoderDestinationManager12 : public jpeg_destination_mgr {
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void EncodeJpeg12(CodecsContext *ctx, EncoderParameters *params) {
-  jpeg_error_mgr jerr;
+struct JpegEncoderSession12 : public CodecSession {
+  JpegEncoderSession12() {
+    cinfo.err = jpeg_std_error(&jerr);
+    cinfo.err->error_exit = [](j_common_ptr cinfo) {
+      char buf[JMSG_LENGTH_MAX];
+      (*cinfo->err->format_message)(cinfo, buf);
+      ThrowCodecsException("JpegEncoder12::ErrorExit::" + string(buf));
+    };
+    cinfo.err->output_message = [](j_common_ptr cinfo) {
+      char buf[JMSG_LENGTH_MAX];
+      (*cinfo->err->format_message)(cinfo, buf);
+      OutputCodecsInfo("JpegEncoder12::OutputMessage::" + string(buf));
+    };
+    cinfo.err->emit_message = [](j_common_ptr cinfo, int messageLevel) {
+      char buf[JMSG_LENGTH_MAX];
+      (*cinfo->err->format_message)(cinfo, buf);
+      OutputCodecsInfo("JpegEncoder12::EmitMessage::" + string(buf));
+    };
+    jpeg_create_compress(&cinfo);
+
+    dest.init_destination = [](j_compress_ptr cinfo) {
+      auto dest =
+          reinterpret_cast<JpegEncoderDestinationManager12 *>(cinfo->dest);
+      // Starts from the capacity grown by the previous frames of the session
+      dest->data.resize(max<size_t>(dest->data.capacity(), JPEG12_BLOCKSIZE));
+      dest->next_output_byte = &dest->data[0];
+      dest->free_in_buffer = dest->data.size();
+    };
+    dest.empty_output_buffer = [](j_compress_ptr cinfo) -> boolean {
+      auto dest =
+          reinterpret_cast<JpegEncoderDestinationManager12 *>(cinfo->dest);
+      auto const oldSize = dest->data.size();
+      dest->data.resize(oldSize + JPEG12_BLOCKSIZE);
+      cinfo->dest->next_output_byte = &dest->data[oldSize];
+      cinfo->dest->free_in_buffer = dest->data.size() - oldSize;
+
+      return TRUE;
+    };
+    dest.term_destination = [](j_compress_ptr cinfo) {
+      auto dest =
+          reinterpret_cast<JpegEncoderDestinationManager12 *>(cinfo->dest);
+      dest->data.resize(dest->data.size() - cinfo->dest->free_in_buffer);
+    };
+    cinfo.dest = &dest;
+  }
 
-  jpeg_compress_struct cinfo;
-  cinfo.err = jpeg_std_error(&jerr);
-  cinfo.err->error_exit = [](j_common_ptr cinfo) {
-    char buf[JMSG_LENGTH_MAX];
-    (*cinfo->err->format_message)(cinfo, buf);
-    ThrowCodecsException("JpegEncoder12::ErrorExit::" + string(buf));
-  };
-  cinfo.err->output_message = [](j_common_ptr cinfo) {
-    char buf[JMSG_LENGTH_MAX];
-    (*cinfo->err->format_message)(cinfo, buf);
-    OutputCodecsInfo("JpegEncoder12::OutputMessage::" + string(buf));
-  };
-  cinfo.err->emit_message = [](j_common_ptr cinfo, int messageLevel) {
-    char buf[JMSG_LENGTH_MAX];
-    (*cinfo->err->format_message)(cinfo, buf);
-    OutputCodecsInfo("JpegEncoder12::EmitMessage::" + string(buf));
-  };
-  jpeg_create_compress(&cinfo);
+  ~JpegEncoderSession12() override { jpeg_destroy_compress(&cinfo); }
+
+  bool IsConfiguredFor(CodecsContext const *ctx,
+                       EncoderParameters const *params) const {
+    return configured && columns == GetColumns(ctx) &&
+           rows == GetRows(ctx) &&
+           samplesPerPixel == GetSamplesPerPixel(ctx) &&
+           lossy == params->Lossy && quality == params->Quality &&
+           smoothingFactor == params->SmoothingFactor &&
+           sampleFactor == params->SampleFactor &&
+           predictor == params->Predictor &&
+           pointTransform == params->PointTransform;
+  }
 
+  void SetConfiguredFor(CodecsContext const *ctx,
+                        EncoderParameters const *params) {
+    configured = true;
+    columns = GetColumns(ctx);
+    rows = GetRows(ctx);
+    samplesPerPixel = GetSamplesPerPixel(ctx);
+    lossy = params->Lossy;
+    quality = params->Quality;
+    smoothingFactor = params->SmoothingFactor;
+    sampleFactor = params->SampleFactor;
+    predictor = params->Predictor;
+    pointTransform = params->PointTransform;
+  }
+
+  jpeg_error_mgr jerr;
   JpegEncoderDestinationManager12 dest;
-  dest.init_destination = [](j_compress_ptr cinfo) {
-    auto dest =
-        reinterpret_cast<JpegEncoderDestinationManager12 *>(cinfo->dest);
-    dest->data.resize(JPEG12_BLOCKSIZE);
-    dest->next_output_byte = &dest->data[0];
-    dest->free_in_buffer = dest->data.size();
-  };
-  dest.empty_output_buffer = [](j_compress_ptr cinfo) -> boolean {
-    auto dest =
-        reinterpret_cast<JpegEncoderDestinationManager12 *>(cinfo->dest);
-    auto const oldSize = dest->data.size();
-    dest->data.resize(oldSize + JPEG12_BLOCKSIZE);
-    cinfo->dest->next_output_byte = &dest->data[oldSize];
-    cinfo->dest->free_in_buffer = dest->data.size() - oldSize;
-
-    return TRUE;
-  };
-  dest.term_destination = [](j_compress_ptr cinfo) {
-    auto dest =
-        reinterpret_cast<JpegEncoderDestinationManager12 *>(cinfo->dest);
-    dest->data.resize(dest->data.size() - cinfo->dest->free_in_buffer);
-  };
-  cinfo.dest = &dest;
-
-  cinfo.image_width = static_cast<JDIMENSION>(GetColumns(ctx));
-  cinfo.image_height = static_cast<JDIMENSION>(GetRows(ctx));
-  cinfo.input_components = static_cast<int>(GetSamplesPerPixel(ctx));
-  cinfo.in_color_space = GetSamplesPerPixel(ctx) > 1 ? JCS_RGB : JCS_GRAYSCALE;
-
-  jpeg_set_defaults(&cinfo);
-  cinfo.optimize_coding = true;
-
-  if (params->Lossy) {
-    jpeg_set_quality(&cinfo, static_cast<int>(params->Quality), 0);
-    if (cinfo.jpeg_color_space == JCS_YCbCr &&
-        params->SampleFactor != SampleFactorEnum::Unknown) {
-      switch (params->SampleFactor) {
-        case SampleFactorEnum::Sf444:
-          cinfo.comp_info[0].h_samp_factor = 1;
-          cinfo.comp_info[0].v_samp_factor = 1;
-          break;
-        case SampleFactorEnum::Sf422:
-          cinfo.comp_info[0].h_samp_factor = 2;
-          cinfo.comp_info[0].v_samp_factor = 1;
-          break;
+  jpeg_compress_struct cinfo;
+
+  bool configured = false;
+  size_t columns = 0;
+  size_t rows = 0;
+  size_t samplesPerPixel = 0;
+  bool lossy = false;
+  size_t quality = 0;
+  size_t smoothingFactor = 0;
+  size_t sampleFactor = 0;
+  size_t predictor = 0;
+  size_t pointTransform = 0;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void EncodeJpeg12(CodecsContext *ctx, EncoderParameters *params) {
+  auto session = GetCodecSession<JpegEncoderSession12>(ctx->EncoderSession);
+  auto &cinfo = session->cinfo;
+
+  // Returns the compressor to its idle state, in case the previous frame
+  // failed mid-way
+  jpeg_abort_compress(&cinfo);
+
+  // Frames of the same instance share the compression parameters and tables,
+  // so these are only set up once per session
+  if (!session->IsConfiguredFor(ctx, params)) {
+    session->configured = false;
+
+    cinfo.image_width = static_cast<JDIMENSION>(GetColumns(ctx));
+    cinfo.image_height = static_cast<JDIMENSION>(GetRows(ctx));
+    cinfo.input_components = static_cast<int>(GetSamplesPerPixel(ctx));
+    cinfo.in_color_space =
+        GetSamplesPerPixel(ctx) > 1 ? JCS_RGB : JCS_GRAYSCALE;
+
+    jpeg_set_defaults(&cinfo);
+    cinfo.optimize_coding = true;
+
+    if (params->Lossy) {
+      jpeg_set_quality(&cinfo, static_cast<int>(params->Quality), 0);
+      if (cinfo.jpeg_color_space == JCS_YCbCr &&
+          params->SampleFactor != SampleFactorEnum::Unknown) {
+        switch (params->SampleFactor) {
+          case SampleFactorEnum::Sf444:
+            cinfo.comp_info[0].h_samp_factor = 1;
+            cinfo.comp_info[0].v_samp_factor = 1;
+            break;
+          case SampleFactorEnum::Sf422:
+            cinfo.comp_info[0].h_samp_factor = 2;
+            cinfo.comp_info[0].v_samp_factor = 1;
+            break;
+        }
+      } else {
+        if (params->SampleFactor == SampleFactorEnum::Unknown) {
+          jpeg_set_colorspace(&cinfo, cinfo.in_color_space);
+        }
+        cinfo.comp_info[0].h_samp_factor = 1;
+        cinfo.comp_info[0].v_samp_factor = 1;
       }
     } else {
-      if (params->SampleFactor == SampleFactorEnum::Unknown) {
-        jpeg_set_colorspace(&cinfo, cinfo.in_color_space);
-      }
+      jpeg_simple_lossless(&cinfo, static_cast<int>(params->Predictor),
+                           static_cast<int>(params->PointTransform));
+      jpeg_set_colorspace(&cinfo, cinfo.in_color_space);
       cinfo.comp_info[0].h_samp_factor = 1;
       cinfo.comp_info[0].v_samp_factor = 1;
     }
-  } else {
-    jpeg_simple_lossless(&cinfo, static_cast<int>(params->Predictor),
-                         static_cast<int>(params->PointTransform));
-    jpeg_set_colorspace(&cinfo, cinfo.in_color_space);
-    cinfo.comp_info[0].h_samp_factor = 1;
-    cinfo.comp_info[0].v_samp_factor = 1;
-  }
 
-  for (auto sfi = 1; sfi < MAX_COMPONENTS; sfi++) {
-    cinfo.comp_info[sfi].h_samp_factor = 1;
-    cinfo.comp_info[sfi].v_samp_factor = 1;
-  }
+    for (auto sfi = 1; sfi < MAX_COMPONENTS; sfi++) {
+      cinfo.comp_info[sfi].h_samp_factor = 1;
+      cinfo.comp_info[sfi].v_samp_factor = 1;
+    }
 
-  cinfo.smoothing_factor = static_cast<int>(params->SmoothingFactor);
+    cinfo.smoothing_factor = static_cast<int>(params->SmoothingFactor);
+
+    session->SetConfiguredFor(ctx, params);
+  }
 
+  // Each frame is written as a complete interchange datastream, as the frames
+  // of an encapsulated DICOM pixel data need to be decodable on their own
   jpeg_start_compress(&cinfo, TRUE);
 
   JSAMPROW rowPointer[1];
@@ -128,10 +193,11 @@ void EncodeJpeg12(CodecsContext *ctx, EncoderParameters *params) {
     jpeg_write_scanlines(&cinfo, rowPointer, 1);
   }
 
+  // Leaves the compressor idle, ready for the next frame of the session
   jpeg_finish_compress(&cinfo);
-  jpeg_destroy_compress(&cinfo);
 
-  auto const actualJpegDataSize = dest.data.size();
+  auto const &data = session->dest.data;
+  auto const actualJpegDataSize = data.size();
   SetEncodedBufferSize(ctx, actualJpegDataSize);
-  memcpy(GetEncodedBuffer(ctx), dest.data.data(), actualJpegDataSize);
+  memcpy(GetEncodedBuffer(ctx), data.data(), actualJpegDataSize);
 }
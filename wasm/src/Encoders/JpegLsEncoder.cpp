@@ -0,0 +1,137 @@
+#include "JpegLsEncoder.h"
+
+#include <charls/charls.h>
+
+#include <string>
+
+#include "Exception.h"
+
+using namespace std;
+using namespace charls;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ThrowIfJpegLsEncoderFailed(string const &call,
+                                       jpegls_errc const errc) {
+  if (errc != jpegls_errc::success) {
+    ThrowCodecsException("EncodeJpegLs::" + call +
+                         "::" + string(charls_get_error_message(errc)));
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegLsEncoderSession : public CodecSession {
+  ~JpegLsEncoderSession() override { Destroy(); }
+
+  void Create() {
+    Destroy();
+    encoder = charls_jpegls_encoder_create();
+    if (!encoder) {
+      ThrowCodecsException(
+          "EncodeJpegLs::charls_jpegls_encoder_create::Failed to create "
+          "encoder");
+    }
+  }
+
+  void Destroy() {
+    charls_jpegls_encoder_destroy(encoder);
+    encoder = nullptr;
+    destination = nullptr;
+    destinationSize = 0;
+  }
+
+  void Configure(charls_frame_info const &frameInfo,
+                 interleave_mode const interleaveMode,
+                 int32_t const nearLossless) {
+    ThrowIfJpegLsEncoderFailed(
+        "charls_jpegls_encoder_set_frame_info",
+        charls_jpegls_encoder_set_frame_info(encoder, &frameInfo));
+    ThrowIfJpegLsEncoderFailed(
+        "charls_jpegls_encoder_set_interleave_mode",
+        charls_jpegls_encoder_set_interleave_mode(encoder, interleaveMode));
+    ThrowIfJpegLsEncoderFailed(
+        "charls_jpegls_encoder_set_near_lossless",
+        charls_jpegls_encoder_set_near_lossless(encoder, nearLossless));
+    ThrowIfJpegLsEncoderFailed("charls_jpegls_encoder_set_color_transformation",
+                               charls_jpegls_encoder_set_color_transformation(
+                                   encoder, color_transformation::none));
+  }
+
+  charls_jpegls_encoder *encoder = nullptr;
+  // The destination is bound to the encoder until it is recreated
+  uint8_t const *destination = nullptr;
+  size_t destinationSize = 0;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void EncodeJpegLsImpl(CodecsContext *ctx, EncoderParameters *params) {
+  auto session = GetCodecSession<JpegLsEncoderSession>(ctx->EncoderSession);
+
+  auto const bytesAllocated =
+      (GetBitsAllocated(ctx) / 8) + ((GetBitsAllocated(ctx) % 8 == 0) ? 0 : 1);
+  auto const samplesPerPixel = GetSamplesPerPixel(ctx);
+  // Planar frames are encoded as non-interleaved scans, one per plane
+  auto const isPlanar =
+      samplesPerPixel > 1 &&
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Planar;
+  auto const interleaveMode = samplesPerPixel == 1 || isPlanar
+                                  ? interleave_mode::none
+                                  : interleave_mode::sample;
+  auto const stride = static_cast<uint32_t>(
+      GetColumns(ctx) * bytesAllocated * (isPlanar ? 1 : samplesPerPixel));
+
+  charls_frame_info frameInfo = {};
+  frameInfo.width = static_cast<uint32_t>(GetColumns(ctx));
+  frameInfo.height = static_cast<uint32_t>(GetRows(ctx));
+  frameInfo.bits_per_sample = static_cast<int32_t>(GetBitsAllocated(ctx));
+  frameInfo.component_count = static_cast<int32_t>(samplesPerPixel);
+  auto const nearLossless =
+      params->Lossy ? static_cast<int32_t>(params->AllowedLossyError) : 0;
+
+  if (!session->encoder) {
+    session->Create();
+  }
+  session->Configure(frameInfo, interleaveMode, nearLossless);
+
+  // Add 20% to the estimated size to avoid running out of buffer space
+  size_t estimatedJpegLsDataSize = 0;
+  ThrowIfJpegLsEncoderFailed(
+      "charls_jpegls_encoder_get_estimated_destination_size",
+      charls_jpegls_encoder_get_estimated_destination_size(
+          session->encoder, &estimatedJpegLsDataSize));
+  estimatedJpegLsDataSize += estimatedJpegLsDataSize / 5;
+
+  // Encodes straight into the encoded buffer. The encoder is rewound while
+  // the buffer keeps its allocation, and recreated when it has to grow.
+  ctx->EncodedBuffer.Resize(estimatedJpegLsDataSize);
+  if (session->destination == GetEncodedBuffer(ctx) &&
+      session->destinationSize >= estimatedJpegLsDataSize) {
+    ThrowIfJpegLsEncoderFailed("charls_jpegls_encoder_rewind",
+                               charls_jpegls_encoder_rewind(session->encoder));
+  } else {
+    if (session->destination) {
+      session->Create();
+      session->Configure(frameInfo, interleaveMode, nearLossless);
+    }
+    ThrowIfJpegLsEncoderFailed(
+        "charls_jpegls_encoder_set_destination_buffer",
+        charls_jpegls_encoder_set_destination_buffer(
+            session->encoder, GetEncodedBuffer(ctx), estimatedJpegLsDataSize));
+    session->destination = GetEncodedBuffer(ctx);
+    session->destinationSize = estimatedJpegLsDataSize;
+  }
+
+  ThrowIfJpegLsEncoderFailed(
+      "charls_jpegls_encoder_encode_from_buffer",
+      charls_jpegls_encoder_encode_from_buffer(
+          session->encoder, GetDecodedBuffer(ctx), GetDecodedBufferSize(ctx),
+          stride));
+
+  size_t actualJpegLsDataSize = 0;
+  ThrowIfJpegLsEncoderFailed("charls_jpegls_encoder_get_bytes_written",
+                             charls_jpegls_encoder_get_bytes_written(
+                                 session->encoder, &actualJpegLsDataSize));
+  ctx->EncodedBuffer.Resize(actualJpegLsDataSize);
+}
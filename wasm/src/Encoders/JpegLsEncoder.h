@@ -0,0 +1,8 @@
+#pragma once
+
+#include "CodecsContext.h"
+#include "EncoderParameters.h"
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void EncodeJpegLsImpl(CodecsContext *ctx, EncoderParameters *params);
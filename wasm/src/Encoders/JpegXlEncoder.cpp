@@ -4,16 +4,239 @@
 #include <stdexcept>
 #include <vector>
 
+#include "CodecsArena.h"
 #include "Exception.h"
+#include "JpegXlParallelRunner.h"
 #include "Logging.h"
 #include "jxl/encode.h"
 #include "jxl/types.h"
 
 using namespace std;
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegXlEncoderSession : public CodecSession {
+  ~JpegXlEncoderSession() override {
+    if (Encoder) {
+      JxlEncoderDestroy(Encoder);
+    }
+  }
+
+  JpegXlParallelRunner Runner;
+
+  // Encoder, reset between the frames of the session
+  JxlEncoder* Encoder = nullptr;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static JxlEncoder* ResetJpegXlEncoder(JpegXlEncoderSession* session,
+                                      size_t const threadCount,
+                                      string const& name) {
+  // The encoder is created once per session and only reset for the next
+  // frame. It outlives the call, so it stays on the general heap rather than
+  // on the codecs arena.
+  if (session->Encoder) {
+    JxlEncoderReset(session->Encoder);
+  } else {
+    session->Encoder = JxlEncoderCreate(nullptr);
+    if (!session->Encoder) {
+      ThrowCodecsException(name +
+                           "::JxlEncoderCreate::Failed to create encoder");
+    }
+  }
+
+  // JxlEncoderReset also detaches the parallel runner
+  if (!session->Runner.Attach(session->Encoder, threadCount)) {
+    ThrowCodecsException(name + "::JxlEncoderSetParallelRunner::Failed");
+  }
+
+  return session->Encoder;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static bool ProcessJpegXlEncoderOutput(JxlEncoder* enc,
+                                       vector<uint8_t>& outputBuffer) {
+  outputBuffer.resize(65536);
+  auto* nextOut = outputBuffer.data();
+  auto availOut = outputBuffer.size();
+  JxlEncoderStatus status = JXL_ENC_NEED_MORE_OUTPUT;
+
+  while (status == JXL_ENC_NEED_MORE_OUTPUT) {
+    status = JxlEncoderProcessOutput(enc, &nextOut, &availOut);
+    if (status == JXL_ENC_NEED_MORE_OUTPUT) {
+      size_t const offset = nextOut - outputBuffer.data();
+      outputBuffer.resize(outputBuffer.size() * 2);
+      nextOut = outputBuffer.data() + offset;
+      availOut = outputBuffer.size() - offset;
+    }
+  }
+
+  outputBuffer.resize(nextOut - outputBuffer.data());
+
+  return status == JXL_ENC_SUCCESS;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegXlFrameInput {
+  uint8_t const* Data = nullptr;
+  size_t PixelStride = 0;
+  size_t RowStride = 0;
+  // Distance between the component planes of planar frames, 0 otherwise
+  size_t PlaneStride = 0;
+  JxlPixelFormat PixelFormat = {};
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+template <typename T>
+static void InterleaveJpegXlRect(JpegXlFrameInput const* input,
+                                 size_t const xpos, size_t const ypos,
+                                 size_t const xsize, size_t const ysize,
+                                 uint8_t* destination) {
+  auto const samplesPerPixel = input->PixelFormat.num_channels;
+  auto* dp = reinterpret_cast<T*>(destination);
+  for (auto y = ypos; y < ypos + ysize; y++) {
+    auto const* row = input->Data + y * input->RowStride + xpos * sizeof(T);
+    for (auto c = 0u; c < samplesPerPixel; c++) {
+      auto const* sp = reinterpret_cast<T const*>(row + c * input->PlaneStride);
+      for (auto x = 0u; x < xsize; x++) {
+        dp[x * samplesPerPixel + c] = sp[x];
+      }
+    }
+    dp += xsize * samplesPerPixel;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void GetJpegXlFramePixelFormat(void* opaque,
+                                      JxlPixelFormat* pixelFormat) {
+  *pixelFormat = static_cast<JpegXlFrameInput*>(opaque)->PixelFormat;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void const* GetJpegXlFrameDataAt(void* opaque, size_t const xpos,
+                                        size_t const ypos, size_t const xsize,
+                                        size_t const ysize,
+                                        size_t* rowOffset) {
+  auto const* input = static_cast<JpegXlFrameInput*>(opaque);
+
+  // Interleaved rectangles are served in place from the decoded buffer, so
+  // no pixels are copied on this side
+  if (input->PlaneStride == 0) {
+    *rowOffset = input->RowStride;
+    return input->Data + ypos * input->RowStride + xpos * input->PixelStride;
+  }
+
+  // libjxl only takes interleaved color channels, so the rectangles of planar
+  // frames are interleaved as they are requested. Groups may be requested
+  // from several threads at once, so each gets its own buffer.
+  *rowOffset = xsize * input->PixelStride;
+  auto* rect = static_cast<uint8_t*>(
+      GetCodecsArena().Allocate(ysize * xsize * input->PixelStride));
+  if (!rect) {
+    return nullptr;
+  }
+  if (input->PixelFormat.data_type == JXL_TYPE_UINT8) {
+    InterleaveJpegXlRect<uint8_t>(input, xpos, ypos, xsize, ysize, rect);
+  } else {
+    InterleaveJpegXlRect<uint16_t>(input, xpos, ypos, xsize, ysize, rect);
+  }
+
+  return rect;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void GetJpegXlExtraChannelPixelFormat(void*, size_t, JxlPixelFormat*) {}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void const* GetJpegXlExtraChannelDataAt(void*, size_t, size_t, size_t,
+                                               size_t, size_t, size_t*) {
+  return nullptr;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ReleaseJpegXlFrameData(void* opaque, void const* data) {
+  if (static_cast<JpegXlFrameInput*>(opaque)->PlaneStride != 0) {
+    GetCodecsArena().Free(const_cast<void*>(data));
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegXlOutput {
+  Buffer* Target = nullptr;
+  size_t Position = 0;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void* GetJpegXlOutputBuffer(void* opaque, size_t* size) {
+  auto* output = static_cast<JpegXlOutput*>(opaque);
+  auto& target = *output->Target;
+
+  // The codestream is written straight into the encoded buffer, which only
+  // grows (by doubling) when the suggested chunk does not fit
+  auto const required = output->Position + max<size_t>(*size, 1);
+  if (required > target.GetCapacity()) {
+    target.Reserve(max(required, target.GetCapacity() * 2));
+  }
+  *size = target.GetCapacity() - output->Position;
+
+  return target.GetData() + output->Position;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void ReleaseJpegXlOutputBuffer(void* opaque, size_t const writtenBytes) {
+  auto* output = static_cast<JpegXlOutput*>(opaque);
+  output->Position += writtenBytes;
+
+  // The buffer size tracks the furthest byte written, as the encoder may seek
+  // back to patch the headers
+  if (output->Position > output->Target->GetSize()) {
+    output->Target->Resize(output->Position);
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void SeekJpegXlOutput(void* opaque, uint64_t const position) {
+  static_cast<JpegXlOutput*>(opaque)->Position = static_cast<size_t>(position);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void SetJpegXlOutputFinalizedPosition(void*, uint64_t) {}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void SetJpegXlFrameSetting(JxlEncoderFrameSettings* frameSettings,
+                                  JxlEncoderFrameSettingId const option,
+                                  int64_t const value, string const& name) {
+  // Negative values leave the libjxl default in place
+  if (value < 0) {
+    return;
+  }
+  if (JxlEncoderFrameSettingsSetOption(frameSettings, option, value) !=
+      JXL_ENC_SUCCESS) {
+    ThrowCodecsException(name +
+                         "::JxlEncoderFrameSettingsSetOption::Invalid value " +
+                         to_string(value));
+  }
+}
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void EncodeJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
+  auto session = GetCodecSession<JpegXlEncoderSession>(ctx->EncoderSession);
   auto const width = GetColumns(ctx);
   auto const height = GetRows(ctx);
   auto const samplesPerPixel = GetSamplesPerPixel(ctx);
@@ -22,11 +245,7 @@ void EncodeJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
   auto const* pixelData = GetDecodedBuffer(ctx);
   auto const pixelDataSize = GetDecodedBufferSize(ctx);
 
-  auto* enc = JxlEncoderCreate(nullptr);
-  if (!enc) {
-    ThrowCodecsException(
-        "EncodeJpegXl::JxlEncoderCreate::Failed to create encoder");
-  }
+  auto* enc = ResetJpegXlEncoder(session, params->ThreadCount, "EncodeJpegXl");
 
   JxlBasicInfo basicInfo;
   JxlEncoderInitBasicInfo(&basicInfo);
@@ -39,7 +258,6 @@ void EncodeJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
   basicInfo.uses_original_profile = JXL_TRUE;
 
   if (JxlEncoderSetBasicInfo(enc, &basicInfo) != JXL_ENC_SUCCESS) {
-    JxlEncoderDestroy(enc);
     ThrowCodecsException(
         "EncodeJpegXl::JxlEncoderSetBasicInfo::Failed to set basic info");
   }
@@ -55,7 +273,6 @@ void EncodeJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
   colorEncoding.rendering_intent = JXL_RENDERING_INTENT_RELATIVE;
 
   if (JxlEncoderSetColorEncoding(enc, &colorEncoding) != JXL_ENC_SUCCESS) {
-    JxlEncoderDestroy(enc);
     ThrowCodecsException(
         "EncodeJpegXl::JxlEncoderSetColorEncoding::Failed to set color "
         "encoding");
@@ -63,16 +280,43 @@ void EncodeJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
 
   auto* frameSettings = JxlEncoderFrameSettingsCreate(enc, nullptr);
   if (!frameSettings) {
-    JxlEncoderDestroy(enc);
     ThrowCodecsException(
         "EncodeJpegXl::JxlEncoderFrameSettingsCreate::Failed to create frame "
         "settings");
   }
 
+  SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_EFFORT,
+                        static_cast<int64_t>(params->Effort), "EncodeJpegXl");
+  SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_DECODING_SPEED,
+                        static_cast<int64_t>(params->DecodingSpeed),
+                        "EncodeJpegXl");
+  SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_MODULAR,
+                        params->Modular, "EncodeJpegXl");
+  SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_MODULAR_PREDICTOR,
+                        params->ModularPredictor, "EncodeJpegXl");
+  SetJpegXlFrameSetting(frameSettings,
+                        JXL_ENC_FRAME_SETTING_MODULAR_GROUP_SIZE,
+                        params->ModularGroupSize, "EncodeJpegXl");
+  SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_BROTLI_EFFORT,
+                        params->BrotliEffort, "EncodeJpegXl");
+
+  // Responsive (squeezed) modular data and progressive DC/AC let a viewer
+  // render a 1:8 preview from the first few KB. Streaming encoding does not
+  // keep that order, so the frame is buffered as a whole in this case.
+  if (params->Progressive) {
+    SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_RESPONSIVE, 1,
+                          "EncodeJpegXl");
+    SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_PROGRESSIVE_DC,
+                          1, "EncodeJpegXl");
+    SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_PROGRESSIVE_AC,
+                          1, "EncodeJpegXl");
+    SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_BUFFERING, 0,
+                          "EncodeJpegXl");
+  }
+
   if (!params->Lossy) {
     if (JxlEncoderSetFrameLossless(frameSettings, JXL_TRUE) !=
         JXL_ENC_SUCCESS) {
-      JxlEncoderDestroy(enc);
       ThrowCodecsException("EncodeJpegXl::JxlEncoderSetFrameLossless::Failed");
     }
   } else {
@@ -85,7 +329,6 @@ void EncodeJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
     }
     if (JxlEncoderSetFrameDistance(frameSettings, distance) !=
         JXL_ENC_SUCCESS) {
-      JxlEncoderDestroy(enc);
       ThrowCodecsException("EncodeJpegXl::JxlEncoderSetFrameDistance::Failed");
     }
   }
@@ -96,49 +339,112 @@ void EncodeJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
   bitDepth.exponent_bits_per_sample = 0;
 
   if (JxlEncoderSetFrameBitDepth(frameSettings, &bitDepth) != JXL_ENC_SUCCESS) {
-    JxlEncoderDestroy(enc);
     ThrowCodecsException("EncodeJpegXl::JxlEncoderSetFrameBitDepth::Failed");
   }
 
-  JxlPixelFormat pixelFormat = {};
-  pixelFormat.num_channels = static_cast<uint32_t>(samplesPerPixel);
-  pixelFormat.data_type = bitsAllocated <= 8 ? JXL_TYPE_UINT8 : JXL_TYPE_UINT16;
-  pixelFormat.endianness = JXL_NATIVE_ENDIAN;
-  pixelFormat.align = 0;
+  JpegXlOutput output;
+  output.Target = &ctx->EncodedBuffer;
+  output.Target->Resize(0);
+  output.Target->Reserve(max<size_t>(pixelDataSize / 4, 65536));
 
-  if (JxlEncoderAddImageFrame(frameSettings, &pixelFormat, pixelData,
-                              pixelDataSize) != JXL_ENC_SUCCESS) {
-    JxlEncoderDestroy(enc);
+  JxlEncoderOutputProcessor outputProcessor = {};
+  outputProcessor.opaque = &output;
+  outputProcessor.get_buffer = GetJpegXlOutputBuffer;
+  outputProcessor.release_buffer = ReleaseJpegXlOutputBuffer;
+  outputProcessor.seek = SeekJpegXlOutput;
+  outputProcessor.set_finalized_position = SetJpegXlOutputFinalizedPosition;
+
+  if (JxlEncoderSetOutputProcessor(enc, outputProcessor) != JXL_ENC_SUCCESS) {
+    ThrowCodecsException("EncodeJpegXl::JxlEncoderSetOutputProcessor::Failed");
+  }
+
+  auto const bytesPerSample = bitsAllocated <= 8 ? 1u : 2u;
+  auto const isPlanar =
+      samplesPerPixel > 1 &&
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Planar;
+
+  JpegXlFrameInput input;
+  input.Data = pixelData;
+  input.PixelStride = samplesPerPixel * bytesPerSample;
+  input.RowStride = width * (isPlanar ? bytesPerSample : input.PixelStride);
+  input.PlaneStride = isPlanar ? width * height * bytesPerSample : 0;
+  input.PixelFormat.num_channels = static_cast<uint32_t>(samplesPerPixel);
+  input.PixelFormat.data_type =
+      bitsAllocated <= 8 ? JXL_TYPE_UINT8 : JXL_TYPE_UINT16;
+  input.PixelFormat.endianness = JXL_NATIVE_ENDIAN;
+  input.PixelFormat.align = 0;
+
+  if (pixelDataSize < width * height * input.PixelStride) {
     ThrowCodecsException(
-        "EncodeJpegXl::JxlEncoderAddImageFrame::Failed to add image frame");
+        "EncodeJpegXl::Decoded buffer is smaller than the frame");
   }
 
-  JxlEncoderCloseInput(enc);
+  JxlChunkedFrameInputSource inputSource = {};
+  inputSource.opaque = &input;
+  inputSource.get_color_channels_pixel_format = GetJpegXlFramePixelFormat;
+  inputSource.get_color_channel_data_at = GetJpegXlFrameDataAt;
+  inputSource.get_extra_channel_pixel_format = GetJpegXlExtraChannelPixelFormat;
+  inputSource.get_extra_channel_data_at = GetJpegXlExtraChannelDataAt;
+  inputSource.release_buffer = ReleaseJpegXlFrameData;
 
-  vector<uint8_t> outputBuffer(65536);
-  auto* nextOut = outputBuffer.data();
-  auto availOut = outputBuffer.size();
-  JxlEncoderStatus status = JXL_ENC_NEED_MORE_OUTPUT;
+  // With an output processor set, the chunked frame is encoded group by group
+  // (for frames larger than 2048x2048, by default) and the input is closed
+  // and flushed here
+  if (JxlEncoderAddChunkedFrame(frameSettings, JXL_TRUE, inputSource) !=
+      JXL_ENC_SUCCESS) {
+    ThrowCodecsException(
+        "EncodeJpegXl::JxlEncoderAddChunkedFrame::Encoding failed");
+  }
+}
 
-  while (status == JXL_ENC_NEED_MORE_OUTPUT) {
-    status = JxlEncoderProcessOutput(enc, &nextOut, &availOut);
-    if (status == JXL_ENC_NEED_MORE_OUTPUT) {
-      size_t const offset = nextOut - outputBuffer.data();
-      outputBuffer.resize(outputBuffer.size() * 2);
-      nextOut = outputBuffer.data() + offset;
-      availOut = outputBuffer.size() - offset;
-    }
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void TranscodeJpegToJpegXlImpl(CodecsContext* ctx, EncoderParameters* params) {
+  auto session = GetCodecSession<JpegXlEncoderSession>(ctx->EncoderSession);
+  auto const* jpegData = GetEncodedBuffer(ctx);
+  auto const jpegDataSize = GetEncodedBufferSize(ctx);
+
+  auto* enc = ResetJpegXlEncoder(session, params->ThreadCount,
+                                 "TranscodeJpegToJpegXl");
+
+  // Stores the JPEG bitstream reconstruction data (jbrd box), which allows the
+  // original JPEG file to be restored bit-exactly
+  if (JxlEncoderStoreJPEGMetadata(enc, JXL_TRUE) != JXL_ENC_SUCCESS) {
+    ThrowCodecsException(
+        "TranscodeJpegToJpegXl::JxlEncoderStoreJPEGMetadata::Failed");
   }
 
-  if (status != JXL_ENC_SUCCESS) {
-    JxlEncoderDestroy(enc);
+  auto* frameSettings = JxlEncoderFrameSettingsCreate(enc, nullptr);
+  if (!frameSettings) {
     ThrowCodecsException(
-        "EncodeJpegXl::JxlEncoderProcessOutput::Encoding failed");
+        "TranscodeJpegToJpegXl::JxlEncoderFrameSettingsCreate::Failed to "
+        "create frame settings");
   }
 
-  size_t const encodedSize = nextOut - outputBuffer.data();
-  JxlEncoderDestroy(enc);
+  // Only the entropy coding effort and the Brotli compression of the
+  // reconstruction data apply when the DCT coefficients are kept as-is
+  SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_EFFORT,
+                        static_cast<int64_t>(params->Effort),
+                        "TranscodeJpegToJpegXl");
+  SetJpegXlFrameSetting(frameSettings, JXL_ENC_FRAME_SETTING_BROTLI_EFFORT,
+                        params->BrotliEffort, "TranscodeJpegToJpegXl");
+
+  // The DCT coefficients are taken over as-is, without decoding the pixels
+  if (JxlEncoderAddJPEGFrame(frameSettings, jpegData, jpegDataSize) !=
+      JXL_ENC_SUCCESS) {
+    ThrowCodecsException(
+        "TranscodeJpegToJpegXl::JxlEncoderAddJPEGFrame::Failed to add JPEG "
+        "frame");
+  }
+
+  JxlEncoderCloseInput(enc);
+
+  vector<uint8_t> outputBuffer;
+  if (!ProcessJpegXlEncoderOutput(enc, outputBuffer)) {
+    ThrowCodecsException(
+        "TranscodeJpegToJpegXl::JxlEncoderProcessOutput::Encoding failed");
+  }
 
-  SetEncodedBufferSize(ctx, encodedSize);
-  memcpy(GetEncodedBuffer(ctx), outputBuffer.data(), encodedSize);
+  SetEncodedBufferSize(ctx, outputBuffer.size());
+  memcpy(GetEncodedBuffer(ctx), outputBuffer.data(), outputBuffer.size());
 }
@@ -6,3 +6,7 @@
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void EncodeJpegXlImpl(CodecsContext *ctx, EncoderParameters *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void TranscodeJpegToJpegXlImpl(CodecsContext *ctx, EncoderParameters *params);
@@ -10,144 +10,163 @@ using namespace std;
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-RleEncoder::RleEncoder()
-    : segmentCount_(0),
-      offsets_{},
-      buffer_{},
-      prevByte_(-1),
-      repeatCount_(0),
-      bufferPos_(0) {}
+#define RLE_HEADER_SIZE 64
+#define RLE_MAX_RUN_LENGTH 128
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-RleEncoder::~RleEncoder() {}
+size_t RleEncoder::GetMaximumSegmentLength(size_t const planeLength) {
+  auto const length =
+      planeLength + (planeLength + RLE_MAX_RUN_LENGTH - 1) / RLE_MAX_RUN_LENGTH;
 
-//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void RleEncoder::NextSegment() {
-  Flush();
-  if ((GetLength() & 1) == 1) {
-    writer_.WriteByte(0x00);
-  }
-  offsets_[segmentCount_++] = static_cast<int32_t>(writer_.Tell());
+  return length + (length & 1);
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void RleEncoder::Encode(const uint8_t b) {
-  if (b == prevByte_) {
-    repeatCount_++;
-
-    if (repeatCount_ > 2 && bufferPos_ > 0) {
-      while (bufferPos_ > 0) {
-        auto const count = min(128, bufferPos_);
-        writer_.WriteByte(static_cast<uint8_t>(count - 1));
-        MoveBuffer(count);
-      }
-    } else if (repeatCount_ > 128) {
-      auto const count = min(repeatCount_, 128);
-      writer_.WriteByte(static_cast<uint8_t>(257 - count));
-      writer_.WriteByte(static_cast<uint8_t>(prevByte_));
-      repeatCount_ -= count;
-    }
-  } else {
-    switch (repeatCount_) {
-      case 0:
-        break;
-      case 1: {
-        buffer_[bufferPos_++] = static_cast<uint8_t>(prevByte_);
-        break;
-      }
-      case 2: {
-        buffer_[bufferPos_++] = static_cast<uint8_t>(prevByte_);
-        buffer_[bufferPos_++] = static_cast<uint8_t>(prevByte_);
-        break;
-      }
-      default: {
-        while (repeatCount_ > 0) {
-          auto const count = min(repeatCount_, 128);
-          writer_.WriteByte(static_cast<uint8_t>(257 - count));
-          writer_.WriteByte(static_cast<uint8_t>(prevByte_));
-          repeatCount_ -= count;
-        }
-        break;
-      }
+size_t RleEncoder::GetRunLength(uint8_t const *data, size_t const length) {
+  // Compares eight bytes at a time against the first one, and locates the
+  // first mismatch from the trailing zero bits of the difference
+  auto const maxLength = min<size_t>(length, RLE_MAX_RUN_LENGTH);
+  auto const pattern = data[0] * 0x0101010101010101ull;
+  size_t run = 1;
+  while (run + 8 <= maxLength) {
+    uint64_t word;
+    memcpy(&word, &data[run], sizeof(word));
+    auto const diff = word ^ pattern;
+    if (diff != 0) {
+      return run + (__builtin_ctzll(diff) >> 3);
     }
-
-    while (bufferPos_ > 128) {
-      auto const count = min(128, bufferPos_);
-      writer_.WriteByte(static_cast<uint8_t>(count - 1));
-      MoveBuffer(count);
-    }
-
-    prevByte_ = b;
-    repeatCount_ = 1;
+    run += 8;
+  }
+  while (run < maxLength && data[run] == data[0]) {
+    run++;
   }
+
+  return run;
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void RleEncoder::MakeEvenLength() {
-  if (writer_.Tell() % 2 == 1) {
-    writer_.WriteByte(0);
+uint8_t *RleEncoder::WriteLiteralRuns(uint8_t const *data, size_t length,
+                                      uint8_t *segment) {
+  while (length > 0) {
+    auto const count = min<size_t>(length, RLE_MAX_RUN_LENGTH);
+    *segment++ = static_cast<uint8_t>(count - 1);
+    memcpy(segment, data, count);
+    segment += count;
+    data += count;
+    length -= count;
   }
+
+  return segment;
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void RleEncoder::Flush() {
-  if (repeatCount_ < 2) {
-    while (repeatCount_ > 0) {
-      buffer_[bufferPos_++] = static_cast<uint8_t>(prevByte_);
-      repeatCount_--;
-    }
-  }
+size_t RleEncoder::EncodeSegment(uint8_t const *plane,
+                                 size_t const planeLength, uint8_t *segment) {
+  auto const pSegmentStart = segment;
+  size_t literalStart = 0;
+  size_t i = 0;
 
-  while (bufferPos_ > 0) {
-    auto const count = min(128, bufferPos_);
-    writer_.WriteByte(static_cast<uint8_t>(count - 1));
-    MoveBuffer(count);
+  while (i < planeLength) {
+    // Literal bytes are skipped without measuring a run
+    if ((i + 1) < planeLength && plane[i] != plane[i + 1]) {
+      i++;
+      continue;
+    }
+    auto const run = GetRunLength(&plane[i], planeLength - i);
+    // A two byte run is only worth a replicate run when it does not split
+    // a literal run
+    if (run >= 3 || (run == 2 && literalStart == i)) {
+      segment =
+          WriteLiteralRuns(&plane[literalStart], i - literalStart, segment);
+      *segment++ = static_cast<uint8_t>(257 - run);
+      *segment++ = plane[i];
+      i += run;
+      literalStart = i;
+    } else {
+      i += run;
+    }
   }
+  segment = WriteLiteralRuns(&plane[literalStart], i - literalStart, segment);
 
-  if (repeatCount_ >= 2) {
-    while (repeatCount_ > 0) {
-      auto const count = min(repeatCount_, 128);
-      writer_.WriteByte(static_cast<uint8_t>(257 - count));
-      writer_.WriteByte(static_cast<uint8_t>(prevByte_));
-      repeatCount_ -= count;
-    }
+  if (((segment - pSegmentStart) & 1) == 1) {
+    *segment++ = 0x00;
   }
 
-  prevByte_ = -1;
-  repeatCount_ = 0;
-  bufferPos_ = 0;
+  return static_cast<size_t>(segment - pSegmentStart);
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void RleEncoder::MoveBuffer(int count) {
-  for (auto i = 0; i < count; i++) {
-    writer_.WriteByte(buffer_[i]);
-  }
-  for (auto i = count, n = 0; i < bufferPos_; i++, n++) {
-    buffer_[n] = buffer_[i];
-  }
-  bufferPos_ = bufferPos_ - count;
-}
+struct RleEncoderSession : public CodecSession {
+  // Byte plane of the segment being encoded, when it is not contiguous in
+  // the decoded buffer. The capacity grown by the previous frames is kept.
+  vector<uint8_t> plane;
+};
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-void RleEncoder::WriteHeader() {
-  vector<uint8_t> tmp;
-  tmp.assign(writer_.GetData(), writer_.GetData() + writer_.Tell());
-  writer_.Reset();
-
-  writer_.WriteUInt32(segmentCount_);
-  for (auto i = 0; i < segmentCount_; i++) {
-    offsets_[i] += sizeof(uint32_t) + 15 * sizeof(int32_t);
+void EncodeRleImpl(CodecsContext *ctx, EncoderParameters *params) {
+  auto session = GetCodecSession<RleEncoderSession>(ctx->EncoderSession);
+
+  auto const bytesAllocated =
+      (GetBitsAllocated(ctx) / 8) + ((GetBitsAllocated(ctx) % 8 == 0) ? 0 : 1);
+  auto const pixelCount = GetColumns(ctx) * GetRows(ctx);
+  auto const numberOfSegments = bytesAllocated * GetSamplesPerPixel(ctx);
+  if (numberOfSegments < 1 || numberOfSegments > 15) {
+    ThrowCodecsException("EncodeRle::Invalid number of segments (" +
+                         to_string(numberOfSegments) + ")");
   }
-  for (auto i = 0; i < 15; i++) {
-    writer_.WriteInt32(offsets_[i]);
+  if (GetDecodedBufferSize(ctx) < pixelCount * numberOfSegments) {
+    ThrowCodecsException("EncodeRle::Frame buffer is smaller than expected");
   }
-  writer_.WriteBytes(tmp.data(), tmp.size());
+
+  // The header is reserved up front and segments are written straight into
+  // the encoded buffer, sized for the worst case
+  ctx->EncodedBuffer.Resize(
+      RLE_HEADER_SIZE +
+      numberOfSegments * RleEncoder::GetMaximumSegmentLength(pixelCount));
+  auto const pDest = GetEncodedBuffer(ctx);
+  auto const pSource = GetDecodedBuffer(ctx);
+
+  auto const stride =
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Interleaved
+          ? GetSamplesPerPixel(ctx) * bytesAllocated
+          : bytesAllocated;
+  if (stride > 1) {
+    session->plane.resize(pixelCount);
+  }
+
+  uint32_t header[RLE_HEADER_SIZE / sizeof(uint32_t)] = {};
+  header[0] = static_cast<uint32_t>(numberOfSegments);
+  size_t length = RLE_HEADER_SIZE;
+  for (size_t s = 0; s < numberOfSegments; s++) {
+    auto const sample = s / bytesAllocated;
+    auto const sabyte = s % bytesAllocated;
+
+    auto pos =
+        GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Interleaved
+            ? sample * bytesAllocated
+            : sample * bytesAllocated * pixelCount;
+    pos += bytesAllocated - sabyte - 1;
+
+    // Strided segments are gathered into a contiguous byte plane first
+    auto pPlane = &pSource[pos];
+    if (stride > 1) {
+      auto const pGather = session->plane.data();
+      for (size_t p = 0; p < pixelCount; p++) {
+        pGather[p] = pPlane[p * stride];
+      }
+      pPlane = pGather;
+    }
+
+    header[s + 1] = static_cast<uint32_t>(length);
+    length += RleEncoder::EncodeSegment(pPlane, pixelCount, &pDest[length]);
+  }
+
+  memcpy(pDest, header, RLE_HEADER_SIZE);
+  ctx->EncodedBuffer.Resize(length);
 }
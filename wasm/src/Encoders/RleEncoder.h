@@ -1,78 +1,30 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+#include "CodecsContext.h"
+#include "EncoderParameters.h"
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-struct ByteWriter {
+class RleEncoder {
  public:
-  ByteWriter(const size_t size = 65536) {
-    buffer_.resize(0);
-    buffer_.reserve(size);
-  }
-  virtual ~ByteWriter() {}
-
-  void Reset() { buffer_.clear(); }
-  size_t Tell() const { return buffer_.size(); }
-
-  void WriteUInt32(const uint32_t value) { Write(&value, sizeof(uint32_t)); }
-  void WriteInt32(const int32_t value) { Write(&value, sizeof(int32_t)); }
-  void WriteByte(const uint8_t value) { Write(&value, sizeof(uint8_t)); }
-  void WriteBytes(uint8_t const *values, const size_t size) {
-    for (auto i = 0u; i < size; i++) {
-      WriteByte(values[i]);
-    }
-  }
-
-  uint8_t *GetData() { return buffer_.data(); }
+  RleEncoder() = delete;
 
-  ByteWriter(ByteWriter const &) = delete;
-  ByteWriter &operator=(ByteWriter const &) = delete;
+  // Worst case length of an encoded segment, all literal runs plus padding
+  static size_t GetMaximumSegmentLength(size_t planeLength);
+  // Encodes a contiguous byte plane into an even length segment, and returns
+  // the number of bytes written
+  static size_t EncodeSegment(uint8_t const *plane, size_t planeLength,
+                              uint8_t *segment);
 
  private:
-  std::vector<uint8_t> buffer_;
-
-  size_t Write(void const *ptr, const size_t size) {
-    auto const bytes = static_cast<uint8_t const *>(ptr);
-    buffer_.insert(buffer_.end(), bytes, bytes + size);
-
-    return size;
-  }
+  static size_t GetRunLength(uint8_t const *data, size_t length);
+  static uint8_t *WriteLiteralRuns(uint8_t const *data, size_t length,
+                                   uint8_t *segment);
 };
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-class RleEncoder {
- public:
-  RleEncoder();
-  ~RleEncoder();
-
-  uint32_t GetNumberOfSegments() const { return segmentCount_; }
-  uint8_t *GetBuffer() {
-    Flush();
-    WriteHeader();
-
-    return writer_.GetData();
-  }
-  size_t GetLength() const { return writer_.Tell(); }
-
-  void NextSegment();
-  void Encode(uint8_t b);
-  void MakeEvenLength();
-  void Flush();
-
-  RleEncoder(RleEncoder const &) = delete;
-  RleEncoder &operator=(RleEncoder const &) = delete;
-
- private:
-  uint32_t segmentCount_;
-  int32_t offsets_[15];
-  uint8_t buffer_[132];
-  int32_t prevByte_;
-  int32_t repeatCount_;
-  int32_t bufferPos_;
-  ByteWriter writer_;
-
-  void MoveBuffer(int count);
-  void WriteHeader();
-};
+void EncodeRleImpl(CodecsContext *ctx, EncoderParameters *params);
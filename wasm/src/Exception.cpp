@@ -4,6 +4,8 @@
 
 #include <stdexcept>
 
+#include "CodecsArena.h"
+
 using namespace std;
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -13,6 +15,10 @@ EM_JS(void, onCodecsException, (char const *message, size_t const len), {});
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void ThrowCodecsException(string const &message) {
+  // The JS exception thrown by onCodecsException does not unwind the C++
+  // stack, exception catching being disabled, so the arena scopes of the call
+  // are never left
+  GetCodecsArena().AbandonScopes();
   onCodecsException(message.c_str(), message.length());
 
   throw runtime_error(message);
@@ -1,6 +1,7 @@
 #include "Jpeg2000Buffer.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 
 #include "Exception.h"
@@ -8,85 +9,136 @@
 
 using namespace std;
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+Jpeg2000ReadBuffer::Jpeg2000ReadBuffer(vector<Jpeg2000Fragment> fragments)
+    : Fragments(std::move(fragments)) {
+  for (auto const &fragment : Fragments) {
+    Size += fragment.Size;
+  }
+}
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 OPJ_SIZE_T OpjReadFromMemory(void *pBuffer, OPJ_SIZE_T nBytes,
-                             Jpeg2000Buffer *pEncodedBuffer) {
-  if (!pEncodedBuffer || !pEncodedBuffer->SrcData ||
-      pEncodedBuffer->SrcSize == 0) {
+                             Jpeg2000ReadBuffer *pReadBuffer) {
+  if (!pReadBuffer || pReadBuffer->Offset >= pReadBuffer->Size) {
     return static_cast<OPJ_SIZE_T>(-1);
   }
-  if (pEncodedBuffer->Offset >= pEncodedBuffer->SrcSize) {
-    return static_cast<OPJ_SIZE_T>(-1);
+
+  // The fragment cursor only moves forward, unless the stream was rewound
+  if (pReadBuffer->Offset < pReadBuffer->FragmentStart) {
+    pReadBuffer->Fragment = 0;
+    pReadBuffer->FragmentStart = 0;
   }
 
-  auto const bufferLength = pEncodedBuffer->SrcSize - pEncodedBuffer->Offset;
-  auto const readLength = nBytes < bufferLength ? nBytes : bufferLength;
-  memcpy(pBuffer, &pEncodedBuffer->SrcData[pEncodedBuffer->Offset], readLength);
-  pEncodedBuffer->Offset += readLength;
+  auto *pDestination = static_cast<uint8_t *>(pBuffer);
+  auto const readLength = min(nBytes, pReadBuffer->Size - pReadBuffer->Offset);
+  OPJ_SIZE_T readBytes = 0;
+  while (readBytes < readLength) {
+    while (pReadBuffer->Offset >=
+           pReadBuffer->FragmentStart +
+               pReadBuffer->Fragments[pReadBuffer->Fragment].Size) {
+      pReadBuffer->FragmentStart +=
+          pReadBuffer->Fragments[pReadBuffer->Fragment].Size;
+      pReadBuffer->Fragment++;
+    }
+    auto const &fragment = pReadBuffer->Fragments[pReadBuffer->Fragment];
+    auto const fragmentOffset =
+        pReadBuffer->Offset - pReadBuffer->FragmentStart;
+    auto const length =
+        min(readLength - readBytes, fragment.Size - fragmentOffset);
+    memcpy(pDestination + readBytes, fragment.Data + fragmentOffset, length);
+    readBytes += length;
+    pReadBuffer->Offset += length;
+  }
 
-  return readLength;
+  return readBytes;
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-OPJ_SIZE_T OpjWriteToMemory(void *pBuffer, OPJ_SIZE_T nBytes,
-                            Jpeg2000Buffer *pJpeg2000Buffer) {
-  if (!pJpeg2000Buffer || !pJpeg2000Buffer->SrcData ||
-      pJpeg2000Buffer->SrcSize == 0) {
-    return static_cast<OPJ_SIZE_T>(-1);
+OPJ_OFF_T OpjSkipFromMemory(OPJ_OFF_T nBytes, Jpeg2000ReadBuffer *pReadBuffer) {
+  if (!pReadBuffer || nBytes < 0) {
+    return static_cast<OPJ_OFF_T>(-1);
   }
-  if (pJpeg2000Buffer->Offset >= pJpeg2000Buffer->SrcSize) {
-    return static_cast<OPJ_SIZE_T>(-1);
+
+  auto const skipLength = min(static_cast<OPJ_SIZE_T>(nBytes),
+                              pReadBuffer->Size - pReadBuffer->Offset);
+  pReadBuffer->Offset += skipLength;
+
+  return static_cast<OPJ_OFF_T>(skipLength);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+OPJ_BOOL OpjSeekFromMemory(OPJ_OFF_T nBytes, Jpeg2000ReadBuffer *pReadBuffer) {
+  if (!pReadBuffer || nBytes < 0) {
+    return OPJ_FALSE;
   }
 
-  auto const bufferLength = pJpeg2000Buffer->SrcSize - pJpeg2000Buffer->Offset;
-  auto const writeLength = nBytes < bufferLength ? nBytes : bufferLength;
-  memcpy(&pJpeg2000Buffer->SrcData[pJpeg2000Buffer->Offset], pBuffer,
-         writeLength);
-  pJpeg2000Buffer->Offset += writeLength;
+  pReadBuffer->Offset = min(static_cast<OPJ_SIZE_T>(nBytes), pReadBuffer->Size);
 
-  return writeLength;
+  return OPJ_TRUE;
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-OPJ_OFF_T OpjSkipFromMemory(OPJ_OFF_T nBytes, Jpeg2000Buffer *pJpeg2000Buffer) {
-  if (!pJpeg2000Buffer || !pJpeg2000Buffer->SrcData ||
-      pJpeg2000Buffer->SrcSize == 0) {
-    return static_cast<OPJ_SIZE_T>(-1);
+// Grows the target to hold end bytes, by doubling, zero filling any gap left
+// by a skip or a seek past the written length
+static void GrowJpeg2000WriteBuffer(Jpeg2000WriteBuffer *pWriteBuffer,
+                                    OPJ_SIZE_T const end) {
+  auto &target = *pWriteBuffer->Target;
+  if (end > target.GetCapacity()) {
+    target.Reserve(max(end, target.GetCapacity() * 2));
   }
-  if (nBytes < 0) {
-    return static_cast<OPJ_SIZE_T>(-1);
+  if (end > target.GetSize()) {
+    auto const size = target.GetSize();
+    target.Resize(end);
+    memset(target.GetData() + size, 0, end - size);
   }
-  if (pJpeg2000Buffer->Offset > numeric_limits<OPJ_SIZE_T>::max() - nBytes) {
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+OPJ_SIZE_T OpjWriteToMemory(void *pBuffer, OPJ_SIZE_T nBytes,
+                            Jpeg2000WriteBuffer *pWriteBuffer) {
+  if (!pWriteBuffer || pWriteBuffer->Offset >
+                           numeric_limits<OPJ_SIZE_T>::max() - nBytes) {
     return static_cast<OPJ_SIZE_T>(-1);
   }
 
-  auto const newOffset = pJpeg2000Buffer->Offset + nBytes;
-  if (newOffset > pJpeg2000Buffer->SrcSize) {
-    nBytes = pJpeg2000Buffer->SrcSize - pJpeg2000Buffer->Offset;
-    pJpeg2000Buffer->Offset = pJpeg2000Buffer->SrcSize;
-  } else {
-    pJpeg2000Buffer->Offset = static_cast<OPJ_SIZE_T>(newOffset);
-  }
+  GrowJpeg2000WriteBuffer(pWriteBuffer, pWriteBuffer->Offset + nBytes);
+  memcpy(pWriteBuffer->Target->GetData() + pWriteBuffer->Offset, pBuffer,
+         nBytes);
+  pWriteBuffer->Offset += nBytes;
 
   return nBytes;
 }
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-OPJ_BOOL OpjSeekFromMemory(OPJ_OFF_T nBytes, Jpeg2000Buffer *pJpeg2000Buffer) {
-  if (!pJpeg2000Buffer || !pJpeg2000Buffer->SrcData ||
-      pJpeg2000Buffer->SrcSize == 0) {
-    return OPJ_FALSE;
+OPJ_OFF_T OpjSkipToMemory(OPJ_OFF_T nBytes, Jpeg2000WriteBuffer *pWriteBuffer) {
+  if (!pWriteBuffer || nBytes < 0) {
+    return static_cast<OPJ_OFF_T>(-1);
   }
-  if (nBytes < 0) {
+
+  auto const end = pWriteBuffer->Offset + static_cast<OPJ_SIZE_T>(nBytes);
+  GrowJpeg2000WriteBuffer(pWriteBuffer, end);
+  pWriteBuffer->Offset = end;
+
+  return nBytes;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+OPJ_BOOL OpjSeekToMemory(OPJ_OFF_T nBytes, Jpeg2000WriteBuffer *pWriteBuffer) {
+  if (!pWriteBuffer || nBytes < 0) {
     return OPJ_FALSE;
   }
 
-  pJpeg2000Buffer->Offset =
-      min(static_cast<OPJ_SIZE_T>(nBytes), pJpeg2000Buffer->SrcSize);
+  GrowJpeg2000WriteBuffer(pWriteBuffer, static_cast<OPJ_SIZE_T>(nBytes));
+  pWriteBuffer->Offset = static_cast<OPJ_SIZE_T>(nBytes);
 
   return OPJ_TRUE;
 }
@@ -94,23 +146,20 @@ OPJ_BOOL OpjSeekFromMemory(OPJ_OFF_T nBytes, Jpeg2000Buffer *pJpeg2000Buffer) {
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 opj_stream_t *OPJ_CALLCONV
-OpjCreateMemoryStream(Jpeg2000Buffer *pJpeg2000Buffer, OPJ_UINT32 const size,
-                      bool const isReadStream) {
-  if (!pJpeg2000Buffer) {
+OpjCreateReadStream(Jpeg2000ReadBuffer *pReadBuffer) {
+  if (!pReadBuffer) {
     return nullptr;
   }
 
-  auto pStream = opj_stream_create(size, isReadStream);
+  auto pStream = opj_stream_create(max<OPJ_SIZE_T>(pReadBuffer->Size, 1), true);
   if (!pStream) {
     return nullptr;
   }
 
-  opj_stream_set_user_data(pStream, pJpeg2000Buffer, nullptr);
-  opj_stream_set_user_data_length(pStream, pJpeg2000Buffer->SrcSize);
+  opj_stream_set_user_data(pStream, pReadBuffer, nullptr);
+  opj_stream_set_user_data_length(pStream, pReadBuffer->Size);
   opj_stream_set_read_function(
       pStream, reinterpret_cast<opj_stream_read_fn>(OpjReadFromMemory));
-  opj_stream_set_write_function(
-      pStream, reinterpret_cast<opj_stream_write_fn>(OpjWriteToMemory));
   opj_stream_set_skip_function(
       pStream, reinterpret_cast<opj_stream_skip_fn>(OpjSkipFromMemory));
   opj_stream_set_seek_function(
@@ -119,6 +168,30 @@ OpjCreateMemoryStream(Jpeg2000Buffer *pJpeg2000Buffer, OPJ_UINT32 const size,
   return pStream;
 }
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+opj_stream_t *OPJ_CALLCONV
+OpjCreateWriteStream(Jpeg2000WriteBuffer *pWriteBuffer) {
+  if (!pWriteBuffer) {
+    return nullptr;
+  }
+
+  auto pStream = opj_stream_create(OPJ_J2K_STREAM_CHUNK_SIZE, false);
+  if (!pStream) {
+    return nullptr;
+  }
+
+  opj_stream_set_user_data(pStream, pWriteBuffer, nullptr);
+  opj_stream_set_write_function(
+      pStream, reinterpret_cast<opj_stream_write_fn>(OpjWriteToMemory));
+  opj_stream_set_skip_function(
+      pStream, reinterpret_cast<opj_stream_skip_fn>(OpjSkipToMemory));
+  opj_stream_set_seek_function(
+      pStream, reinterpret_cast<opj_stream_seek_fn>(OpjSeekToMemory));
+
+  return pStream;
+}
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void OpjMessageCallbackInfo(char const *msg, void *unused) {
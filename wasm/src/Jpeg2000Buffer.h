@@ -2,26 +2,62 @@
 
 #include <openjpeg.h>
 
+#include <vector>
+
+#include "Buffer.h"
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000Fragment {
+  uint8_t const *Data = nullptr;
+  OPJ_SIZE_T Size = 0;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Codestream read in place from one or more fragments (e.g. the DICOM pixel
+// data fragments of a frame), without joining them first
+struct Jpeg2000ReadBuffer {
+ public:
+  explicit Jpeg2000ReadBuffer(std::vector<Jpeg2000Fragment> fragments);
+
+  std::vector<Jpeg2000Fragment> Fragments;
+  OPJ_SIZE_T Size = 0;
+  OPJ_SIZE_T Offset = 0;
+  // Fragment holding Offset, and the offset of its first byte
+  size_t Fragment = 0;
+  OPJ_SIZE_T FragmentStart = 0;
+
+  Jpeg2000ReadBuffer(Jpeg2000ReadBuffer const &) = delete;
+  Jpeg2000ReadBuffer &operator=(Jpeg2000ReadBuffer const &) = delete;
+};
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-struct Jpeg2000Buffer {
+// Codestream written straight into a growable buffer (e.g. the encoded buffer
+// of the context), whose size follows the written length
+struct Jpeg2000WriteBuffer {
  public:
-  Jpeg2000Buffer(uint8_t *srcData, OPJ_SIZE_T const srcSize)
-      : SrcData(srcData), SrcSize(srcSize), Offset(0) {}
+  explicit Jpeg2000WriteBuffer(Buffer *target) : Target(target) {
+    Target->Resize(0);
+  }
 
-  uint8_t *SrcData;
-  OPJ_SIZE_T SrcSize;
-  OPJ_SIZE_T Offset;
+  Buffer *Target;
+  OPJ_SIZE_T Offset = 0;
 
-  Jpeg2000Buffer(Jpeg2000Buffer const &) = delete;
-  Jpeg2000Buffer &operator=(Jpeg2000Buffer const &) = delete;
+  Jpeg2000WriteBuffer(Jpeg2000WriteBuffer const &) = delete;
+  Jpeg2000WriteBuffer &operator=(Jpeg2000WriteBuffer const &) = delete;
 };
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-opj_stream_t *OPJ_CALLCONV OpjCreateMemoryStream(Jpeg2000Buffer *pBuffer,
-                                                 OPJ_UINT32 const size,
-                                                 bool const isReadStream);
+// The stream buffer spans the whole codestream, so that OpenJPEG gathers it
+// with a single read
+opj_stream_t *OPJ_CALLCONV OpjCreateReadStream(Jpeg2000ReadBuffer *pBuffer);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+opj_stream_t *OPJ_CALLCONV OpjCreateWriteStream(Jpeg2000WriteBuffer *pBuffer);
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -0,0 +1,182 @@
+#include "Jpeg2000Components.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+static size_t const MaxJpeg2000Components = 4;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Clamps a row of samples into a contiguous destination. The loop has neither
+// stride nor branch, so that it is vectorized.
+template <typename T>
+static void StoreJpeg2000Row(int32_t const *__restrict source,
+                             T *__restrict destination, size_t const width,
+                             int32_t const low, int32_t const high) {
+  for (size_t x = 0; x < width; x++) {
+    destination[x] = static_cast<T>(min(max(source[x], low), high));
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Clamps and interleaves the rows of N components, N being known at compile
+// time so that the component loop is unrolled
+template <typename T, size_t N>
+static void InterleaveJpeg2000Row(int32_t const *const *sources,
+                                  T *__restrict destination, size_t const width,
+                                  int32_t const *low, int32_t const *high) {
+  for (size_t x = 0; x < width; x++) {
+    for (size_t c = 0; c < N; c++) {
+      destination[x * N + c] =
+          static_cast<T>(min(max(sources[c][x], low[c]), high[c]));
+    }
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Index, in a component of size samples starting at origin on its own grid,
+// of the sample covering the canvas coordinate, the grid being factor times
+// coarser than the canvas
+static size_t GetJpeg2000SampleIndex(size_t const coordinate,
+                                     uint32_t const factor,
+                                     uint32_t const origin,
+                                     uint32_t const size) {
+  auto const index = static_cast<int64_t>(coordinate / factor) - origin;
+  return static_cast<size_t>(
+      min<int64_t>(max<int64_t>(index, 0), static_cast<int64_t>(size) - 1));
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+template <typename T>
+static void AssembleJpeg2000Rows(CodecsContext *ctx,
+                                 opj_image_t const *pImage, size_t const width,
+                                 size_t const height, bool const isPlanar) {
+  auto const numberOfComponents = static_cast<size_t>(pImage->numcomps);
+  int32_t low[MaxJpeg2000Components];
+  int32_t high[MaxJpeg2000Components];
+  for (size_t c = 0; c < numberOfComponents; c++) {
+    auto const &comp = pImage->comps[c];
+    low[c] = comp.sgnd ? -(1 << (comp.prec - 1)) : 0;
+    high[c] = comp.sgnd ? (1 << (comp.prec - 1)) - 1 : (1 << comp.prec) - 1;
+  }
+
+  // Subsampled components are widened into a row of their own, the others
+  // are read in place
+  vector<int32_t> upsampledRows[MaxJpeg2000Components];
+  for (size_t c = 0; c < numberOfComponents; c++) {
+    if (pImage->comps[c].dx > 1) {
+      upsampledRows[c].resize(width);
+    }
+  }
+
+  auto *destination = reinterpret_cast<T *>(GetDecodedBuffer(ctx));
+  int32_t const *sources[MaxJpeg2000Components];
+  for (size_t y = 0; y < height; y++) {
+    for (size_t c = 0; c < numberOfComponents; c++) {
+      auto const &comp = pImage->comps[c];
+      auto const *row =
+          comp.data +
+          GetJpeg2000SampleIndex(y + pImage->y0, comp.dy, comp.y0, comp.h) *
+              comp.w;
+      if (comp.dx > 1) {
+        auto &upsampledRow = upsampledRows[c];
+        for (size_t x = 0; x < width; x++) {
+          upsampledRow[x] = row[GetJpeg2000SampleIndex(x + pImage->x0, comp.dx,
+                                                       comp.x0, comp.w)];
+        }
+        row = upsampledRow.data();
+      }
+      sources[c] = row;
+    }
+
+    if (isPlanar || numberOfComponents == 1) {
+      for (size_t c = 0; c < numberOfComponents; c++) {
+        StoreJpeg2000Row(sources[c],
+                         destination + (c * height + y) * width, width,
+                         low[c], high[c]);
+      }
+      continue;
+    }
+
+    auto *rowDestination = destination + y * width * numberOfComponents;
+    switch (numberOfComponents) {
+      case 2:
+        InterleaveJpeg2000Row<T, 2>(sources, rowDestination, width, low, high);
+        break;
+      case 3:
+        InterleaveJpeg2000Row<T, 3>(sources, rowDestination, width, low, high);
+        break;
+      case 4:
+        InterleaveJpeg2000Row<T, 4>(sources, rowDestination, width, low, high);
+        break;
+    }
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool IsJpeg2000ComponentLayoutSupported(opj_image_t const *pImage) {
+  if (pImage->numcomps < 1 || pImage->numcomps > MaxJpeg2000Components ||
+      pImage->comps[0].dx != 1 || pImage->comps[0].dy != 1) {
+    return false;
+  }
+  for (auto c = 0u; c < pImage->numcomps; c++) {
+    auto const &comp = pImage->comps[c];
+    // The components share the signedness of the assembled samples
+    if (comp.prec < 1 || comp.prec > 16 || comp.dx < 1 || comp.dy < 1 ||
+        comp.sgnd != pImage->comps[0].sgnd) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void AssembleJpeg2000Components(CodecsContext *ctx, opj_image_t const *pImage) {
+  auto const width = static_cast<size_t>(pImage->comps[0].w);
+  auto const height = static_cast<size_t>(pImage->comps[0].h);
+  auto const numberOfComponents = static_cast<size_t>(pImage->numcomps);
+  auto maxPrecision = 0u;
+  for (size_t c = 0; c < numberOfComponents; c++) {
+    maxPrecision = max(maxPrecision, pImage->comps[c].prec);
+  }
+  auto const bytesPerSample =
+      (maxPrecision > 8 || GetBitsAllocated(ctx) > 8) ? 2u : 1u;
+  auto const isPlanar =
+      numberOfComponents > 1 &&
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Planar;
+  auto const isSigned = pImage->comps[0].sgnd != 0;
+
+  SetColumns(ctx, width);
+  SetRows(ctx, height);
+  SetSamplesPerPixel(ctx, numberOfComponents);
+  SetBitsAllocated(ctx, bytesPerSample * 8);
+  SetPixelRepresentation(ctx, isSigned ? +PixelRepresentationEnum::Signed
+                                       : +PixelRepresentationEnum::Unsigned);
+  // Every sample is written, so the buffer is neither cleared nor reallocated
+  // when the previous frame of the context was at least as large
+  ctx->DecodedBuffer.Resize(width * height * numberOfComponents *
+                            bytesPerSample);
+
+  if (bytesPerSample == 1) {
+    if (isSigned) {
+      AssembleJpeg2000Rows<int8_t>(ctx, pImage, width, height, isPlanar);
+    } else {
+      AssembleJpeg2000Rows<uint8_t>(ctx, pImage, width, height, isPlanar);
+    }
+  } else {
+    if (isSigned) {
+      AssembleJpeg2000Rows<int16_t>(ctx, pImage, width, height, isPlanar);
+    } else {
+      AssembleJpeg2000Rows<uint16_t>(ctx, pImage, width, height, isPlanar);
+    }
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <openjpeg.h>
+
+#include "CodecsContext.h"
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Returns whether the components of the image, as reported by the header, can
+// be assembled into a frame: 1 to 4 components of up to 16 bits each, with
+// the first component at full resolution
+bool IsJpeg2000ComponentLayoutSupported(opj_image_t const *pImage);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Assembles the decoded components of the image straight into the decoded
+// buffer, clamped to their precision, as 8 or 16-bit samples that are signed
+// or not as the components are. Subsampled components are upsampled by
+// replication. The frame is interleaved unless the context asks for planar
+// samples. The frame geometry of the context is updated from the image.
+void AssembleJpeg2000Components(CodecsContext *ctx, opj_image_t const *pImage);
@@ -0,0 +1,764 @@
+#include "Jpeg2000Packets.h"
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <tuple>
+
+#include "Exception.h"
+
+using namespace std;
+
+static uint16_t const MarkerSoc = 0xFF4F;
+static uint16_t const MarkerSiz = 0xFF51;
+static uint16_t const MarkerCod = 0xFF52;
+static uint16_t const MarkerCoc = 0xFF53;
+static uint16_t const MarkerTlm = 0xFF55;
+static uint16_t const MarkerPlt = 0xFF58;
+static uint16_t const MarkerPoc = 0xFF5F;
+static uint16_t const MarkerPpm = 0xFF60;
+static uint16_t const MarkerPpt = 0xFF61;
+static uint16_t const MarkerSot = 0xFF90;
+static uint16_t const MarkerSop = 0xFF91;
+static uint16_t const MarkerEph = 0xFF92;
+static uint16_t const MarkerSod = 0xFF93;
+static uint16_t const MarkerEoc = 0xFFD9;
+
+// SOT marker segment: marker, Lsot, Isot, Psot, TPsot and TNsot
+static size_t const SotSegmentSize = 12;
+// SOP marker segment: marker, Lsop and Nsop
+static size_t const SopSegmentSize = 6;
+// Code-block style of HT code-blocks, and of mixed HT and Part 1 code-blocks
+static uint8_t const BlockStyleHt = 0x40;
+static uint8_t const BlockStyleHtMixed = 0x80;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static uint16_t ReadUint16(uint8_t const *p) {
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static uint32_t ReadUint32(uint8_t const *p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void WriteUint16(uint8_t *p, uint32_t const value) {
+  p[0] = static_cast<uint8_t>(value >> 8);
+  p[1] = static_cast<uint8_t>(value);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void WriteUint32(uint8_t *p, uint32_t const value) {
+  p[0] = static_cast<uint8_t>(value >> 24);
+  p[1] = static_cast<uint8_t>(value >> 16);
+  p[2] = static_cast<uint8_t>(value >> 8);
+  p[3] = static_cast<uint8_t>(value);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static int64_t CeilDiv(int64_t const n, int64_t const d) {
+  return n >= 0 ? (n + d - 1) / d : -((-n) / d);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000ComponentCoding {
+  uint32_t XRsiz = 1;
+  uint32_t YRsiz = 1;
+  uint32_t Levels = 0;
+  uint32_t LogBlockWidth = 0;
+  uint32_t LogBlockHeight = 0;
+  uint8_t BlockStyle = 0;
+  // PPx | PPy << 4 for each resolution, when the precincts are not maximal
+  vector<uint8_t> PrecinctSizes;
+
+  uint32_t GetLogPrecinctWidth(uint32_t const r) const {
+    return PrecinctSizes.empty() ? 15 : PrecinctSizes[r] & 0xF;
+  }
+  uint32_t GetLogPrecinctHeight(uint32_t const r) const {
+    return PrecinctSizes.empty() ? 15 : PrecinctSizes[r] >> 4;
+  }
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000Codestream {
+  int64_t ImageX0 = 0;
+  int64_t ImageY0 = 0;
+  int64_t ImageX1 = 0;
+  int64_t ImageY1 = 0;
+  int64_t TileX0 = 0;
+  int64_t TileY0 = 0;
+  int64_t TileWidth = 0;
+  int64_t TileHeight = 0;
+  size_t TilesAcross = 0;
+  size_t TilesDown = 0;
+  // Scod: SOP (2) and EPH (4) marker usage
+  uint8_t CodingStyle = 0;
+  uint8_t ProgressionOrder = 0;
+  vector<Jpeg2000ComponentCoding> Components;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Packet of a tile, with the code-block counts of its precinct in each subband
+struct Jpeg2000PacketLayout {
+  uint32_t Resolution = 0;
+  uint32_t Component = 0;
+  uint32_t Precinct = 0;
+  uint32_t NumberOfBands = 0;
+  uint32_t BlocksAcross[3] = {0, 0, 0};
+  uint32_t BlocksDown[3] = {0, 0, 0};
+  tuple<int64_t, int64_t, int64_t, int64_t> Order;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Packet header bits, with the bit stuffing that follows 0xFF bytes
+struct Jpeg2000BitReader {
+  uint8_t const *Position = nullptr;
+  uint8_t const *End = nullptr;
+  uint32_t Byte = 0;
+  uint32_t Bits = 0;
+  bool Overrun = false;
+
+  uint32_t ReadBit() {
+    if (Bits == 0) {
+      Bits = Byte == 0xFF ? 7 : 8;
+      if (Position < End) {
+        Byte = *Position++;
+      } else {
+        Byte = 0;
+        Overrun = true;
+      }
+    }
+    return (Byte >> --Bits) & 1;
+  }
+
+  uint32_t ReadBits(uint32_t const count) {
+    uint32_t value = 0;
+    for (auto i = 0u; i < count; i++) {
+      value = (value << 1) | ReadBit();
+    }
+    return value;
+  }
+
+  // A header that ends with 0xFF is followed by a stuffed byte
+  void Terminate() {
+    if (Byte == 0xFF) {
+      if (Position < End) {
+        Position++;
+      } else {
+        Overrun = true;
+      }
+    }
+    Byte = 0;
+    Bits = 0;
+  }
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+class Jpeg2000TagTree {
+ public:
+  Jpeg2000TagTree(uint32_t width, uint32_t height) {
+    size_t numberOfNodes = 0;
+    while (true) {
+      Widths.push_back(width);
+      Offsets.push_back(numberOfNodes);
+      numberOfNodes += static_cast<size_t>(width) * height;
+      if (width == 1 && height == 1) {
+        break;
+      }
+      width = (width + 1) / 2;
+      height = (height + 1) / 2;
+    }
+    Values.assign(numberOfNodes, INT32_MAX);
+    Lows.assign(numberOfNodes, 0);
+  }
+
+  // Decodes the leaf value up to threshold, returning it when it is below
+  int32_t Decode(Jpeg2000BitReader *reader, uint32_t const x, uint32_t const y,
+                 int32_t const threshold) {
+    int32_t low = 0;
+    size_t node = 0;
+    for (auto level = Widths.size(); level-- > 0;) {
+      node = Offsets[level] + (y >> level) * Widths[level] + (x >> level);
+      if (low > Lows[node]) {
+        Lows[node] = low;
+      } else {
+        low = Lows[node];
+      }
+      while (low < threshold && low < Values[node]) {
+        if (reader->ReadBit()) {
+          Values[node] = low;
+        } else {
+          low++;
+        }
+      }
+      Lows[node] = low;
+    }
+
+    return Values[node];
+  }
+
+ private:
+  vector<uint32_t> Widths;
+  vector<size_t> Offsets;
+  vector<int32_t> Values;
+  vector<int32_t> Lows;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Reads SPcod/SPcoc, which start at p and end at end
+static void ReadJpeg2000CodingStyle(uint8_t const *p, uint8_t const *end,
+                                    bool const hasPrecincts,
+                                    Jpeg2000ComponentCoding *coding) {
+  if (end - p < 5) {
+    ThrowCodecsException(
+        "BuildJpeg2000PacketIndex::Truncated coding style marker segment");
+  }
+  coding->Levels = p[0];
+  coding->LogBlockWidth = (p[1] & 0xF) + 2u;
+  coding->LogBlockHeight = (p[2] & 0xF) + 2u;
+  coding->BlockStyle = p[3];
+  coding->PrecinctSizes.clear();
+  if (hasPrecincts) {
+    if (end - p < 5 + static_cast<ptrdiff_t>(coding->Levels) + 1) {
+      ThrowCodecsException(
+          "BuildJpeg2000PacketIndex::Truncated coding style marker segment");
+    }
+    coding->PrecinctSizes.assign(p + 5, p + 5 + coding->Levels + 1);
+  }
+  if (coding->Levels > 32) {
+    ThrowCodecsException(
+        "BuildJpeg2000PacketIndex::Invalid number of decomposition levels (" +
+        to_string(coding->Levels) + ")");
+  }
+  if ((coding->BlockStyle & BlockStyleHt) == 0 ||
+      (coding->BlockStyle & BlockStyleHtMixed) != 0) {
+    ThrowCodecsException(
+        "BuildJpeg2000PacketIndex::Only HT code-blocks are supported");
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Reads the main header, returning the offset of the first SOT marker
+static size_t ReadJpeg2000MainHeader(uint8_t const *data, size_t const size,
+                                     Jpeg2000Codestream *codestream) {
+  if (size < 4 || ReadUint16(data) != MarkerSoc) {
+    ThrowCodecsException("BuildJpeg2000PacketIndex::No SOC marker");
+  }
+
+  Jpeg2000ComponentCoding defaultCoding;
+  vector<bool> hasComponentCoding;
+  auto hasCod = false;
+  size_t offset = 2;
+  while (true) {
+    if (offset + 4 > size) {
+      ThrowCodecsException("BuildJpeg2000PacketIndex::Truncated main header");
+    }
+    auto const marker = ReadUint16(data + offset);
+    if (marker == MarkerSot) {
+      break;
+    }
+    auto const length = ReadUint16(data + offset + 2);
+    auto const *segment = data + offset + 4;
+    auto const *segmentEnd = data + offset + 2 + length;
+    if ((marker >> 8) != 0xFF || length < 2 || offset + 2 + length > size) {
+      ThrowCodecsException("BuildJpeg2000PacketIndex::Malformed main header");
+    }
+
+    if (marker == MarkerSiz) {
+      if (length < 38) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Truncated SIZ marker segment");
+      }
+      codestream->ImageX1 = ReadUint32(segment + 2);
+      codestream->ImageY1 = ReadUint32(segment + 6);
+      codestream->ImageX0 = ReadUint32(segment + 10);
+      codestream->ImageY0 = ReadUint32(segment + 14);
+      codestream->TileWidth = ReadUint32(segment + 18);
+      codestream->TileHeight = ReadUint32(segment + 22);
+      codestream->TileX0 = ReadUint32(segment + 26);
+      codestream->TileY0 = ReadUint32(segment + 30);
+      auto const numberOfComponents = ReadUint16(segment + 34);
+      if (numberOfComponents == 0 || length < 38 + 3 * numberOfComponents ||
+          codestream->TileWidth == 0 || codestream->TileHeight == 0 ||
+          codestream->ImageX0 >= codestream->ImageX1 ||
+          codestream->ImageY0 >= codestream->ImageY1) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Malformed SIZ marker segment");
+      }
+      codestream->Components.resize(numberOfComponents);
+      hasComponentCoding.assign(numberOfComponents, false);
+      for (auto c = 0u; c < numberOfComponents; c++) {
+        codestream->Components[c].XRsiz = max(segment[37 + 3 * c], uint8_t(1));
+        codestream->Components[c].YRsiz = max(segment[38 + 3 * c], uint8_t(1));
+      }
+    } else if (marker == MarkerCod) {
+      if (length < 12) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Truncated COD marker segment");
+      }
+      codestream->CodingStyle = segment[0];
+      codestream->ProgressionOrder = segment[1];
+      auto const numberOfLayers = ReadUint16(segment + 2);
+      if (numberOfLayers != 1) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Unsupported number of layers (" +
+            to_string(numberOfLayers) + ")");
+      }
+      ReadJpeg2000CodingStyle(segment + 5, segmentEnd,
+                              (segment[0] & 1) != 0, &defaultCoding);
+      hasCod = true;
+    } else if (marker == MarkerCoc) {
+      auto const numberOfComponents = codestream->Components.size();
+      auto const componentSize = numberOfComponents < 257 ? 1u : 2u;
+      if (numberOfComponents == 0 || length < 2 + componentSize + 1) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Malformed COC marker segment");
+      }
+      size_t const c = componentSize == 1 ? segment[0] : ReadUint16(segment);
+      if (c >= numberOfComponents) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Malformed COC marker segment");
+      }
+      ReadJpeg2000CodingStyle(segment + componentSize + 1, segmentEnd,
+                              (segment[componentSize] & 1) != 0,
+                              &codestream->Components[c]);
+      hasComponentCoding[c] = true;
+    } else if (marker == MarkerPoc || marker == MarkerPpm) {
+      ThrowCodecsException(
+          "BuildJpeg2000PacketIndex::POC and PPM marker segments are not "
+          "supported");
+    }
+    offset += 2 + length;
+  }
+
+  if (codestream->Components.empty() || !hasCod) {
+    ThrowCodecsException("BuildJpeg2000PacketIndex::No SIZ or COD marker");
+  }
+  if (codestream->ProgressionOrder > 4) {
+    ThrowCodecsException(
+        "BuildJpeg2000PacketIndex::Unsupported progression order (" +
+        to_string(codestream->ProgressionOrder) + ")");
+  }
+  for (auto c = 0u; c < codestream->Components.size(); c++) {
+    if (!hasComponentCoding[c]) {
+      auto &component = codestream->Components[c];
+      auto const xrsiz = component.XRsiz;
+      auto const yrsiz = component.YRsiz;
+      component = defaultCoding;
+      component.XRsiz = xrsiz;
+      component.YRsiz = yrsiz;
+    }
+  }
+  codestream->TilesAcross = static_cast<size_t>(
+      CeilDiv(codestream->ImageX1 - codestream->TileX0, codestream->TileWidth));
+  codestream->TilesDown = static_cast<size_t>(CeilDiv(
+      codestream->ImageY1 - codestream->TileY0, codestream->TileHeight));
+
+  return offset;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Lists the packets of a tile in progression order
+static void GetJpeg2000PacketLayouts(Jpeg2000Codestream const &codestream,
+                                     size_t const tile,
+                                     vector<Jpeg2000PacketLayout> *layouts) {
+  auto const p = static_cast<int64_t>(tile % codestream.TilesAcross);
+  auto const q = static_cast<int64_t>(tile / codestream.TilesAcross);
+  auto const tx0 =
+      max(codestream.TileX0 + p * codestream.TileWidth, codestream.ImageX0);
+  auto const ty0 =
+      max(codestream.TileY0 + q * codestream.TileHeight, codestream.ImageY0);
+  auto const tx1 = min(codestream.TileX0 + (p + 1) * codestream.TileWidth,
+                       codestream.ImageX1);
+  auto const ty1 = min(codestream.TileY0 + (q + 1) * codestream.TileHeight,
+                       codestream.ImageY1);
+
+  layouts->clear();
+  for (auto c = 0u; c < codestream.Components.size(); c++) {
+    auto const &coding = codestream.Components[c];
+    auto const tcx0 = CeilDiv(tx0, coding.XRsiz);
+    auto const tcy0 = CeilDiv(ty0, coding.YRsiz);
+    auto const tcx1 = CeilDiv(tx1, coding.XRsiz);
+    auto const tcy1 = CeilDiv(ty1, coding.YRsiz);
+
+    for (auto r = 0u; r <= coding.Levels; r++) {
+      auto const scale = int64_t(1) << (coding.Levels - r);
+      auto const trx0 = CeilDiv(tcx0, scale);
+      auto const try0 = CeilDiv(tcy0, scale);
+      auto const trx1 = CeilDiv(tcx1, scale);
+      auto const try1 = CeilDiv(tcy1, scale);
+      if (trx0 >= trx1 || try0 >= try1) {
+        continue;
+      }
+
+      auto const ppx = coding.GetLogPrecinctWidth(r);
+      auto const ppy = coding.GetLogPrecinctHeight(r);
+      if (r > 0 && (ppx == 0 || ppy == 0)) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Invalid precinct size");
+      }
+      auto const px0 = trx0 >> ppx;
+      auto const py0 = try0 >> ppy;
+      auto const precinctsAcross = CeilDiv(trx1, int64_t(1) << ppx) - px0;
+      auto const precinctsDown = CeilDiv(try1, int64_t(1) << ppy) - py0;
+
+      // Subbands of the resolution, with their precinct and code-block sizes
+      uint32_t const bandsX[] = {r == 0 ? 0u : 1u, 0u, 1u};
+      uint32_t const bandsY[] = {0u, 1u, 1u};
+      auto const numberOfBands = r == 0 ? 1u : 3u;
+      auto const nb = r == 0 ? coding.Levels : coding.Levels - r + 1;
+      auto const bandPpx = r == 0 ? ppx : ppx - 1;
+      auto const bandPpy = r == 0 ? ppy : ppy - 1;
+      auto const cbx = min(coding.LogBlockWidth, bandPpx);
+      auto const cby = min(coding.LogBlockHeight, bandPpy);
+
+      for (auto ky = 0; ky < precinctsDown; ky++) {
+        for (auto kx = 0; kx < precinctsAcross; kx++) {
+          Jpeg2000PacketLayout layout;
+          layout.Resolution = r;
+          layout.Component = c;
+          layout.Precinct = static_cast<uint32_t>(ky * precinctsAcross + kx);
+          layout.NumberOfBands = numberOfBands;
+          for (auto b = 0u; b < numberOfBands; b++) {
+            auto const half = nb > 0 ? int64_t(1) << (nb - 1) : 0;
+            auto const bandScale = int64_t(1) << nb;
+            auto const tbx0 = CeilDiv(tcx0 - half * bandsX[b], bandScale);
+            auto const tby0 = CeilDiv(tcy0 - half * bandsY[b], bandScale);
+            auto const tbx1 = CeilDiv(tcx1 - half * bandsX[b], bandScale);
+            auto const tby1 = CeilDiv(tcy1 - half * bandsY[b], bandScale);
+            auto const x0 = max((px0 + kx) << bandPpx, tbx0);
+            auto const y0 = max((py0 + ky) << bandPpy, tby0);
+            auto const x1 = min((px0 + kx + 1) << bandPpx, tbx1);
+            auto const y1 = min((py0 + ky + 1) << bandPpy, tby1);
+            if (x0 < x1 && y0 < y1) {
+              layout.BlocksAcross[b] = static_cast<uint32_t>(
+                  CeilDiv(x1, int64_t(1) << cbx) - (x0 >> cbx));
+              layout.BlocksDown[b] = static_cast<uint32_t>(
+                  CeilDiv(y1, int64_t(1) << cby) - (y0 >> cby));
+            }
+          }
+
+          // Precinct position on the reference grid, clipped to the tile
+          auto const x = max(
+              (((px0 + kx) << ppx) << (coding.Levels - r)) * coding.XRsiz,
+              tx0);
+          auto const y = max(
+              (((py0 + ky) << ppy) << (coding.Levels - r)) * coding.YRsiz,
+              ty0);
+          switch (codestream.ProgressionOrder) {
+          case 2: // RPCL
+            layout.Order = make_tuple(r, y, x, c);
+            break;
+          case 3: // PCRL
+            layout.Order = make_tuple(y, x, c, r);
+            break;
+          case 4: // CPRL
+            layout.Order = make_tuple(c, y, x, r);
+            break;
+          default: // LRCP and RLCP, with a single layer
+            layout.Order = make_tuple(r, c, layout.Precinct, 0);
+            break;
+          }
+          layouts->push_back(layout);
+        }
+      }
+    }
+  }
+
+  stable_sort(layouts->begin(), layouts->end(),
+              [](Jpeg2000PacketLayout const &a, Jpeg2000PacketLayout const &b) {
+                return a.Order < b.Order;
+              });
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Returns the size of the packet at offset, which ends before end
+static size_t ParseJpeg2000Packet(uint8_t const *data, size_t const offset,
+                                  size_t const end,
+                                  Jpeg2000Codestream const &codestream,
+                                  Jpeg2000PacketLayout const &layout) {
+  auto position = offset;
+  if ((codestream.CodingStyle & 2) != 0 &&
+      position + SopSegmentSize <= end &&
+      ReadUint16(data + position) == MarkerSop) {
+    position += SopSegmentSize;
+  }
+
+  Jpeg2000BitReader reader;
+  reader.Position = data + position;
+  reader.End = data + end;
+  size_t bodySize = 0;
+  if (reader.ReadBit()) {
+    for (auto b = 0u; b < layout.NumberOfBands; b++) {
+      auto const blocksAcross = layout.BlocksAcross[b];
+      auto const blocksDown = layout.BlocksDown[b];
+      if (blocksAcross == 0 || blocksDown == 0) {
+        continue;
+      }
+
+      Jpeg2000TagTree inclusion(blocksAcross, blocksDown);
+      Jpeg2000TagTree zeroBitPlanes(blocksAcross, blocksDown);
+      for (auto y = 0u; y < blocksDown; y++) {
+        for (auto x = 0u; x < blocksAcross; x++) {
+          if (inclusion.Decode(&reader, x, y, 1) >= 1) {
+            continue;
+          }
+          zeroBitPlanes.Decode(&reader, x, y, 255);
+
+          auto passes = 1u;
+          if (reader.ReadBit()) {
+            passes = 2;
+            if (reader.ReadBit()) {
+              passes = 3 + reader.ReadBits(2);
+              if (passes == 6) {
+                passes = 6 + reader.ReadBits(5);
+                if (passes == 37) {
+                  passes = 37 + reader.ReadBits(7);
+                }
+              }
+            }
+          }
+          // A cleanup segment, then a SigProp and MagRef segment
+          if (passes > 3) {
+            ThrowCodecsException(
+                "BuildJpeg2000PacketIndex::Unsupported number of coding "
+                "passes (" +
+                to_string(passes) + ")");
+          }
+          auto lblock = 3u;
+          while (reader.ReadBit() && lblock < 32) {
+            lblock++;
+          }
+          bodySize += reader.ReadBits(lblock);
+          if (passes > 1) {
+            bodySize += reader.ReadBits(lblock + (passes > 2 ? 1 : 0));
+          }
+        }
+      }
+    }
+  }
+  reader.Terminate();
+  if (reader.Overrun) {
+    ThrowCodecsException("BuildJpeg2000PacketIndex::Truncated packet header");
+  }
+
+  position = static_cast<size_t>(reader.Position - data);
+  if ((codestream.CodingStyle & 4) != 0) {
+    if (position + 2 > end || ReadUint16(data + position) != MarkerEph) {
+      ThrowCodecsException("BuildJpeg2000PacketIndex::Missing EPH marker");
+    }
+    position += 2;
+  }
+  if (bodySize > end - position) {
+    ThrowCodecsException("BuildJpeg2000PacketIndex::Truncated packet body");
+  }
+
+  return position + bodySize - offset;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void BuildJpeg2000PacketIndex(uint8_t const *data, size_t const size,
+                              Jpeg2000PacketIndex *index) {
+  Jpeg2000Codestream codestream;
+  index->MainHeaderSize = ReadJpeg2000MainHeader(data, size, &codestream);
+  index->TileParts.clear();
+  index->Packets.clear();
+
+  // Packet layouts are built on the first tile-part of each tile, and consumed
+  // across its tile-parts
+  auto const numberOfTiles = codestream.TilesAcross * codestream.TilesDown;
+  vector<vector<Jpeg2000PacketLayout>> layouts(numberOfTiles);
+  vector<size_t> nextPackets(numberOfTiles, SIZE_MAX);
+
+  auto offset = index->MainHeaderSize;
+  while (offset + 2 <= size) {
+    auto const marker = ReadUint16(data + offset);
+    if (marker == MarkerEoc) {
+      break;
+    }
+    if (marker != MarkerSot || offset + SotSegmentSize > size) {
+      ThrowCodecsException("BuildJpeg2000PacketIndex::Malformed tile-part");
+    }
+
+    Jpeg2000TilePart tilePart;
+    tilePart.Tile = ReadUint16(data + offset + 4);
+    tilePart.Offset = offset;
+    // A zero Psot extends the tile-part to the end of the codestream
+    tilePart.Size = ReadUint32(data + offset + 6);
+    if (tilePart.Size == 0) {
+      tilePart.Size = size - offset;
+      if (ReadUint16(data + size - 2) == MarkerEoc) {
+        tilePart.Size -= 2;
+      }
+    }
+    if (tilePart.Tile >= numberOfTiles ||
+        tilePart.Size < SotSegmentSize + 2 || tilePart.Size > size - offset) {
+      ThrowCodecsException("BuildJpeg2000PacketIndex::Malformed tile-part");
+    }
+    auto const end = offset + tilePart.Size;
+
+    auto position = offset + SotSegmentSize;
+    while (true) {
+      if (position + 2 > end) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Malformed tile-part header");
+      }
+      auto const headerMarker = ReadUint16(data + position);
+      if (headerMarker == MarkerSod) {
+        position += 2;
+        break;
+      }
+      if (headerMarker == MarkerCod || headerMarker == MarkerCoc ||
+          headerMarker == MarkerPoc || headerMarker == MarkerPpt) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::COD, COC, POC and PPT marker segments "
+            "in tile-part headers are not supported");
+      }
+      if (position + 4 > end) {
+        ThrowCodecsException(
+            "BuildJpeg2000PacketIndex::Malformed tile-part header");
+      }
+      position += 2 + ReadUint16(data + position + 2);
+    }
+    tilePart.HeaderSize = position - offset;
+
+    auto &tileLayouts = layouts[tilePart.Tile];
+    auto &nextPacket = nextPackets[tilePart.Tile];
+    if (nextPacket == SIZE_MAX) {
+      GetJpeg2000PacketLayouts(codestream, tilePart.Tile, &tileLayouts);
+      nextPacket = 0;
+    }
+    while (position < end && nextPacket < tileLayouts.size()) {
+      auto const &layout = tileLayouts[nextPacket++];
+      Jpeg2000Packet packet;
+      packet.Tile = tilePart.Tile;
+      packet.TilePart = static_cast<uint32_t>(index->TileParts.size());
+      packet.Resolution = layout.Resolution;
+      packet.Component = layout.Component;
+      packet.Precinct = layout.Precinct;
+      packet.Offset = position;
+      packet.Size =
+          ParseJpeg2000Packet(data, position, end, codestream, layout);
+      index->Packets.push_back(packet);
+      position += packet.Size;
+    }
+
+    index->TileParts.push_back(tilePart);
+    offset = end;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void InsertJpeg2000PacketLengths(uint8_t const *data, size_t const size,
+                                 Jpeg2000PacketIndex const &index,
+                                 vector<uint8_t> *codestream) {
+  // PLT marker segments of each tile-part. A segment holds up to 65532 bytes
+  // of lengths, coded 7 bits per byte with the most significant bits first.
+  vector<vector<uint8_t>> plts(index.TileParts.size());
+  vector<size_t> segmentStarts(index.TileParts.size(), 0);
+  for (auto const &packet : index.Packets) {
+    uint8_t bytes[5];
+    auto numberOfBytes = 0u;
+    auto value = packet.Size;
+    do {
+      bytes[numberOfBytes++] = static_cast<uint8_t>(value & 0x7F);
+      value >>= 7;
+    } while (value != 0 && numberOfBytes < 5);
+
+    auto &plt = plts[packet.TilePart];
+    auto &segmentStart = segmentStarts[packet.TilePart];
+    if (plt.empty() || plt.size() - segmentStart - 2 + numberOfBytes > 0xFFFF) {
+      auto const z = plt.empty() ? 0u : plt[segmentStart + 4] + 1u;
+      if (z > 255) {
+        ThrowCodecsException(
+            "InsertJpeg2000PacketLengths::Too many packets in tile-part " +
+            to_string(packet.TilePart));
+      }
+      segmentStart = plt.size();
+      plt.insert(plt.end(), {static_cast<uint8_t>(MarkerPlt >> 8),
+                             static_cast<uint8_t>(MarkerPlt), 0, 0,
+                             static_cast<uint8_t>(z)});
+    }
+    for (auto i = numberOfBytes; i-- > 0;) {
+      plt.push_back(i > 0 ? bytes[i] | 0x80 : bytes[i]);
+    }
+    WriteUint16(plt.data() + segmentStart + 2,
+                static_cast<uint32_t>(plt.size() - segmentStart - 2));
+  }
+
+  size_t insertedSize = 0;
+  for (auto const &plt : plts) {
+    insertedSize += plt.size();
+  }
+  codestream->clear();
+  codestream->reserve(size + insertedSize);
+
+  // Main header, with the Ptlm entries of the TLM marker segments updated
+  codestream->assign(data, data + index.MainHeaderSize);
+  size_t entry = 0;
+  for (size_t offset = 2; offset + 4 <= index.MainHeaderSize;
+       offset += 2 + ReadUint16(data + offset + 2)) {
+    if (ReadUint16(data + offset) != MarkerTlm) {
+      continue;
+    }
+    auto const stlm = data[offset + 5];
+    auto const ttlmSize = (stlm >> 4) & 3u;
+    auto const ptlmSize = (stlm & 0x40) != 0 ? 4u : 2u;
+    auto const count =
+        (ReadUint16(data + offset + 2) - 4u) / (ttlmSize + ptlmSize);
+    for (auto i = 0u; i < count && entry < plts.size(); i++, entry++) {
+      auto *ptlm = codestream->data() + offset + 6 +
+                   i * (ttlmSize + ptlmSize) + ttlmSize;
+      auto const length =
+          (ptlmSize == 4 ? ReadUint32(ptlm) : ReadUint16(ptlm)) +
+          plts[entry].size();
+      if (ptlmSize == 4) {
+        WriteUint32(ptlm, static_cast<uint32_t>(length));
+      } else if (length <= 0xFFFF) {
+        WriteUint16(ptlm, static_cast<uint32_t>(length));
+      } else {
+        ThrowCodecsException(
+            "InsertJpeg2000PacketLengths::Tile-part too long for its TLM "
+            "entry");
+      }
+    }
+  }
+
+  // Tile-parts, with the PLT marker segments after SOT
+  auto end = index.MainHeaderSize;
+  for (auto t = 0u; t < index.TileParts.size(); t++) {
+    auto const &tilePart = index.TileParts[t];
+    auto const *sot = data + tilePart.Offset;
+    auto const start = codestream->size();
+    codestream->insert(codestream->end(), sot, sot + SotSegmentSize);
+    auto const psot = ReadUint32(sot + 6);
+    if (psot != 0) {
+      WriteUint32(codestream->data() + start + 6,
+                  static_cast<uint32_t>(psot + plts[t].size()));
+    }
+    codestream->insert(codestream->end(), plts[t].begin(), plts[t].end());
+    codestream->insert(codestream->end(), sot + SotSegmentSize,
+                       sot + tilePart.Size);
+    end = tilePart.Offset + tilePart.Size;
+  }
+  codestream->insert(codestream->end(), data + end, data + size);
+}
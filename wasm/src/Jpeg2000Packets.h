@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000TilePart {
+  uint32_t Tile = 0;
+  // Offset of the SOT marker, size of the header up to and including SOD and
+  // size of the whole tile-part
+  size_t Offset = 0;
+  size_t HeaderSize = 0;
+  size_t Size = 0;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000Packet {
+  uint32_t Tile = 0;
+  // Index of the tile-part in Jpeg2000PacketIndex::TileParts
+  uint32_t TilePart = 0;
+  uint32_t Resolution = 0;
+  uint32_t Component = 0;
+  uint32_t Precinct = 0;
+  // Packet header and body, including the SOP and EPH markers
+  size_t Offset = 0;
+  size_t Size = 0;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000PacketIndex {
+  size_t MainHeaderSize = 0;
+  std::vector<Jpeg2000TilePart> TileParts;
+  // Packets in codestream order
+  std::vector<Jpeg2000Packet> Packets;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Locates the packets of a single quality layer HT-JPEG 2000 codestream, by
+// parsing their headers. Throws for malformed codestreams, and for features
+// that move packets or headers elsewhere (POC, PPM, PPT, tile-part COD/COC).
+void BuildJpeg2000PacketIndex(uint8_t const *data, size_t const size,
+                              Jpeg2000PacketIndex *index);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Copies the indexed codestream with PLT marker segments, listing the packet
+// lengths, added to each tile-part header. Psot and the TLM entries are
+// updated for the longer tile-parts.
+void InsertJpeg2000PacketLengths(uint8_t const *data, size_t const size,
+                                 Jpeg2000PacketIndex const &index,
+                                 std::vector<uint8_t> *codestream);
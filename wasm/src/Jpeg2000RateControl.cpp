@@ -0,0 +1,385 @@
+#include "Jpeg2000RateControl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// 9/7 lifting coefficients
+static float const LiftAlpha = -1.586134342f;
+static float const LiftBeta = -0.052980118f;
+static float const LiftGamma = 0.882911076f;
+static float const LiftDelta = 0.443506852f;
+static float const LiftK = 1.230174105f;
+
+// Largest analysed window side, the remainder of the frame being assumed to
+// share the window statistics
+static size_t const MaxWindowSize = 1024;
+
+// Magnitude histograms, from 2^-8 to 2^24, with 16 bins per octave read from
+// the exponent and the 4 leading mantissa bits of the float magnitude
+static int const HistogramMantissaBits = 4;
+static int const HistogramMinOctave = -8;
+static int const HistogramBins = 32 << HistogramMantissaBits;
+
+// Rate model, fitted against OpenJPH: bits per significant coefficient on top
+// of its magnitude bits, bits per significance decision and bytes per
+// code-block of packet header and coding pass overhead
+static double const MagnitudeOverheadBits = 1.75;
+static double const SignificanceBitsScale = 1.1;
+static double const CodeBlockOverheadBytes = 3.0;
+static double const CodestreamOverheadBytes = 200.0;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000Subband {
+  // Synthesis gain, scaling the coefficients to sample units
+  double Gain = 1.0;
+  // Component distortion weight
+  double Weight = 1.0;
+  double Count = 0.0;
+  vector<double> Counts = vector<double>(HistogramBins);
+  vector<double> SquaredSums = vector<double>(HistogramBins);
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Lifts the odd samples of an interleaved line in place, with whole-sample
+// symmetric extension
+static void LiftOdd97(float *x, size_t const n, float const coefficient) {
+  for (size_t i = 1; i < n; i += 2) {
+    auto const left = x[i - 1];
+    auto const right = i + 1 < n ? x[i + 1] : x[i - 1];
+    x[i] += coefficient * (left + right);
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Lifts the even samples of an interleaved line in place
+static void LiftEven97(float *x, size_t const n, float const coefficient) {
+  for (size_t i = 0; i < n; i += 2) {
+    auto const left = i > 0 ? x[i - 1] : x[1];
+    auto const right = i + 1 < n ? x[i + 1] : x[i - 1];
+    x[i] += coefficient * (left + right);
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Transforms a line into its low-pass then high-pass halves
+static void Analyze97(float *line, size_t const n, vector<float> &scratch) {
+  if (n < 2) {
+    return;
+  }
+  scratch.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    scratch[i] = line[i];
+  }
+  auto *x = scratch.data();
+  LiftOdd97(x, n, LiftAlpha);
+  LiftEven97(x, n, LiftBeta);
+  LiftOdd97(x, n, LiftGamma);
+  LiftEven97(x, n, LiftDelta);
+  auto const lowCount = (n + 1) / 2;
+  for (size_t i = 0; i < n; i++) {
+    line[(i & 1) ? lowCount + i / 2 : i / 2] =
+        (i & 1) ? x[i] * (LiftK / 2.0f) : x[i] / LiftK;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Transforms the columns of a region into its low-pass then high-pass rows,
+// lifting whole rows at a time to stay cache friendly
+static void AnalyzeColumns97(float *plane, size_t const width,
+                             size_t const height, size_t const stride,
+                             vector<float> &scratch) {
+  if (height < 2) {
+    return;
+  }
+  scratch.resize(width * height);
+  for (size_t y = 0; y < height; y++) {
+    copy(plane + y * stride, plane + y * stride + width,
+         scratch.begin() + y * width);
+  }
+  auto const liftRows = [&](size_t const first, float const coefficient) {
+    for (auto y = first; y < height; y += 2) {
+      auto *row = scratch.data() + y * width;
+      auto const *below = y + 1 < height ? row + width : row - width;
+      auto const *above = y > 0 ? row - width : below;
+      for (size_t x = 0; x < width; x++) {
+        row[x] += coefficient * (above[x] + below[x]);
+      }
+    }
+  };
+  liftRows(1, LiftAlpha);
+  liftRows(0, LiftBeta);
+  liftRows(1, LiftGamma);
+  liftRows(0, LiftDelta);
+  auto const lowCount = (height + 1) / 2;
+  for (size_t y = 0; y < height; y++) {
+    auto const *row = scratch.data() + y * width;
+    auto *destination =
+        plane + ((y & 1) ? lowCount + y / 2 : y / 2) * stride;
+    auto const scale = (y & 1) ? LiftK / 2.0f : 1.0f / LiftK;
+    for (size_t x = 0; x < width; x++) {
+      destination[x] = row[x] * scale;
+    }
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Inverse of Analyze97, on a contiguous line
+static void Synthesize97(float *line, size_t const n, vector<float> &scratch) {
+  if (n < 2) {
+    return;
+  }
+  scratch.resize(n);
+  auto const lowCount = (n + 1) / 2;
+  for (size_t i = 0; i < n; i++) {
+    scratch[i] = (i & 1) ? line[lowCount + i / 2] / (LiftK / 2.0f)
+                         : line[i / 2] * LiftK;
+  }
+  auto *x = scratch.data();
+  LiftEven97(x, n, -LiftDelta);
+  LiftOdd97(x, n, -LiftGamma);
+  LiftEven97(x, n, -LiftBeta);
+  LiftOdd97(x, n, -LiftAlpha);
+  copy(x, x + n, line);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Energy of the 1D synthesis basis function of the low-pass (isHigh false) or
+// high-pass band after the given number of levels
+static double GetSynthesisGain(size_t const levels, bool const isHigh) {
+  size_t const length = size_t(64) << levels;
+  vector<size_t> lengths = {length};
+  for (size_t l = 0; l < levels; l++) {
+    lengths.push_back((lengths.back() + 1) / 2);
+  }
+  vector<float> line(length, 0.0f);
+  vector<float> scratch;
+  auto const lowCount = lengths[levels];
+  auto const bandStart = isHigh ? lowCount : 0;
+  auto const bandCount =
+      isHigh ? lengths[levels - 1] - lowCount : lowCount;
+  line[bandStart + bandCount / 2] = 1.0f;
+  for (auto l = levels; l > 0; l--) {
+    Synthesize97(line.data(), lengths[l - 1], scratch);
+  }
+
+  double energy = 0.0;
+  for (auto const value : line) {
+    energy += static_cast<double>(value) * value;
+  }
+  return sqrt(energy);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Accumulates the magnitudes of a subband, scaled to sample units
+static void AddSubband(float const *plane, size_t const stride, size_t const x0,
+                       size_t const y0, size_t const x1, size_t const y1,
+                       Jpeg2000Subband *subband) {
+  for (auto y = y0; y < y1; y++) {
+    for (auto x = x0; x < x1; x++) {
+      auto const magnitude =
+          static_cast<float>(fabs(plane[y * stride + x]) * subband->Gain);
+      uint32_t bits;
+      memcpy(&bits, &magnitude, sizeof(bits));
+      auto bin = static_cast<int>(bits >> (23 - HistogramMantissaBits)) -
+                 ((127 + HistogramMinOctave) << HistogramMantissaBits);
+      bin = min(max(bin, 0), HistogramBins - 1);
+      subband->Counts[bin]++;
+      subband->SquaredSums[bin] += magnitude * magnitude;
+    }
+  }
+  subband->Count += static_cast<double>((x1 - x0) * (y1 - y0));
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Models the coded bits and the weighted squared error of a step
+static void ModelStep(vector<Jpeg2000Subband> const &subbands,
+                      double const step, double *bits, double *distortion) {
+  *bits = 0.0;
+  *distortion = 0.0;
+  for (auto const &subband : subbands) {
+    auto significant = 0.0;
+    auto error = 0.0;
+    for (auto b = 0; b < HistogramBins; b++) {
+      auto const count = subband.Counts[b];
+      if (count == 0.0) {
+        continue;
+      }
+      auto const magnitude = sqrt(subband.SquaredSums[b] / count);
+      if (magnitude < step) {
+        error += subband.SquaredSums[b];
+        continue;
+      }
+      significant += count;
+      error += count * step * step / 12.0;
+      *bits += count * (log2(magnitude / step) + MagnitudeOverheadBits);
+    }
+    if (significant > 0.0 && significant < subband.Count) {
+      auto const p = significant / subband.Count;
+      *bits += SignificanceBitsScale * subband.Count *
+               -(p * log2(p) + (1.0 - p) * log2(1.0 - p));
+    }
+    *distortion += subband.Weight * error;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+float PredictHtJpeg2000QuantizationStep(CodecsContext *ctx,
+                                        size_t const numberOfDecompositions,
+                                        size_t const targetBytes,
+                                        float const targetPsnr) {
+  auto const columns = GetColumns(ctx);
+  auto const rows = GetRows(ctx);
+  auto const samplesPerPixel = GetSamplesPerPixel(ctx);
+  auto const bitsAllocated = GetBitsAllocated(ctx);
+  auto const bytesPerSample = bitsAllocated <= 8 ? 1u : 2u;
+  auto const isSigned =
+      GetPixelRepresentation(ctx) == +PixelRepresentationEnum::Signed;
+  auto const isPlanar =
+      samplesPerPixel > 1 &&
+      GetPlanarConfiguration(ctx) == +PlanarConfigurationEnum::Planar;
+
+  // Centered window, level shifted as OpenJPH does
+  auto const width = min(columns, MaxWindowSize);
+  auto const height = min(rows, MaxWindowSize);
+  auto const left = (columns - width) / 2;
+  auto const top = (rows - height) / 2;
+  auto const levelShift = isSigned ? 0.0f : float(1u << (bitsAllocated - 1));
+  vector<vector<float>> planes(samplesPerPixel,
+                               vector<float>(width * height));
+  auto const *data = GetDecodedBuffer(ctx);
+  for (size_t c = 0; c < samplesPerPixel; c++) {
+    for (size_t y = 0; y < height; y++) {
+      for (size_t x = 0; x < width; x++) {
+        auto const pixel = (top + y) * columns + left + x;
+        auto const sample = isPlanar ? c * columns * rows + pixel
+                                     : pixel * samplesPerPixel + c;
+        float value;
+        if (bytesPerSample == 1) {
+          value =
+              isSigned ? float(reinterpret_cast<int8_t const *>(data)[sample])
+                       : float(data[sample]);
+        } else {
+          value =
+              isSigned
+                  ? float(reinterpret_cast<int16_t const *>(data)[sample])
+                  : float(reinterpret_cast<uint16_t const *>(data)[sample]);
+        }
+        planes[c][y * width + x] = value - levelShift;
+      }
+    }
+  }
+
+  // Irreversible color transform, weighting the errors by their energy summed
+  // over the RGB samples they spread to
+  vector<double> weights(samplesPerPixel, 1.0);
+  if (samplesPerPixel == 3) {
+    for (size_t i = 0; i < width * height; i++) {
+      auto const r = planes[0][i];
+      auto const g = planes[1][i];
+      auto const b = planes[2][i];
+      planes[0][i] = 0.299f * r + 0.587f * g + 0.114f * b;
+      planes[1][i] = -0.16875f * r - 0.33126f * g + 0.5f * b;
+      planes[2][i] = 0.5f * r - 0.41869f * g - 0.08131f * b;
+    }
+    weights = {3.0, 0.34413 * 0.34413 + 1.772 * 1.772,
+               1.402 * 1.402 + 0.71414 * 0.71414};
+  }
+
+  vector<double> lowGains(numberOfDecompositions + 1, 1.0);
+  vector<double> highGains(numberOfDecompositions + 1, 1.0);
+  for (size_t d = 1; d <= numberOfDecompositions; d++) {
+    lowGains[d] = GetSynthesisGain(d, false);
+    highGains[d] = GetSynthesisGain(d, true);
+  }
+
+  vector<Jpeg2000Subband> subbands;
+  vector<float> scratch;
+  for (size_t c = 0; c < samplesPerPixel; c++) {
+    auto *plane = planes[c].data();
+    auto w = width;
+    auto h = height;
+    for (size_t d = 1; d <= numberOfDecompositions; d++) {
+      for (size_t y = 0; y < h; y++) {
+        Analyze97(plane + y * width, w, scratch);
+      }
+      AnalyzeColumns97(plane, w, h, width, scratch);
+      auto const lw = (w + 1) / 2;
+      auto const lh = (h + 1) / 2;
+      // HL, LH and HH subbands
+      Jpeg2000Subband mixed, high;
+      mixed.Gain = lowGains[d] * highGains[d];
+      high.Gain = highGains[d] * highGains[d];
+      mixed.Weight = high.Weight = weights[c];
+      AddSubband(plane, width, lw, 0, w, lh, &mixed);
+      AddSubband(plane, width, 0, lh, lw, h, &mixed);
+      AddSubband(plane, width, lw, lh, w, h, &high);
+      subbands.push_back(move(mixed));
+      subbands.push_back(move(high));
+      w = lw;
+      h = lh;
+    }
+    Jpeg2000Subband ll;
+    ll.Gain = lowGains[numberOfDecompositions] *
+              lowGains[numberOfDecompositions];
+    ll.Weight = weights[c];
+    AddSubband(plane, width, 0, 0, w, h, &ll);
+    subbands.push_back(move(ll));
+  }
+
+  auto const areaScale =
+      double(columns) * rows / (double(width) * double(height));
+  auto const codeBlocks = ceil(columns / 64.0) * ceil(rows / 64.0) *
+                          samplesPerPixel * 4.0 / 3.0;
+  auto const samples = double(width) * height * samplesPerPixel;
+  auto const peak = double((1u << GetBitsStored(ctx)) - 1u);
+  auto const meetsTarget = [&](double const step, bool const forSize) {
+    double bits, distortion;
+    ModelStep(subbands, step, &bits, &distortion);
+    if (forSize) {
+      auto const bytes = bits / 8.0 * areaScale +
+                         codeBlocks * CodeBlockOverheadBytes +
+                         CodestreamOverheadBytes;
+      return bytes <= double(targetBytes);
+    }
+    auto const mse = max(distortion / samples, 1e-12);
+    return 10.0 * log10(peak * peak / mse) >= targetPsnr;
+  };
+
+  // Bisection over log2(step), between 1/64 and 65536 sample units. The size
+  // target is met above a step (the finest is kept) and the PSNR target below
+  // a step (the coarsest is kept).
+  auto const search = [&](bool const forSize) {
+    auto fine = -6.0;
+    auto coarse = 16.0;
+    for (auto i = 0; i < 32; i++) {
+      auto const middle = (fine + coarse) / 2.0;
+      auto const isCoarseSide = meetsTarget(exp2(middle), forSize) == forSize;
+      (isCoarseSide ? coarse : fine) = middle;
+    }
+    return exp2(forSize ? coarse : fine);
+  };
+
+  auto step = 0.0;
+  if (targetBytes > 0) {
+    step = max(step, search(true));
+  }
+  if (targetPsnr > 0.0f) {
+    step = max(step, search(false));
+  }
+
+  return static_cast<float>(step);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+#include "CodecsContext.h"
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Predicts the lossy HT-JPEG 2000 quantization step, in sample units, that
+// meets a codestream size (0: none) and a PSNR (0: none), without encoding.
+// A 9/7 transform of a window of the frame is summarized into per-subband
+// magnitude histograms, from which the size and the distortion of each
+// candidate step are modelled. The coarser of the two steps is returned.
+float PredictHtJpeg2000QuantizationStep(CodecsContext *ctx,
+                                        size_t const numberOfDecompositions,
+                                        size_t const targetBytes,
+                                        float const targetPsnr);
@@ -0,0 +1,406 @@
+#include "Jpeg2000Tiles.h"
+
+#include <algorithm>
+#include <string>
+#ifdef WASM_CODECS_THREADS
+#include <atomic>
+#include <thread>
+#endif
+
+#include "Exception.h"
+
+using namespace std;
+using namespace ojph;
+
+static uint16_t const MarkerSoc = 0xFF4F;
+static uint16_t const MarkerSiz = 0xFF51;
+static uint16_t const MarkerTlm = 0xFF55;
+static uint16_t const MarkerPlm = 0xFF57;
+static uint16_t const MarkerPpm = 0xFF60;
+static uint16_t const MarkerSot = 0xFF90;
+static uint16_t const MarkerEoc = 0xFFD9;
+
+// SOT marker segment: marker, Lsot, Isot, Psot, TPsot and TNsot
+static size_t const SotSegmentSize = 12;
+// TLM marker segment with 16-bit Ttlm and 32-bit Ptlm entries
+static uint8_t const TlmStlm = 0x60;
+static size_t const TlmMaxEntries = (0xFFFF - 4) / 6;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static uint16_t ReadUint16(uint8_t const *p) {
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static uint32_t ReadUint32(uint8_t const *p) {
+  return (static_cast<uint32_t>(p[0]) << 24) |
+         (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void WriteUint16(uint8_t *p, uint32_t const value) {
+  p[0] = static_cast<uint8_t>(value >> 8);
+  p[1] = static_cast<uint8_t>(value);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void WriteUint32(uint8_t *p, uint32_t const value) {
+  p[0] = static_cast<uint8_t>(value >> 24);
+  p[1] = static_cast<uint8_t>(value >> 16);
+  p[2] = static_cast<uint8_t>(value >> 8);
+  p[3] = static_cast<uint8_t>(value);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Returns the offset of the first SOT marker, or 0 when the main header is
+// malformed
+static size_t FindJpeg2000MainHeaderEnd(uint8_t const *data,
+                                        size_t const size) {
+  if (size < 4 || ReadUint16(data) != MarkerSoc) {
+    return 0;
+  }
+
+  size_t offset = 2;
+  while (offset + 4 <= size) {
+    auto const marker = ReadUint16(data + offset);
+    if (marker == MarkerSot) {
+      return offset;
+    }
+    auto const length = ReadUint16(data + offset + 2);
+    if ((marker >> 8) != 0xFF || length < 2) {
+      return 0;
+    }
+    offset += 2 + length;
+  }
+
+  return 0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Copies the main header, with the SIZ marker segment rewritten for grid. The
+// TLM and PLM marker segments, which describe the source tiles, are dropped.
+static void CopyJpeg2000MainHeader(uint8_t const *data, size_t const headerEnd,
+                                   Jpeg2000TileGrid const &grid,
+                                   vector<uint8_t> *header) {
+  header->assign(data, data + 2);
+
+  size_t offset = 2;
+  while (offset < headerEnd) {
+    auto const marker = ReadUint16(data + offset);
+    auto const segmentSize = 2u + ReadUint16(data + offset + 2);
+    if (marker != MarkerTlm && marker != MarkerPlm) {
+      auto const start = header->size();
+      header->insert(header->end(), data + offset,
+                     data + offset + segmentSize);
+      if (marker == MarkerSiz) {
+        auto *siz = header->data() + start;
+        WriteUint32(siz + 6, grid.ImageX1);
+        WriteUint32(siz + 10, grid.ImageY1);
+        WriteUint32(siz + 14, grid.ImageX0);
+        WriteUint32(siz + 18, grid.ImageY0);
+        WriteUint32(siz + 22, grid.TileWidth);
+        WriteUint32(siz + 26, grid.TileHeight);
+        WriteUint32(siz + 30, grid.TileX0);
+        WriteUint32(siz + 34, grid.TileY0);
+      }
+    }
+    offset += segmentSize;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Walks the tile-parts that follow the main header, calling tilePart with the
+// tile index, the start and the size of each of them. Returns false when a
+// tile-part is malformed.
+static bool ForEachJpeg2000TilePart(
+    uint8_t const *data, size_t const size, size_t const headerEnd,
+    function<bool(size_t, uint8_t const *, size_t)> const &tilePart) {
+  auto offset = headerEnd;
+  while (offset + SotSegmentSize <= size) {
+    auto const marker = ReadUint16(data + offset);
+    if (marker == MarkerEoc) {
+      break;
+    }
+    if (marker != MarkerSot) {
+      return false;
+    }
+
+    // A zero Psot extends the tile-part to the end of the codestream
+    auto tilePartSize = static_cast<size_t>(ReadUint32(data + offset + 6));
+    if (tilePartSize == 0) {
+      tilePartSize = size - offset;
+      if (ReadUint16(data + size - 2) == MarkerEoc) {
+        tilePartSize -= 2;
+      }
+    }
+    if (tilePartSize < SotSegmentSize) {
+      return false;
+    }
+    // Truncated tile-parts are kept as they are, for the resilient decoder
+    tilePartSize = min(tilePartSize, size - offset);
+
+    if (!tilePart(ReadUint16(data + offset + 4), data + offset,
+                  tilePartSize)) {
+      return false;
+    }
+    offset += tilePartSize;
+  }
+
+  return true;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+size_t Jpeg2000TileGrid::GetTilesAcross() const {
+  return (ImageX1 - TileX0 + TileWidth - 1) / TileWidth;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+size_t Jpeg2000TileGrid::GetTilesDown() const {
+  return (ImageY1 - TileY0 + TileHeight - 1) / TileHeight;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+point Jpeg2000TileGrid::GetTileOrigin(size_t const tile) const {
+  auto const tilesAcross = GetTilesAcross();
+
+  return point(
+      TileX0 + static_cast<uint32_t>(tile % tilesAcross) * TileWidth,
+      TileY0 + static_cast<uint32_t>(tile / tilesAcross) * TileHeight);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+rect Jpeg2000TileGrid::GetTileRect(size_t const tile) const {
+  auto const origin = GetTileOrigin(tile);
+  auto const x0 = max(origin.x, ImageX0);
+  auto const y0 = max(origin.y, ImageY0);
+  auto const x1 = min(origin.x + TileWidth, ImageX1);
+  auto const y1 = min(origin.y + TileHeight, ImageY1);
+
+  rect tileRect;
+  tileRect.org = point(x0, y0);
+  tileRect.siz = ojph::size(x1 - x0, y1 - y0);
+
+  return tileRect;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool ReadJpeg2000TileGrid(uint8_t const *data, size_t const size,
+                          Jpeg2000TileGrid *grid) {
+  // SOC, followed by the fixed part of the SIZ marker segment
+  if (size < 40 || ReadUint16(data) != MarkerSoc ||
+      ReadUint16(data + 2) != MarkerSiz) {
+    return false;
+  }
+
+  auto const *siz = data + 2;
+  grid->ImageX1 = ReadUint32(siz + 6);
+  grid->ImageY1 = ReadUint32(siz + 10);
+  grid->ImageX0 = ReadUint32(siz + 14);
+  grid->ImageY0 = ReadUint32(siz + 18);
+  grid->TileWidth = ReadUint32(siz + 22);
+  grid->TileHeight = ReadUint32(siz + 26);
+  grid->TileX0 = ReadUint32(siz + 30);
+  grid->TileY0 = ReadUint32(siz + 34);
+
+  return grid->TileWidth > 0 && grid->TileHeight > 0 &&
+         grid->ImageX0 < grid->ImageX1 && grid->ImageY0 < grid->ImageY1 &&
+         grid->TileX0 <= grid->ImageX0 && grid->TileY0 <= grid->ImageY0;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool SplitJpeg2000Tiles(uint8_t const *data, size_t const size,
+                        Jpeg2000TileGrid const &grid,
+                        vector<vector<uint8_t>> *tiles) {
+  auto const headerEnd = FindJpeg2000MainHeaderEnd(data, size);
+  if (headerEnd == 0) {
+    return false;
+  }
+  for (size_t offset = 2; offset < headerEnd;
+       offset += 2 + ReadUint16(data + offset + 2)) {
+    if (ReadUint16(data + offset) == MarkerPpm) {
+      return false;
+    }
+  }
+
+  auto const numberOfTiles = grid.GetNumberOfTiles();
+  tiles->assign(numberOfTiles, vector<uint8_t>());
+  for (auto t = 0u; t < numberOfTiles; t++) {
+    auto const tileRect = grid.GetTileRect(t);
+    auto const tileOrigin = grid.GetTileOrigin(t);
+    auto tileGrid = grid;
+    tileGrid.ImageX0 = tileRect.org.x;
+    tileGrid.ImageY0 = tileRect.org.y;
+    tileGrid.ImageX1 = tileRect.org.x + tileRect.siz.w;
+    tileGrid.ImageY1 = tileRect.org.y + tileRect.siz.h;
+    tileGrid.TileX0 = tileOrigin.x;
+    tileGrid.TileY0 = tileOrigin.y;
+    CopyJpeg2000MainHeader(data, headerEnd, tileGrid, &(*tiles)[t]);
+  }
+
+  vector<bool> hasTileParts(numberOfTiles, false);
+  auto const result = ForEachJpeg2000TilePart(
+      data, size, headerEnd,
+      [&](size_t const tile, uint8_t const *tilePart, size_t const length) {
+        if (tile >= numberOfTiles) {
+          return false;
+        }
+        auto &codestream = (*tiles)[tile];
+        auto const start = codestream.size();
+        codestream.insert(codestream.end(), tilePart, tilePart + length);
+        WriteUint16(codestream.data() + start + 4, 0);
+        hasTileParts[tile] = true;
+
+        return true;
+      });
+  if (!result || find(hasTileParts.begin(), hasTileParts.end(), false) !=
+                     hasTileParts.end()) {
+    return false;
+  }
+
+  for (auto &codestream : *tiles) {
+    codestream.push_back(static_cast<uint8_t>(MarkerEoc >> 8));
+    codestream.push_back(static_cast<uint8_t>(MarkerEoc));
+  }
+
+  return true;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void StitchJpeg2000Tiles(CodecsContext *ctx, Jpeg2000TileGrid const &grid,
+                         vector<unique_ptr<mem_outfile>> const &tiles) {
+  struct TilePart {
+    uint8_t const *Data;
+    size_t Size;
+    size_t Tile;
+  };
+
+  vector<uint8_t> header;
+  vector<TilePart> tileParts;
+  for (auto t = 0u; t < tiles.size(); t++) {
+    auto const *data = static_cast<uint8_t const *>(tiles[t]->get_data());
+    auto const size = static_cast<size_t>(tiles[t]->tell());
+    auto const headerEnd = FindJpeg2000MainHeaderEnd(data, size);
+    if (headerEnd == 0) {
+      ThrowCodecsException(
+          "StitchJpeg2000Tiles::Malformed main header of tile " +
+          to_string(t));
+    }
+    if (t == 0) {
+      CopyJpeg2000MainHeader(data, headerEnd, grid, &header);
+    }
+
+    auto const result = ForEachJpeg2000TilePart(
+        data, size, headerEnd,
+        [&](size_t const tile, uint8_t const *tilePart, size_t const length) {
+          tileParts.push_back({tilePart, length, t});
+          return tile == 0;
+        });
+    if (!result) {
+      ThrowCodecsException("StitchJpeg2000Tiles::Malformed tile-part of tile " +
+                           to_string(t));
+    }
+  }
+  auto const numberOfTlms =
+      (tileParts.size() + TlmMaxEntries - 1) / TlmMaxEntries;
+  if (numberOfTlms > 256) {
+    ThrowCodecsException("StitchJpeg2000Tiles::Too many tile-parts (" +
+                         to_string(tileParts.size()) + ")");
+  }
+
+  // The TLM marker segments, followed by the tile-parts and EOC
+  auto encodedSize =
+      header.size() + numberOfTlms * 6 + tileParts.size() * 6 + 2;
+  for (auto const &tilePart : tileParts) {
+    encodedSize += tilePart.Size;
+  }
+  SetEncodedBufferSize(ctx, encodedSize);
+  auto *dp = GetEncodedBuffer(ctx);
+
+  memcpy(dp, header.data(), header.size());
+  dp += header.size();
+  for (auto z = 0u; z < numberOfTlms; z++) {
+    auto const first = z * TlmMaxEntries;
+    auto const count = min(TlmMaxEntries, tileParts.size() - first);
+    WriteUint16(dp, MarkerTlm);
+    WriteUint16(dp + 2, static_cast<uint32_t>(4 + count * 6));
+    dp[4] = static_cast<uint8_t>(z);
+    dp[5] = TlmStlm;
+    dp += 6;
+    for (auto i = first; i < first + count; i++) {
+      WriteUint16(dp, static_cast<uint32_t>(tileParts[i].Tile));
+      WriteUint32(dp + 2, static_cast<uint32_t>(tileParts[i].Size));
+      dp += 6;
+    }
+  }
+  for (auto const &tilePart : tileParts) {
+    memcpy(dp, tilePart.Data, tilePart.Size);
+    WriteUint16(dp + 4, static_cast<uint32_t>(tilePart.Tile));
+    // Psot is always signaled, also for a tile-part that ran to the end
+    WriteUint32(dp + 6, static_cast<uint32_t>(tilePart.Size));
+    dp += tilePart.Size;
+  }
+  WriteUint16(dp, MarkerEoc);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+size_t GetJpeg2000WorkerCount(size_t const threadCount) {
+#ifdef WASM_CODECS_THREADS
+  auto const workers =
+      threadCount == 0 ? thread::hardware_concurrency() : threadCount;
+
+  return max(workers, size_t(1));
+#else
+  (void)threadCount;
+
+  return 1;
+#endif
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void RunJpeg2000TileJobs(size_t const numberOfTiles, size_t const workers,
+                         function<void(size_t)> const &job) {
+#ifdef WASM_CODECS_THREADS
+  if (workers > 1 && numberOfTiles > 1) {
+    atomic<size_t> nextTile(0);
+    auto const worker = [&]() {
+      for (auto t = nextTile++; t < numberOfTiles; t = nextTile++) {
+        job(t);
+      }
+    };
+
+    vector<thread> threads;
+    for (auto i = 1u; i < min(workers, numberOfTiles); i++) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    return;
+  }
+#else
+  (void)workers;
+#endif
+
+  for (auto t = 0u; t < numberOfTiles; t++) {
+    job(t);
+  }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <ojph_base.h>
+#include <ojph_file.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "CodecsContext.h"
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct Jpeg2000TileGrid {
+  // Canvas coordinates of the SIZ marker segment
+  uint32_t ImageX0 = 0;
+  uint32_t ImageY0 = 0;
+  uint32_t ImageX1 = 0;
+  uint32_t ImageY1 = 0;
+  uint32_t TileX0 = 0;
+  uint32_t TileY0 = 0;
+  uint32_t TileWidth = 0;
+  uint32_t TileHeight = 0;
+
+  size_t GetTilesAcross() const;
+  size_t GetTilesDown() const;
+  size_t GetNumberOfTiles() const { return GetTilesAcross() * GetTilesDown(); }
+  // Tile origin on the canvas, before clipping to the image
+  ojph::point GetTileOrigin(size_t const tile) const;
+  // Tile area on the canvas, clipped to the image
+  ojph::rect GetTileRect(size_t const tile) const;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool ReadJpeg2000TileGrid(uint8_t const *data, size_t const size,
+                          Jpeg2000TileGrid *grid);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Splits a tiled codestream into standalone codestreams of one tile each. The
+// image and tile origins of each codestream are moved to the tile, so that it
+// decodes to the same samples as in the tiled codestream. Returns false when
+// the codestream cannot be split (PPM marker segment, missing tiles).
+bool SplitJpeg2000Tiles(uint8_t const *data, size_t const size,
+                        Jpeg2000TileGrid const &grid,
+                        std::vector<std::vector<uint8_t>> *tiles);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Stitches codestreams of one tile each, encoded with their image and tile
+// origins at the tile position, into the encoded buffer as a single tiled
+// codestream with a TLM marker segment.
+void StitchJpeg2000Tiles(
+    CodecsContext *ctx, Jpeg2000TileGrid const &grid,
+    std::vector<std::unique_ptr<ojph::mem_outfile>> const &tiles);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Worker count for threadCount (0 picks the hardware concurrency, 1 stays
+// serial). Builds without WASM_CODECS_THREADS always return 1.
+size_t GetJpeg2000WorkerCount(size_t const threadCount);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Runs job for each tile, spread over workers threads including the calling
+// one.
+void RunJpeg2000TileJobs(size_t const numberOfTiles, size_t const workers,
+                         std::function<void(size_t)> const &job);
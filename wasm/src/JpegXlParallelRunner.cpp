@@ -0,0 +1,73 @@
+#include "JpegXlParallelRunner.h"
+
+#ifdef WASM_CODECS_THREADS
+#include <jxl/thread_parallel_runner.h>
+#endif
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+JpegXlParallelRunner::~JpegXlParallelRunner() {
+#ifdef WASM_CODECS_THREADS
+  if (runner_) {
+    JxlThreadParallelRunnerDestroy(runner_);
+  }
+#endif
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool JpegXlParallelRunner::Attach(JxlEncoder *enc, size_t const threadCount) {
+#ifdef WASM_CODECS_THREADS
+  auto *runner = GetRunner(threadCount);
+  if (runner) {
+    return JxlEncoderSetParallelRunner(enc, JxlThreadParallelRunner, runner) ==
+           JXL_ENC_SUCCESS;
+  }
+#endif
+
+  return true;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+bool JpegXlParallelRunner::Attach(JxlDecoder *dec, size_t const threadCount) {
+#ifdef WASM_CODECS_THREADS
+  auto *runner = GetRunner(threadCount);
+  if (runner) {
+    return JxlDecoderSetParallelRunner(dec, JxlThreadParallelRunner, runner) ==
+           JXL_DEC_SUCCESS;
+  }
+#endif
+
+  return true;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *JpegXlParallelRunner::GetRunner(size_t const threadCount) {
+#ifdef WASM_CODECS_THREADS
+  auto const workers = threadCount == 0
+                           ? JxlThreadParallelRunnerDefaultNumWorkerThreads()
+                           : threadCount;
+  if (workers <= 1) {
+    return nullptr;
+  }
+
+  // The worker threads are kept alive across the frames of a session and only
+  // respawned when a different thread count is requested
+  if (runner_ && threadCount_ != workers) {
+    JxlThreadParallelRunnerDestroy(runner_);
+    runner_ = nullptr;
+  }
+  if (!runner_) {
+    runner_ = JxlThreadParallelRunnerCreate(nullptr, workers);
+    threadCount_ = workers;
+  }
+
+  return runner_;
+#else
+  (void)threadCount;
+
+  return nullptr;
+#endif
+}
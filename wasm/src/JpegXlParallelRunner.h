@@ -0,0 +1,26 @@
+#pragma once
+
+#include <jxl/decode.h>
+#include <jxl/encode.h>
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegXlParallelRunner {
+  JpegXlParallelRunner() {}
+  virtual ~JpegXlParallelRunner();
+
+  // Attaches the libjxl thread pool, spreading the frame groups over
+  // threadCount workers (0 picks the hardware concurrency, 1 stays serial).
+  // Builds without WASM_CODECS_THREADS always process the groups serially.
+  bool Attach(JxlEncoder *enc, size_t const threadCount);
+  bool Attach(JxlDecoder *dec, size_t const threadCount);
+
+  JpegXlParallelRunner(JpegXlParallelRunner const &) = delete;
+  JpegXlParallelRunner &operator=(JpegXlParallelRunner const &) = delete;
+
+ private:
+  void *GetRunner(size_t const threadCount);
+
+  void *runner_ = nullptr;
+  size_t threadCount_ = 0;
+};
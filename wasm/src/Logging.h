@@ -5,6 +5,7 @@
 #include "CodecsContext.h"
 #include "DecoderParameters.h"
 #include "EncoderParameters.h"
+#include "TransformParameters.h"
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -55,6 +56,24 @@
   TRACE("File: %s, Line: %d, Function: %s - Exit", __FILE_NAME__, __LINE__, \
         __PRETTY_FUNCTION__)
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#define TRANSFORM_TRACE_ENTRY(ctx, params)                                     \
+  TRACE("File: %s, Line: %d, Function: %s - Entry", __FILE_NAME__, __LINE__,   \
+        __PRETTY_FUNCTION__)                                                   \
+  TRACE("File: %s, Line: %d - Entry Context - %s", __FILE_NAME__, __LINE__,    \
+        ContextToString(ctx).c_str())                                          \
+  TRACE("File: %s, Line: %d - Entry Transform Parameters - %s", __FILE_NAME__, \
+        __LINE__, TransformParametersToString(params).c_str())
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#define TRANSFORM_TRACE_EXIT(ctx)                                           \
+  TRACE("File: %s, Line: %d - Exit Context - %s", __FILE_NAME__, __LINE__,  \
+        ContextToString(ctx).c_str())                                       \
+  TRACE("File: %s, Line: %d, Function: %s - Exit", __FILE_NAME__, __LINE__, \
+        __PRETTY_FUNCTION__)
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 void OutputCodecsInfo(std::string const &info);
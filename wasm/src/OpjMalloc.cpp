@@ -0,0 +1,92 @@
+// Replacement for openjpeg-2.5.0/opj_malloc.c, routing the OpenJPEG
+// allocations through the codecs arena. The zero-size behavior of the
+// original implementation is kept.
+
+#include <cstring>
+
+#include "CodecsArena.h"
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *opj_malloc(size_t size) {
+  if (size == 0U) {
+    return nullptr;
+  }
+
+  return GetCodecsArena().Allocate(size);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *opj_calloc(size_t num, size_t size) {
+  if (num == 0 || size == 0 || num > SIZE_MAX / size) {
+    return nullptr;
+  }
+
+  auto *ptr = GetCodecsArena().Allocate(num * size);
+  if (ptr) {
+    memset(ptr, 0, num * size);
+  }
+
+  return ptr;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *opj_aligned_malloc(size_t size) {
+  if (size == 0U) {
+    return nullptr;
+  }
+
+  return GetCodecsArena().Allocate(size, 16);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *opj_aligned_realloc(void *ptr, size_t size) {
+  if (size == 0U) {
+    return nullptr;
+  }
+
+  return GetCodecsArena().Reallocate(ptr, size, 16);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *opj_aligned_32_malloc(size_t size) {
+  if (size == 0U) {
+    return nullptr;
+  }
+
+  return GetCodecsArena().Allocate(size, 32);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *opj_aligned_32_realloc(void *ptr, size_t size) {
+  if (size == 0U) {
+    return nullptr;
+  }
+
+  return GetCodecsArena().Reallocate(ptr, size, 32);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void opj_aligned_free(void *ptr) { GetCodecsArena().Free(ptr); }
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void *opj_realloc(void *ptr, size_t size) {
+  if (size == 0U) {
+    return nullptr;
+  }
+
+  return GetCodecsArena().Reallocate(ptr, size);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void opj_free(void *ptr) { GetCodecsArena().Free(ptr); }
+}
@@ -0,0 +1,126 @@
+#include <emscripten.h>
+
+#include <string>
+
+#include "CodecsContext.h"
+#include "DecoderParameters.h"
+#include "EncoderParameters.h"
+#include "Exception.h"
+#include "Logging.h"
+
+using namespace std;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+BETTER_ENUM(TranscodeCodecEnum, size_t, Rle = 0, Jpeg, JpegLs, Jpeg2000,
+            HtJpeg2000, JpegXl)
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void DecodeRle(CodecsContext *ctx, DecoderParameters *params);
+void DecodeJpeg(CodecsContext *ctx, DecoderParameters *params);
+void DecodeJpegLs(CodecsContext *ctx, DecoderParameters *params);
+void DecodeJpeg2000(CodecsContext *ctx, DecoderParameters *params);
+void DecodeHtJpeg2000(CodecsContext *ctx, DecoderParameters *params);
+void DecodeJpegXl(CodecsContext *ctx, DecoderParameters *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void EncodeRle(CodecsContext *ctx, EncoderParameters *params);
+void EncodeJpeg(CodecsContext *ctx, EncoderParameters *params);
+void EncodeJpegLs(CodecsContext *ctx, EncoderParameters *params);
+void EncodeJpeg2000(CodecsContext *ctx, EncoderParameters *params);
+void EncodeHtJpeg2000(CodecsContext *ctx, EncoderParameters *params);
+void EncodeJpegXl(CodecsContext *ctx, EncoderParameters *params);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void DecodeFrame(CodecsContext *ctx, TranscodeCodecEnum const decoder,
+                        DecoderParameters *params) {
+  switch (decoder) {
+    case TranscodeCodecEnum::Rle:
+      DecodeRle(ctx, params);
+      break;
+    case TranscodeCodecEnum::Jpeg:
+      DecodeJpeg(ctx, params);
+      break;
+    case TranscodeCodecEnum::JpegLs:
+      DecodeJpegLs(ctx, params);
+      break;
+    case TranscodeCodecEnum::Jpeg2000:
+      DecodeJpeg2000(ctx, params);
+      break;
+    case TranscodeCodecEnum::HtJpeg2000:
+      DecodeHtJpeg2000(ctx, params);
+      break;
+    case TranscodeCodecEnum::JpegXl:
+      DecodeJpegXl(ctx, params);
+      break;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void EncodeFrame(CodecsContext *ctx, TranscodeCodecEnum const encoder,
+                        EncoderParameters *params) {
+  switch (encoder) {
+    case TranscodeCodecEnum::Rle:
+      EncodeRle(ctx, params);
+      break;
+    case TranscodeCodecEnum::Jpeg:
+      EncodeJpeg(ctx, params);
+      break;
+    case TranscodeCodecEnum::JpegLs:
+      EncodeJpegLs(ctx, params);
+      break;
+    case TranscodeCodecEnum::Jpeg2000:
+      EncodeJpeg2000(ctx, params);
+      break;
+    case TranscodeCodecEnum::HtJpeg2000:
+      EncodeHtJpeg2000(ctx, params);
+      break;
+    case TranscodeCodecEnum::JpegXl:
+      EncodeJpegXl(ctx, params);
+      break;
+  }
+}
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Decodes the encoded frame of the context and encodes it again, without
+// handing the uncompressed frame back. The decoded buffer is encoded in place
+// and the encoded buffer is overwritten with the new codestream. The decoder
+// and encoder sessions of the context are both carried to the next frame.
+// No arena scope is opened here, so that the decoder scratch memory is
+// reclaimed before the encoder runs.
+EMSCRIPTEN_KEEPALIVE void TranscodeFrame(
+    CodecsContext *ctx, size_t const decoder, DecoderParameters *decoderParams,
+    size_t const encoder, EncoderParameters *encoderParams,
+    size_t const photometricInterpretation) {
+  DECODER_TRACE_ENTRY(ctx, decoderParams);
+
+  auto const maybeDecoder = TranscodeCodecEnum::_from_integral_nothrow(decoder);
+  if (!maybeDecoder) {
+    ThrowCodecsException("TranscodeFrame::Unsupported decoder (" +
+                         to_string(decoder) + ")");
+  }
+  auto const maybeEncoder = TranscodeCodecEnum::_from_integral_nothrow(encoder);
+  if (!maybeEncoder) {
+    ThrowCodecsException("TranscodeFrame::Unsupported encoder (" +
+                         to_string(encoder) + ")");
+  }
+
+  DecodeFrame(ctx, *maybeDecoder, decoderParams);
+
+  // The photometric interpretation of the decoded frame, as the encoder
+  // expects it (e.g. YBR_FULL for a color JPEG baseline frame)
+  SetPhotometricInterpretation(ctx, photometricInterpretation);
+
+  EncodeFrame(ctx, *maybeEncoder, encoderParams);
+
+  DECODER_TRACE_EXIT(ctx);
+}
+}
@@ -0,0 +1,58 @@
+#include "TransformParameters.h"
+
+#include <sstream>
+
+using namespace std;
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE TransformParameters *CreateTransformParameters(void) {
+  return new TransformParameters;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void ReleaseTransformParameters(
+    TransformParameters const *params) {
+  if (params) {
+    delete params;
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetTransformOperationCount(TransformParameters const *params) {
+  return params->Operations.size();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void AddTransformOperation(
+    TransformParameters *params, size_t const operation, size_t const x,
+    size_t const y, size_t const width, size_t const height) {
+  params->Operations.push_back({operation, x, y, width, height});
+}
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+string TransformParametersToString(TransformParameters const *params) {
+  ostringstream oss;
+
+  oss << "Operations: [";
+  for (auto i = 0u; i < params->Operations.size(); i++) {
+    auto const &op = params->Operations[i];
+    auto const operation =
+        TransformOperationEnum::_from_integral_nothrow(op.Operation);
+
+    oss << (i > 0 ? ", " : "") << (operation ? operation->_to_string() : "");
+    oss << " (X: " << to_string(op.X) << ", Y: " << to_string(op.Y)
+        << ", Width: " << to_string(op.Width)
+        << ", Height: " << to_string(op.Height) << ")";
+  }
+  oss << "]";
+
+  return oss.str();
+}
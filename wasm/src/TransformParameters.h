@@ -0,0 +1,57 @@
+#pragma once
+
+#include <emscripten.h>
+#include <enum.h>
+
+#include <string>
+#include <vector>
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+BETTER_ENUM(TransformOperationEnum, size_t, Crop = 0, Blank, FlipHorizontal,
+            FlipVertical, Transpose, Rotate90, Rotate180, Rotate270)
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct TransformOperation {
+  size_t Operation = 0;
+  // Region, in pixels [Crop / Blank]
+  size_t X = 0;
+  size_t Y = 0;
+  size_t Width = 0;
+  size_t Height = 0;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct TransformParameters {
+  // Operations, applied in order
+  std::vector<TransformOperation> Operations;
+};
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE TransformParameters *CreateTransformParameters(void);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void ReleaseTransformParameters(
+    TransformParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE size_t
+GetTransformOperationCount(TransformParameters const *params);
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void AddTransformOperation(TransformParameters *params,
+                                                size_t operation, size_t x,
+                                                size_t y, size_t width,
+                                                size_t height);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+std::string TransformParametersToString(TransformParameters const *params);
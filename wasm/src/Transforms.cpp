@@ -0,0 +1,21 @@
+#include <emscripten.h>
+
+#include "CodecsContext.h"
+#include "Logging.h"
+#include "TransformParameters.h"
+#include "Transforms/JpegTransform8.h"
+
+using namespace std;
+
+extern "C" {
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+EMSCRIPTEN_KEEPALIVE void TransformJpeg(CodecsContext *ctx,
+                                        TransformParameters *params) {
+  TRANSFORM_TRACE_ENTRY(ctx, params);
+
+  TransformJpeg8(ctx, params);
+
+  TRANSFORM_TRACE_EXIT(ctx);
+}
+}
@@ -0,0 +1,459 @@
+#include "JpegTransform8.h"
+
+#include <jerror8.h>
+#include <jpeglib8.h>
+#include <setjmp.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Exception.h"
+#include "Logging.h"
+
+using namespace std;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#define JPEG8_BLOCKSIZE 16384
+
+struct JpegTransformDestinationManager8 : public jpeg_destination_mgr {
+  vector<JOCTET> data;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegTransformComponent8 {
+  int H = 1;
+  int V = 1;
+  size_t WidthInBlocks = 0;
+  size_t HeightInBlocks = 0;
+  // Quantized DC value written into blanked blocks
+  JCOEF BlankDc = 0;
+  // Quantized DCT coefficients, one 8x8 block after the other, in raster order
+  vector<JCOEF> Coefficients;
+
+  JCOEF *Block(size_t x, size_t y) {
+    return &Coefficients[(y * WidthInBlocks + x) * DCTSIZE2];
+  }
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegTransformImage8 {
+  size_t Width = 0;
+  size_t Height = 0;
+  int MaxH = 1;
+  int MaxV = 1;
+  bool Transposed = false;
+  vector<JpegTransformComponent8> Components;
+
+  size_t McuWidth() const { return static_cast<size_t>(MaxH) * DCTSIZE; }
+  size_t McuHeight() const { return static_cast<size_t>(MaxV) * DCTSIZE; }
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+struct JpegTransformSession8 : public CodecSession {
+  JpegTransformSession8() {
+    dinfo.err = jpeg_std_error(&jerr);
+    dinfo.err->error_exit = [](j_common_ptr cinfo) {
+      char buf[JMSG_LENGTH_MAX];
+      (*cinfo->err->format_message)(cinfo, buf);
+      ThrowCodecsException("JpegTransform8::ErrorExit::" + string(buf));
+    };
+    dinfo.err->output_message = [](j_common_ptr cinfo) {
+      char buf[JMSG_LENGTH_MAX];
+      (*cinfo->err->format_message)(cinfo, buf);
+      OutputCodecsInfo("JpegTransform8::OutputMessage::" + string(buf));
+    };
+    dinfo.err->emit_message = [](j_common_ptr cinfo, int messageLevel) {
+      char buf[JMSG_LENGTH_MAX];
+      (*cinfo->err->format_message)(cinfo, buf);
+      OutputCodecsInfo("JpegTransform8::EmitMessage::" + string(buf));
+    };
+    cinfo.err = &jerr;
+    jpeg_create_decompress(&dinfo);
+    jpeg_create_compress(&cinfo);
+
+    memset(&src, 0, sizeof(src));
+    src.init_source = [](j_decompress_ptr dinfo) {};
+    src.fill_input_buffer = [](j_decompress_ptr dinfo) -> boolean {
+      static uint8_t buf[4] = {0xff, 0xd9, 0, 0};
+      dinfo->src->next_input_byte = buf;
+      dinfo->src->bytes_in_buffer = 2;
+
+      return TRUE;
+    };
+    src.skip_input_data = [](j_decompress_ptr dinfo, long nBytes) {
+      auto &src = *dinfo->src;
+      if (nBytes > 0) {
+        while (nBytes > static_cast<long>(src.bytes_in_buffer)) {
+          nBytes -= static_cast<long>(src.bytes_in_buffer);
+          (*src.fill_input_buffer)(dinfo);
+        }
+        src.next_input_byte += nBytes;
+        src.bytes_in_buffer -= static_cast<size_t>(nBytes);
+      }
+    };
+    src.resync_to_restart = jpeg_resync_to_restart;
+    src.term_source = [](j_decompress_ptr) {};
+    dinfo.src = &src;
+
+    dest.init_destination = [](j_compress_ptr cinfo) {
+      auto dest =
+          reinterpret_cast<JpegTransformDestinationManager8 *>(cinfo->dest);
+      dest->data.resize(max<size_t>(dest->data.capacity(), JPEG8_BLOCKSIZE));
+      dest->next_output_byte = &dest->data[0];
+      dest->free_in_buffer = dest->data.size();
+    };
+    dest.empty_output_buffer = [](j_compress_ptr cinfo) -> boolean {
+      auto dest =
+          reinterpret_cast<JpegTransformDestinationManager8 *>(cinfo->dest);
+      auto const oldSize = dest->data.size();
+      dest->data.resize(oldSize + JPEG8_BLOCKSIZE);
+      cinfo->dest->next_output_byte = &dest->data[oldSize];
+      cinfo->dest->free_in_buffer = dest->data.size() - oldSize;
+
+      return TRUE;
+    };
+    dest.term_destination = [](j_compress_ptr cinfo) {
+      auto dest =
+          reinterpret_cast<JpegTransformDestinationManager8 *>(cinfo->dest);
+      dest->data.resize(dest->data.size() - cinfo->dest->free_in_buffer);
+    };
+    cinfo.dest = &dest;
+  }
+
+  ~JpegTransformSession8() override {
+    jpeg_destroy_compress(&cinfo);
+    jpeg_destroy_decompress(&dinfo);
+  }
+
+  jpeg_error_mgr jerr;
+  jpeg_source_mgr src;
+  JpegTransformDestinationManager8 dest;
+  jpeg_decompress_struct dinfo;
+  jpeg_compress_struct cinfo;
+  JpegTransformImage8 image;
+};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static size_t BlocksFor(size_t pixels, int sampleFactor, int maxSampleFactor) {
+  auto const blockSize = static_cast<size_t>(maxSampleFactor) * DCTSIZE;
+  auto const samples = pixels * static_cast<size_t>(sampleFactor);
+
+  return (samples + blockSize - 1) / blockSize;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void CropImage(JpegTransformImage8 &image,
+                      TransformOperation const &op) {
+  if (op.Width == 0 || op.Height == 0 || op.X >= image.Width ||
+      op.Y >= image.Height) {
+    ThrowCodecsException(
+        "JpegTransform8::CropImage::Crop region is outside of the image");
+  }
+
+  // The top-left corner is moved back to the nearest iMCU boundary, as blocks
+  // cannot be split without decoding them
+  auto const x = op.X - op.X % image.McuWidth();
+  auto const y = op.Y - op.Y % image.McuHeight();
+  auto const width = op.X - x + min(op.Width, image.Width - op.X);
+  auto const height = op.Y - y + min(op.Height, image.Height - op.Y);
+
+  for (auto &comp : image.Components) {
+    auto const bx = x / image.McuWidth() * static_cast<size_t>(comp.H);
+    auto const by = y / image.McuHeight() * static_cast<size_t>(comp.V);
+    auto const w = BlocksFor(width, comp.H, image.MaxH);
+    auto const h = BlocksFor(height, comp.V, image.MaxV);
+
+    vector<JCOEF> coefficients(w * h * DCTSIZE2);
+    for (auto row = 0u; row < h; row++) {
+      memcpy(&coefficients[row * w * DCTSIZE2], comp.Block(bx, by + row),
+             w * sizeof(JBLOCK));
+    }
+    comp.Coefficients.swap(coefficients);
+    comp.WidthInBlocks = w;
+    comp.HeightInBlocks = h;
+  }
+  image.Width = width;
+  image.Height = height;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void BlankImage(JpegTransformImage8 &image,
+                       TransformOperation const &op) {
+  if (op.X >= image.Width || op.Y >= image.Height) {
+    return;
+  }
+  auto const right = op.X + min(op.Width, image.Width - op.X);
+  auto const bottom = op.Y + min(op.Height, image.Height - op.Y);
+
+  // Every block touched by the region is replaced by a flat block
+  for (auto &comp : image.Components) {
+    auto const x0 = op.X * static_cast<size_t>(comp.H) / image.McuWidth();
+    auto const y0 = op.Y * static_cast<size_t>(comp.V) / image.McuHeight();
+    auto const x1 =
+        min(BlocksFor(right, comp.H, image.MaxH), comp.WidthInBlocks);
+    auto const y1 =
+        min(BlocksFor(bottom, comp.V, image.MaxV), comp.HeightInBlocks);
+
+    for (auto by = y0; by < y1; by++) {
+      for (auto bx = x0; bx < x1; bx++) {
+        auto const block = comp.Block(bx, by);
+        fill(block, block + DCTSIZE2, 0);
+        block[0] = comp.BlankDc;
+      }
+    }
+  }
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void FlipImageHorizontally(JpegTransformImage8 &image) {
+  // A partial iMCU column at the right edge cannot be mirrored and is trimmed
+  auto const width = image.Width - image.Width % image.McuWidth();
+  if (width == 0) {
+    ThrowCodecsException(
+        "JpegTransform8::FlipImageHorizontally::Image is narrower than one "
+        "MCU");
+  }
+
+  for (auto &comp : image.Components) {
+    auto const w = width / image.McuWidth() * static_cast<size_t>(comp.H);
+    auto const h = comp.HeightInBlocks;
+
+    // Mirroring a block negates its odd horizontal frequencies
+    vector<JCOEF> coefficients(w * h * DCTSIZE2);
+    for (auto by = 0u; by < h; by++) {
+      for (auto bx = 0u; bx < w; bx++) {
+        auto const src = comp.Block(w - 1 - bx, by);
+        auto const dst = &coefficients[(by * w + bx) * DCTSIZE2];
+        for (auto k = 0; k < DCTSIZE2; k++) {
+          dst[k] = (k % DCTSIZE) & 1 ? -src[k] : src[k];
+        }
+      }
+    }
+    comp.Coefficients.swap(coefficients);
+    comp.WidthInBlocks = w;
+  }
+  image.Width = width;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void FlipImageVertically(JpegTransformImage8 &image) {
+  // A partial iMCU row at the bottom edge cannot be mirrored and is trimmed
+  auto const height = image.Height - image.Height % image.McuHeight();
+  if (height == 0) {
+    ThrowCodecsException(
+        "JpegTransform8::FlipImageVertically::Image is shorter than one MCU");
+  }
+
+  for (auto &comp : image.Components) {
+    auto const w = comp.WidthInBlocks;
+    auto const h = height / image.McuHeight() * static_cast<size_t>(comp.V);
+
+    // Mirroring a block negates its odd vertical frequencies
+    vector<JCOEF> coefficients(w * h * DCTSIZE2);
+    for (auto by = 0u; by < h; by++) {
+      for (auto bx = 0u; bx < w; bx++) {
+        auto const src = comp.Block(bx, h - 1 - by);
+        auto const dst = &coefficients[(by * w + bx) * DCTSIZE2];
+        for (auto k = 0; k < DCTSIZE2; k++) {
+          dst[k] = (k / DCTSIZE) & 1 ? -src[k] : src[k];
+        }
+      }
+    }
+    comp.Coefficients.swap(coefficients);
+    comp.HeightInBlocks = h;
+  }
+  image.Height = height;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+static void TransposeImage(JpegTransformImage8 &image) {
+  for (auto &comp : image.Components) {
+    auto const w = comp.HeightInBlocks;
+    auto const h = comp.WidthInBlocks;
+
+    vector<JCOEF> coefficients(w * h * DCTSIZE2);
+    for (auto by = 0u; by < h; by++) {
+      for (auto bx = 0u; bx < w; bx++) {
+        auto const src = comp.Block(by, bx);
+        auto const dst = &coefficients[(by * w + bx) * DCTSIZE2];
+        for (auto i = 0; i < DCTSIZE; i++) {
+          for (auto j = 0; j < DCTSIZE; j++) {
+            dst[i * DCTSIZE + j] = src[j * DCTSIZE + i];
+          }
+        }
+      }
+    }
+    comp.Coefficients.swap(coefficients);
+    comp.WidthInBlocks = w;
+    comp.HeightInBlocks = h;
+    swap(comp.H, comp.V);
+  }
+  swap(image.Width, image.Height);
+  swap(image.MaxH, image.MaxV);
+  image.Transposed = !image.Transposed;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void TransformJpeg8(CodecsContext *ctx, TransformParameters *params) {
+  auto session = GetCodecSession<JpegTransformSession8>(ctx->EncoderSession);
+  auto &dinfo = session->dinfo;
+  auto &cinfo = session->cinfo;
+  auto &image = session->image;
+
+  jpeg_abort_decompress(&dinfo);
+  jpeg_abort_compress(&cinfo);
+  session->src.bytes_in_buffer = GetEncodedBufferSize(ctx);
+  session->src.next_input_byte = GetEncodedBuffer(ctx);
+
+  if (jpeg_read_header(&dinfo, TRUE) != JPEG_HEADER_OK) {
+    ThrowCodecsException(
+        "JpegTransform8::TransformJpeg8::jpeg_read_header::No image");
+  }
+  if (dinfo.process == JPROC_LOSSLESS) {
+    ThrowCodecsException(
+        "JpegTransform8::TransformJpeg8::Lossless JPEG has no DCT "
+        "coefficients");
+  }
+  auto const srcCoefArrays = jpeg_read_coefficients(&dinfo);
+  if (srcCoefArrays == nullptr) {
+    ThrowCodecsException(
+        "JpegTransform8::TransformJpeg8::jpeg_read_coefficients::Suspended");
+  }
+
+  image.Width = dinfo.image_width;
+  image.Height = dinfo.image_height;
+  image.MaxH = dinfo.max_h_samp_factor;
+  image.MaxV = dinfo.max_v_samp_factor;
+  image.Transposed = false;
+  image.Components.resize(static_cast<size_t>(dinfo.num_components));
+  for (auto ci = 0; ci < dinfo.num_components; ci++) {
+    auto const compptr = &dinfo.comp_info[ci];
+    auto &comp = image.Components[static_cast<size_t>(ci)];
+    comp.H = compptr->h_samp_factor;
+    comp.V = compptr->v_samp_factor;
+    comp.WidthInBlocks = compptr->width_in_data_units;
+    comp.HeightInBlocks = compptr->height_in_data_units;
+
+    // Blanked blocks are black in luminance (or non-YCbCr) components and
+    // neutral in chrominance components. The black level is -128 after the
+    // level shift, which is a DC coefficient of -1024 before quantization.
+    auto const isChroma = dinfo.jpeg_color_space == JCS_YCbCr && ci > 0;
+    auto const q = compptr->quant_table != nullptr
+                       ? static_cast<int>(compptr->quant_table->quantval[0])
+                       : 1;
+    comp.BlankDc = isChroma ? 0 : static_cast<JCOEF>(-((1024 + q / 2) / q));
+
+    comp.Coefficients.resize(comp.WidthInBlocks * comp.HeightInBlocks *
+                             DCTSIZE2);
+    for (auto by = 0u; by < comp.HeightInBlocks; by++) {
+      auto const row = (*dinfo.mem->access_virt_barray)(
+          reinterpret_cast<j_common_ptr>(&dinfo), srcCoefArrays[ci],
+          static_cast<JDIMENSION>(by), 1, FALSE);
+      memcpy(comp.Block(0, by), row[0], comp.WidthInBlocks * sizeof(JBLOCK));
+    }
+  }
+
+  // Quantization tables, component identifiers and JFIF data are kept, which
+  // is what makes the whole transformation lossless
+  jpeg_copy_critical_parameters(&dinfo, &cinfo);
+  jpeg_finish_decompress(&dinfo);
+
+  for (auto const &op : params->Operations) {
+    switch (op.Operation) {
+      case TransformOperationEnum::Crop:
+        CropImage(image, op);
+        break;
+      case TransformOperationEnum::Blank:
+        BlankImage(image, op);
+        break;
+      case TransformOperationEnum::FlipHorizontal:
+        FlipImageHorizontally(image);
+        break;
+      case TransformOperationEnum::FlipVertical:
+        FlipImageVertically(image);
+        break;
+      case TransformOperationEnum::Transpose:
+        TransposeImage(image);
+        break;
+      case TransformOperationEnum::Rotate90:
+        TransposeImage(image);
+        FlipImageHorizontally(image);
+        break;
+      case TransformOperationEnum::Rotate180:
+        FlipImageHorizontally(image);
+        FlipImageVertically(image);
+        break;
+      case TransformOperationEnum::Rotate270:
+        TransposeImage(image);
+        FlipImageVertically(image);
+        break;
+      default:
+        ThrowCodecsException(
+            "JpegTransform8::TransformJpeg8::Unknown transform operation");
+    }
+  }
+
+  cinfo.image_width = static_cast<JDIMENSION>(image.Width);
+  cinfo.image_height = static_cast<JDIMENSION>(image.Height);
+  cinfo.optimize_coding = TRUE;
+  for (auto ci = 0; ci < cinfo.num_components; ci++) {
+    auto const &comp = image.Components[static_cast<size_t>(ci)];
+    cinfo.comp_info[ci].h_samp_factor = comp.H;
+    cinfo.comp_info[ci].v_samp_factor = comp.V;
+  }
+  if (image.Transposed) {
+    for (auto tbl : cinfo.quant_tbl_ptrs) {
+      if (tbl == nullptr) {
+        continue;
+      }
+      for (auto i = 0; i < DCTSIZE; i++) {
+        for (auto j = 0; j < i; j++) {
+          swap(tbl->quantval[i * DCTSIZE + j], tbl->quantval[j * DCTSIZE + i]);
+        }
+      }
+    }
+  }
+
+  // The destination arrays are padded to whole iMCUs, as the coefficient
+  // controller accesses them one iMCU row at a time
+  auto const pCommon = reinterpret_cast<j_common_ptr>(&cinfo);
+  vector<jvirt_barray_ptr> dstCoefArrays(image.Components.size());
+  for (auto ci = 0u; ci < image.Components.size(); ci++) {
+    auto const &comp = image.Components[ci];
+    auto const h = static_cast<size_t>(comp.H);
+    auto const v = static_cast<size_t>(comp.V);
+    dstCoefArrays[ci] = (*cinfo.mem->request_virt_barray)(
+        pCommon, JPOOL_IMAGE, TRUE,
+        static_cast<JDIMENSION>((comp.WidthInBlocks + h - 1) / h * h),
+        static_cast<JDIMENSION>((comp.HeightInBlocks + v - 1) / v * v),
+        static_cast<JDIMENSION>(v));
+  }
+  (*cinfo.mem->realize_virt_arrays)(pCommon);
+  for (auto ci = 0u; ci < image.Components.size(); ci++) {
+    auto &comp = image.Components[ci];
+    for (auto by = 0u; by < comp.HeightInBlocks; by++) {
+      auto const row = (*cinfo.mem->access_virt_barray)(
+          pCommon, dstCoefArrays[ci], static_cast<JDIMENSION>(by), 1, TRUE);
+      memcpy(row[0], comp.Block(0, by), comp.WidthInBlocks * sizeof(JBLOCK));
+    }
+  }
+
+  jpeg_write_coefficients(&cinfo, dstCoefArrays.data());
+  jpeg_finish_compress(&cinfo);
+
+  SetEncodedBuffer(ctx, session->dest.data.data(), session->dest.data.size());
+  SetColumns(ctx, image.Width);
+  SetRows(ctx, image.Height);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "CodecsContext.h"
+#include "TransformParameters.h"
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+void TransformJpeg8(CodecsContext *ctx, TransformParameters *params);